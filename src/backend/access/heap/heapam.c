@@ -3189,6 +3189,24 @@ TM_Result
 heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 			CommandId cid, Snapshot crosscheck, bool wait,
 			TM_FailureData *tmfd, LockTupleMode *lockmode)
+{
+	return heap_update_hot_safe(relation, otid, newtup, cid, crosscheck, wait,
+								NULL, tmfd, lockmode);
+}
+
+/*
+ *	heap_update_hot_safe - replace a tuple, ignoring some indexed columns
+ *
+ * Same as heap_update(), except that the columns in hot_safe_attrs (offset by
+ * FirstLowInvalidHeapAttributeNumber) do not prevent a HOT update.  The
+ * caller must have verified that their new values leave every index entry of
+ * the relation unchanged.  See table_tuple_update_hot_safe().
+ */
+TM_Result
+heap_update_hot_safe(Relation relation, ItemPointer otid, HeapTuple newtup,
+					 CommandId cid, Snapshot crosscheck, bool wait,
+					 Bitmapset *hot_safe_attrs,
+					 TM_FailureData *tmfd, LockTupleMode *lockmode)
 {
 	TM_Result	result;
 	TransactionId xid = GetCurrentTransactionId();
@@ -3262,6 +3280,7 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	 * relcache flush happening midway through.
 	 */
 	hot_attrs = RelationGetIndexAttrBitmap(relation, INDEX_ATTR_BITMAP_ALL);
+	hot_attrs = bms_del_members(hot_attrs, hot_safe_attrs);
 	key_attrs = RelationGetIndexAttrBitmap(relation, INDEX_ATTR_BITMAP_KEY);
 	id_attrs = RelationGetIndexAttrBitmap(relation,
 										  INDEX_ATTR_BITMAP_IDENTITY_KEY);
@@ -2148,12 +2148,12 @@ CommitTransaction(void)
 	smgrDoPendingSyncs(true, is_parallel_worker);
 
 	/*
-	 * The catalog ag_graphmeta is opened and modified during commit AgStat.
-	 * In the commit phase, any relation must not be opened. So AgStat must be
-	 * processed during the PreCommit phase
+	 * The catalog ag_graphmeta is opened and modified if the edge counts do
+	 * not fit in shared memory. In the commit phase, any relation must not be
+	 * opened. So that must be done during the PreCommit phase.
 	 */
 	if (auto_gather_graphmeta)
-		AtEOXact_AgStat(true);
+		PreCommit_AgStat();
 
 	/* close large objects before lower-level cleanup */
 	AtEOXact_LargeObject(true);
@@ -2240,6 +2240,13 @@ CommitTransaction(void)
 	CallXactCallbacks(is_parallel_worker ? XACT_EVENT_PARALLEL_COMMIT
 					  : XACT_EVENT_COMMIT);
 
+	/*
+	 * Publish the edge counts only now that our edges are visible, but before
+	 * the lock on ag_graphmeta that holds off flushes of the counts of
+	 * dropped labels is released.
+	 */
+	AtEOXact_AgStat(true);
+
 	ResourceOwnerRelease(TopTransactionResourceOwner,
 						 RESOURCE_RELEASE_BEFORE_LOCKS,
 						 true, true);
@@ -2587,6 +2594,8 @@ PrepareTransaction(void)
 	AtEOXact_Files(true);
 	AtEOXact_ComboCid();
 	AtEOXact_HashTables(true);
+	/* the edge counts of prepared transactions are not gathered */
+	AtEOXact_AgStat(false);
 	/* don't call AtEOXact_PgStat here; we fixed pgstat state above */
 	AtEOXact_Snapshot(true, true);
 	pgstat_report_xact_timestamp(0);
@@ -2800,8 +2809,7 @@ AbortTransaction(void)
 		AtEOXact_Files(false);
 		AtEOXact_ComboCid();
 		AtEOXact_HashTables(false);
-		if (auto_gather_graphmeta)
-			AtEOXact_AgStat(false);
+		AtEOXact_AgStat(false);
 		AtEOXact_PgStat(false, is_parallel_worker);
 		AtEOXact_ApplyLauncher(false);
 		pgstat_report_xact_timestamp(0);
@@ -7681,6 +7681,12 @@ StartupXLOG(void)
 	 */
 	ShutdownWalRcv();
 
+	/*
+	 * Restore the edge counts saved at the last clean shutdown, unless
+	 * recovery has removed them above.
+	 */
+	agstat_restore_pending_graphmeta();
+
 	/*
 	 * Reset unlogged relations to the contents of their INIT fork. This is
 	 * done AFTER recovery is complete so as to include any unlogged relations
@@ -8814,6 +8820,9 @@ ShutdownXLOG(int code, Datum arg)
 			RequestXLogSwitch(false);
 
 		CreateCheckPoint(CHECKPOINT_IS_SHUTDOWN | CHECKPOINT_IMMEDIATE);
+
+		/* keep the edge counts that are not folded into ag_graphmeta yet */
+		agstat_save_pending_graphmeta();
 	}
 }
 
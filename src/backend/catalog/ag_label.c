@@ -11,6 +11,7 @@
 #include "postgres.h"
 
 #include "ag_const.h"
+#include "access/genam.h"
 #include "access/heapam.h"
 #include "access/htup_details.h"
 #include "catalog/ag_graph_fn.h"
@@ -18,9 +19,12 @@
 #include "catalog/ag_label_fn.h"
 #include "catalog/catalog.h"
 #include "catalog/indexing.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_index.h"
 #include "commands/sequence.h"
 #include "utils/builtins.h"
 #include "utils/graph.h"
+#include "utils/jsonb.h"
 #include "utils/rel.h"
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
@@ -209,3 +213,92 @@ get_all_edge_labels_per_graph(Snapshot snapshot, Oid graph_oid)
 
 	return labels;
 }
+
+/*
+ * Returns the OID of a valid, non-partial btree index on the given label whose
+ * leading key column is `attnum`, or InvalidOid if there is none.
+ *
+ * Edge labels always have such indexes on `start` and `end` (see
+ * makeEdgeIndex()), and vertex labels on `id`, unless the user dropped them.
+ */
+Oid
+get_label_btree_index(Relation rel, AttrNumber attnum)
+{
+	List	   *index_oids;
+	ListCell   *lc;
+	Oid			result = InvalidOid;
+
+	index_oids = RelationGetIndexList(rel);
+
+	foreach(lc, index_oids)
+	{
+		Oid			index_oid = lfirst_oid(lc);
+		Relation	index_rel;
+		Form_pg_index index_form;
+
+		index_rel = index_open(index_oid, AccessShareLock);
+		index_form = index_rel->rd_index;
+
+		if (index_rel->rd_rel->relam == BTREE_AM_OID &&
+			index_form->indisvalid &&
+			index_form->indnkeyatts > 0 &&
+			index_form->indkey.values[0] == attnum &&
+			heap_attisnull(index_rel->rd_indextuple, Anum_pg_index_indpred,
+						   NULL))
+			result = index_oid;
+
+		index_close(index_rel, NoLock);
+
+		if (OidIsValid(result))
+			break;
+	}
+
+	list_free(index_oids);
+
+	return result;
+}
+
+/*
+ * Returns the OID of a valid, non-partial GIN index on the given label whose
+ * only key column is the jsonb column `attnum` and that supports `@>`, or
+ * InvalidOid if there is none.
+ */
+Oid
+get_label_gin_index(Relation rel, AttrNumber attnum)
+{
+	List	   *index_oids;
+	ListCell   *lc;
+	Oid			result = InvalidOid;
+
+	index_oids = RelationGetIndexList(rel);
+
+	foreach(lc, index_oids)
+	{
+		Oid			index_oid = lfirst_oid(lc);
+		Relation	index_rel;
+		Form_pg_index index_form;
+
+		index_rel = index_open(index_oid, AccessShareLock);
+		index_form = index_rel->rd_index;
+
+		if (index_rel->rd_rel->relam == GIN_AM_OID &&
+			index_form->indisvalid &&
+			index_form->indnkeyatts == 1 &&
+			index_form->indkey.values[0] == attnum &&
+			heap_attisnull(index_rel->rd_indextuple, Anum_pg_index_indpred,
+						   NULL) &&
+			OidIsValid(get_opfamily_member(index_rel->rd_opfamily[0],
+										   JSONBOID, JSONBOID,
+										   JsonbContainsStrategyNumber)))
+			result = index_oid;
+
+		index_close(index_rel, NoLock);
+
+		if (OidIsValid(result))
+			break;
+	}
+
+	list_free(index_oids);
+
+	return result;
+}
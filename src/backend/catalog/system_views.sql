@@ -1268,7 +1268,7 @@ CREATE VIEW ag_graphmeta_view AS
        (SELECT labname FROM ag_label WHERE start = labid AND graph = graphid) AS start,
        (SELECT labname FROM ag_label WHERE edge = labid AND graph = graphid) AS edge,
        (SELECT labname FROM ag_label WHERE "end" = labid AND graph = graphid) AS end,
-       edgecount FROM ag_graphmeta;
+       edgecount FROM ag_graphmeta_current() AS ag_graphmeta;
 
 REVOKE ALL ON pg_user_mapping FROM public;
 
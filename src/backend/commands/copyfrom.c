@@ -47,6 +47,7 @@
 #include "rewrite/rewriteHandler.h"
 #include "storage/fd.h"
 #include "tcop/tcopprot.h"
+#include "utils/adjcache.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/portal.h"
@@ -657,6 +658,8 @@ CopyFrom(CopyFromState cstate)
 	/* Verify the named relation is a valid target for INSERT */
 	CheckValidResultRel(resultRelInfo, CMD_INSERT);
 
+	AdjCacheRelationModified(resultRelInfo->ri_RelationDesc);
+
 	ExecOpenIndices(resultRelInfo, false);
 
 	/*
@@ -1662,6 +1662,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 									 ((A_Const *) rel_indices->uidx)->val.val.ival);
 				else
 					appendStringInfo(es->str, "]");
+				if (graph_vle->bfs)
+					appendStringInfoString(es->str, " bfs");
 			}
 			break;
 		default:
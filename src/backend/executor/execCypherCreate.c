@@ -15,16 +15,40 @@
 #include "executor/nodeModifyGraph.h"
 #include "utils/jsonb.h"
 #include "utils/rel.h"
+#include "access/heapam.h"
 #include "access/tableam.h"
 #include "pgstat.h"
 #include "commands/trigger.h"
 
+/*
+ * Limits of the tuples buffered for table_multi_insert(), same as COPY FROM.
+ * The buffers are flushed if any of them is reached.
+ */
+#define MAX_BUFFERED_GRAPH_TUPLES		1000
+#define MAX_BUFFERED_GRAPH_BYTES		65535
+
+/* tuples to be inserted into a target label */
+typedef struct CreateGraphBuffer
+{
+	ResultRelInfo *resultRelInfo;
+	TupleTableSlot *slots[MAX_BUFFERED_GRAPH_TUPLES];
+	int			nslots;			/* # of slots created so far */
+	int			nused;			/* # of slots holding tuples to be inserted */
+	BulkInsertState bistate;	/* of this label only, see CopyMultiInsertBuffer */
+} CreateGraphBuffer;
+
 static TupleTableSlot *createPath(ModifyGraphState *mgstate, GraphPath *path,
 								  TupleTableSlot *slot);
 static Datum createVertex(ModifyGraphState *mgstate, GraphVertex *gvertex, Graphid *vid,
 						  TupleTableSlot *slot);
 static Datum createEdge(ModifyGraphState *mgstate, GraphEdge *gedge, Graphid start,
 						Graphid end, TupleTableSlot *slot);
+static CreateGraphBuffer *getCreateGraphBuffer(ModifyGraphState *mgstate,
+											   ResultRelInfo *resultRelInfo);
+static TupleTableSlot *nextBufferedSlot(ModifyGraphState *mgstate,
+										CreateGraphBuffer *buffer);
+static void flushCreateGraphBuffer(ModifyGraphState *mgstate,
+								   CreateGraphBuffer *buffer);
 
 TupleTableSlot *
 ExecCreateGraph(ModifyGraphState *mgstate, TupleTableSlot *slot)
@@ -51,6 +75,185 @@ ExecCreateGraph(ModifyGraphState *mgstate, TupleTableSlot *slot)
 	return (plan->last ? NULL : slot);
 }
 
+/*
+ * ExecInitCreateGraph
+ * Set up the buffers for multi-insert if the created elements are not
+ * returned to the parent plan.
+ */
+void
+ExecInitCreateGraph(ModifyGraphState *mgstate)
+{
+	ModifyGraph *plan = (ModifyGraph *) mgstate->ps.plan;
+	CreateGraphState *create_graph_state = palloc(sizeof(CreateGraphState));
+
+	/*
+	 * The TID's of the created elements are not known until the buffers are
+	 * flushed, so this is possible only if the elements are not output.
+	 */
+	create_graph_state->multi_insert = (plan->last && !mgstate->eagerness);
+	create_graph_state->buffers =
+		palloc0(mgstate->numResultRelInfo * sizeof(CreateGraphBuffer *));
+	create_graph_state->nbuffered = 0;
+	create_graph_state->nbuffered_bytes = 0;
+
+	mgstate->create_graph_state = create_graph_state;
+}
+
+/*
+ * ExecFlushCreateGraph
+ * Insert all the buffered tuples.
+ */
+void
+ExecFlushCreateGraph(ModifyGraphState *mgstate)
+{
+	CreateGraphState *create_graph_state = mgstate->create_graph_state;
+	int			i;
+
+	if (create_graph_state->nbuffered == 0)
+		return;
+
+	for (i = 0; i < mgstate->numResultRelInfo; i++)
+	{
+		CreateGraphBuffer *buffer = create_graph_state->buffers[i];
+
+		if (buffer != NULL && buffer->nused > 0)
+			flushCreateGraphBuffer(mgstate, buffer);
+	}
+
+	create_graph_state->nbuffered = 0;
+	create_graph_state->nbuffered_bytes = 0;
+}
+
+void
+ExecEndCreateGraph(ModifyGraphState *mgstate)
+{
+	CreateGraphState *create_graph_state = mgstate->create_graph_state;
+	int			i;
+
+	for (i = 0; i < mgstate->numResultRelInfo; i++)
+	{
+		CreateGraphBuffer *buffer = create_graph_state->buffers[i];
+		int			j;
+
+		if (buffer == NULL)
+			continue;
+
+		Assert(buffer->nused == 0);
+
+		for (j = 0; j < buffer->nslots; j++)
+			ExecDropSingleTupleTableSlot(buffer->slots[j]);
+
+		FreeBulkInsertState(buffer->bistate);
+		table_finish_bulk_insert(buffer->resultRelInfo->ri_RelationDesc, 0);
+		pfree(buffer);
+	}
+
+	pfree(create_graph_state->buffers);
+	pfree(create_graph_state);
+}
+
+/*
+ * getCreateGraphBuffer
+ * Return the buffer for the given label, or NULL if the tuple must be
+ * inserted immediately.
+ */
+static CreateGraphBuffer *
+getCreateGraphBuffer(ModifyGraphState *mgstate, ResultRelInfo *resultRelInfo)
+{
+	CreateGraphState *create_graph_state = mgstate->create_graph_state;
+	int			index = resultRelInfo - mgstate->resultRelInfo;
+	CreateGraphBuffer *buffer;
+
+	if (!create_graph_state->multi_insert)
+		return NULL;
+
+	/* BEFORE ROW triggers may see the tuples inserted before, see COPY FROM */
+	if (resultRelInfo->ri_TrigDesc != NULL &&
+		(resultRelInfo->ri_TrigDesc->trig_insert_before_row ||
+		 resultRelInfo->ri_TrigDesc->trig_insert_instead_row))
+		return NULL;
+
+	Assert(index >= 0 && index < mgstate->numResultRelInfo);
+
+	buffer = create_graph_state->buffers[index];
+	if (buffer == NULL)
+	{
+		MemoryContext oldmctx;
+
+		oldmctx = MemoryContextSwitchTo(mgstate->ps.state->es_query_cxt);
+		buffer = palloc(sizeof(CreateGraphBuffer));
+		buffer->resultRelInfo = resultRelInfo;
+		buffer->nslots = 0;
+		buffer->nused = 0;
+		buffer->bistate = GetBulkInsertState();
+		MemoryContextSwitchTo(oldmctx);
+
+		create_graph_state->buffers[index] = buffer;
+	}
+
+	return buffer;
+}
+
+/* return an empty slot of the buffer, flushing the buffers if they are full */
+static TupleTableSlot *
+nextBufferedSlot(ModifyGraphState *mgstate, CreateGraphBuffer *buffer)
+{
+	CreateGraphState *create_graph_state = mgstate->create_graph_state;
+	TupleTableSlot *slot;
+
+	if (buffer->nused == MAX_BUFFERED_GRAPH_TUPLES ||
+		create_graph_state->nbuffered >= MAX_BUFFERED_GRAPH_TUPLES ||
+		create_graph_state->nbuffered_bytes >= MAX_BUFFERED_GRAPH_BYTES)
+		ExecFlushCreateGraph(mgstate);
+
+	if (buffer->nused == buffer->nslots)
+	{
+		MemoryContext oldmctx;
+
+		oldmctx = MemoryContextSwitchTo(mgstate->ps.state->es_query_cxt);
+		buffer->slots[buffer->nslots++] =
+			table_slot_create(buffer->resultRelInfo->ri_RelationDesc, NULL);
+		MemoryContextSwitchTo(oldmctx);
+	}
+
+	slot = buffer->slots[buffer->nused];
+	ExecClearTuple(slot);
+
+	return slot;
+}
+
+static void
+flushCreateGraphBuffer(ModifyGraphState *mgstate, CreateGraphBuffer *buffer)
+{
+	EState	   *estate = mgstate->ps.state;
+	ResultRelInfo *resultRelInfo = buffer->resultRelInfo;
+	int			i;
+
+	table_multi_insert(resultRelInfo->ri_RelationDesc, buffer->slots,
+					   buffer->nused, mgstate->modify_cid + MODIFY_CID_OUTPUT,
+					   0, buffer->bistate);
+
+	for (i = 0; i < buffer->nused; i++)
+	{
+		TupleTableSlot *slot = buffer->slots[i];
+		List	   *recheckIndexes = NIL;
+
+		if (resultRelInfo->ri_NumIndices > 0)
+			recheckIndexes = ExecInsertIndexTuples(resultRelInfo, slot,
+												   estate, false, false,
+												   NULL, NIL);
+
+		/* AFTER ROW INSERT Triggers */
+		ExecARInsertTriggers(estate, resultRelInfo, slot, recheckIndexes,
+							 NULL);
+		list_free(recheckIndexes);
+
+		ExecClearTuple(slot);
+	}
+
+	buffer->nused = 0;
+}
+
 
 /* create a path and accumulate it to the given slot */
 static TupleTableSlot *
@@ -159,6 +362,7 @@ createVertex(ModifyGraphState *mgstate, GraphVertex *gvertex, Graphid *vid,
 	Datum		vertex;
 	Datum		vertexProp;
 	List	   *recheckIndexes = NIL;
+	CreateGraphBuffer *buffer;
 
 	resultRelInfo = getResultRelInfo(mgstate, gvertex->relid);
 
@@ -170,10 +374,17 @@ createVertex(ModifyGraphState *mgstate, GraphVertex *gvertex, Graphid *vid,
 				(errcode(ERRCODE_DATATYPE_MISMATCH),
 				 errmsg("jsonb object is expected for property map")));
 
-	ExecClearTuple(elemTupleSlot);
-
-	ExecSetSlotDescriptor(elemTupleSlot,
-						  RelationGetDescr(resultRelInfo->ri_RelationDesc));
+	buffer = getCreateGraphBuffer(mgstate, resultRelInfo);
+	if (buffer != NULL)
+	{
+		elemTupleSlot = nextBufferedSlot(mgstate, buffer);
+	}
+	else
+	{
+		ExecClearTuple(elemTupleSlot);
+		ExecSetSlotDescriptor(elemTupleSlot,
+							  RelationGetDescr(resultRelInfo->ri_RelationDesc));
+	}
 	elemTupleSlot->tts_values[0] = GraphidGetDatum(*vid);
 	elemTupleSlot->tts_values[1] = vertexProp;
 	MemSet(elemTupleSlot->tts_isnull, false,
@@ -206,23 +417,33 @@ createVertex(ModifyGraphState *mgstate, GraphVertex *gvertex, Graphid *vid,
 	if (resultRelInfo->ri_RelationDesc->rd_att->constr != NULL)
 		ExecConstraints(resultRelInfo, elemTupleSlot, estate);
 
-	/*
-	 * insert the tuple normally
-	 */
-	table_tuple_insert(resultRelInfo->ri_RelationDesc, elemTupleSlot,
-					   mgstate->modify_cid + MODIFY_CID_OUTPUT,
-					   0, NULL);
-
-	/* insert index entries for the tuple */
-	if (resultRelInfo->ri_NumIndices > 0)
-		recheckIndexes = ExecInsertIndexTuples(resultRelInfo, elemTupleSlot,
-											   estate, false, false,
-											   NULL, NIL);
-
-	/* AFTER ROW INSERT Triggers */
-	ExecARInsertTriggers(estate, resultRelInfo, elemTupleSlot, recheckIndexes,
-						 NULL);
-	list_free(recheckIndexes);
+	if (buffer != NULL)
+	{
+		/* the tuple will be inserted when the buffers are flushed */
+		buffer->nused++;
+		mgstate->create_graph_state->nbuffered++;
+		mgstate->create_graph_state->nbuffered_bytes += VARSIZE_ANY(DatumGetPointer(vertexProp));
+	}
+	else
+	{
+		/*
+		 * insert the tuple normally
+		 */
+		table_tuple_insert(resultRelInfo->ri_RelationDesc, elemTupleSlot,
+						   mgstate->modify_cid + MODIFY_CID_OUTPUT,
+						   0, NULL);
+
+		/* insert index entries for the tuple */
+		if (resultRelInfo->ri_NumIndices > 0)
+			recheckIndexes = ExecInsertIndexTuples(resultRelInfo, elemTupleSlot,
+												   estate, false, false,
+												   NULL, NIL);
+
+		/* AFTER ROW INSERT Triggers */
+		ExecARInsertTriggers(estate, resultRelInfo, elemTupleSlot,
+							 recheckIndexes, NULL);
+		list_free(recheckIndexes);
+	}
 
 	vertex = makeGraphVertexDatum(elemTupleSlot->tts_values[0],
 								  elemTupleSlot->tts_values[1],
@@ -247,6 +468,7 @@ createEdge(ModifyGraphState *mgstate, GraphEdge *gedge, Graphid start,
 	Datum		edge;
 	Datum		edgeProp;
 	List	   *recheckIndexes = NIL;
+	CreateGraphBuffer *buffer;
 
 	resultRelInfo = getResultRelInfo(mgstate, gedge->relid);
 
@@ -259,10 +481,17 @@ createEdge(ModifyGraphState *mgstate, GraphEdge *gedge, Graphid start,
 				(errcode(ERRCODE_DATATYPE_MISMATCH),
 				 errmsg("jsonb object is expected for property map")));
 
-	ExecClearTuple(elemTupleSlot);
-
-	ExecSetSlotDescriptor(elemTupleSlot,
-						  RelationGetDescr(resultRelInfo->ri_RelationDesc));
+	buffer = getCreateGraphBuffer(mgstate, resultRelInfo);
+	if (buffer != NULL)
+	{
+		elemTupleSlot = nextBufferedSlot(mgstate, buffer);
+	}
+	else
+	{
+		ExecClearTuple(elemTupleSlot);
+		ExecSetSlotDescriptor(elemTupleSlot,
+							  RelationGetDescr(resultRelInfo->ri_RelationDesc));
+	}
 	elemTupleSlot->tts_values[0] = GraphidGetDatum(id);
 	elemTupleSlot->tts_values[1] = GraphidGetDatum(start);
 	elemTupleSlot->tts_values[2] = GraphidGetDatum(end);
@@ -289,19 +518,28 @@ createEdge(ModifyGraphState *mgstate, GraphEdge *gedge, Graphid start,
 	if (resultRelInfo->ri_RelationDesc->rd_att->constr != NULL)
 		ExecConstraints(resultRelInfo, elemTupleSlot, estate);
 
-	table_tuple_insert(resultRelInfo->ri_RelationDesc, elemTupleSlot,
-					   mgstate->modify_cid + MODIFY_CID_OUTPUT,
-					   0, NULL);
-
-	if (resultRelInfo->ri_NumIndices > 0)
-		recheckIndexes = ExecInsertIndexTuples(resultRelInfo, elemTupleSlot,
-											   estate, false, false,
-											   NULL, NIL);
-
-	/* AFTER ROW INSERT Triggers */
-	ExecARInsertTriggers(estate, resultRelInfo, elemTupleSlot, recheckIndexes,
-						 NULL);
-	list_free(recheckIndexes);
+	if (buffer != NULL)
+	{
+		buffer->nused++;
+		mgstate->create_graph_state->nbuffered++;
+		mgstate->create_graph_state->nbuffered_bytes += VARSIZE_ANY(DatumGetPointer(edgeProp));
+	}
+	else
+	{
+		table_tuple_insert(resultRelInfo->ri_RelationDesc, elemTupleSlot,
+						   mgstate->modify_cid + MODIFY_CID_OUTPUT,
+						   0, NULL);
+
+		if (resultRelInfo->ri_NumIndices > 0)
+			recheckIndexes = ExecInsertIndexTuples(resultRelInfo, elemTupleSlot,
+												   estate, false, false,
+												   NULL, NIL);
+
+		/* AFTER ROW INSERT Triggers */
+		ExecARInsertTriggers(estate, resultRelInfo, elemTupleSlot,
+							 recheckIndexes, NULL);
+		list_free(recheckIndexes);
+	}
 
 	edge = makeGraphEdgeDatum(elemTupleSlot->tts_values[0],
 							  elemTupleSlot->tts_values[1],
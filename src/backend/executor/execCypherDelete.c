@@ -22,6 +22,8 @@
 #include "access/xact.h"
 #include "commands/trigger.h"
 #include "utils/fmgroids.h"
+#include "access/genam.h"
+#include "utils/array.h"
 
 #define DatumGetItemPointer(X)		((ItemPointer) DatumGetPointer(X))
 #define ItemPointerGetDatum(X)		PointerGetDatum(X)
@@ -33,13 +35,22 @@ static bool ExecDeleteEdgeOrVertex(ModifyGraphState *mgstate,
 static void ExecDeleteGraphElement(ModifyGraphState *mgstate, Datum elem,
 								   Oid type);
 
-static void find_connected_edges(ModifyGraphState *mgstate, Graphid vertex_id);
+static void find_connected_edges(ModifyGraphState *mgstate,
+								 Graphid *vertex_ids, int nvertices);
 static void find_connected_edges_internal(ModifyGraphState *mgstate,
 										  ModifyGraph *plan,
 										  EState *estate,
-										  ResultRelInfo *resultRelInfo,
+										  int label_index,
 										  AttrNumber attr,
-										  Datum vertex_id);
+										  Graphid *vertex_ids,
+										  int nvertices);
+static void delete_connected_edge(ModifyGraphState *mgstate,
+								  ModifyGraph *plan,
+								  ResultRelInfo *resultRelInfo,
+								  HeapTuple tup);
+static void add_pending_vertex_id(ModifyGraphState *mgstate,
+								  Graphid vertex_id);
+static int	graphid_qsort_cmp(const void *a, const void *b);
 
 TupleTableSlot *
 ExecDeleteGraph(ModifyGraphState *mgstate, TupleTableSlot *slot)
@@ -107,13 +118,11 @@ ExecDeleteEdgeOrVertex(ModifyGraphState *mgstate, ResultRelInfo *resultRelInfo,
 	Relation	resultRelationDesc;
 	TM_Result	result;
 	TM_FailureData tmfd;
-	bool		hash_found;
 	ItemPointer tupleid;
 
 	tupleid = &tuple->t_self;
 
-	hash_search(mgstate->elemTable, &graphid, HASH_FIND, &hash_found);
-	if (hash_found)
+	if (lookupModifiedElem(mgstate->elemTable, graphid, NULL))
 		return false;
 
 	resultRelationDesc = resultRelInfo->ri_RelationDesc;
@@ -206,7 +215,7 @@ ExecDeleteEdgeOrVertex(ModifyGraphState *mgstate, ResultRelInfo *resultRelInfo,
 		graphWriteStats.deleteVertex++;
 	}
 
-	hash_search(mgstate->elemTable, &graphid, HASH_ENTER, &hash_found);
+	storeModifiedElem(mgstate->elemTable, graphid, (Datum) 0);
 
 	return true;
 }
@@ -224,7 +233,10 @@ ExecDeleteGraphElement(ModifyGraphState *mgstate, Datum elem, Oid type)
 		Datum	   *values = mgstate->delete_graph_state->cached_values;
 		bool	   *isnull = mgstate->delete_graph_state->cached_isnull;
 
-		find_connected_edges(mgstate, vertex_id);
+		if (mgstate->delete_graph_state->bulk)
+			add_pending_vertex_id(mgstate, vertex_id);
+		else
+			find_connected_edges(mgstate, &vertex_id, 1);
 
 		values[Anum_table_vertex_id - 1] = GraphidGetDatum(vertex_id);
 		values[Anum_table_vertex_prop_map - 1] = getVertexPropDatum(elem);
@@ -322,14 +334,102 @@ ExecDeleteGraphElement(ModifyGraphState *mgstate, Datum elem, Oid type)
 	}
 }
 
+/*
+ * ExecFlushDeleteGraph
+ * Remove the edges connected to the vertices collected in bulk mode.
+ *
+ * The ids are sorted so that each edge label is visited once per direction,
+ * in index order.
+ */
+void
+ExecFlushDeleteGraph(ModifyGraphState *mgstate)
+{
+	DeleteGraphState *delete_graph_state = mgstate->delete_graph_state;
+	Graphid    *ids = delete_graph_state->pending_vertex_ids;
+	int			nids = delete_graph_state->num_pending_vertex_ids;
+	int			nunique;
+	int			i;
+
+	if (nids == 0)
+		return;
+
+	qsort(ids, nids, sizeof(Graphid), graphid_qsort_cmp);
+
+	nunique = 1;
+	for (i = 1; i < nids; i++)
+	{
+		if (ids[i] != ids[nunique - 1])
+			ids[nunique++] = ids[i];
+	}
+
+	find_connected_edges(mgstate, ids, nunique);
+
+	delete_graph_state->num_pending_vertex_ids = 0;
+}
+
+static void
+add_pending_vertex_id(ModifyGraphState *mgstate, Graphid vertex_id)
+{
+	DeleteGraphState *delete_graph_state = mgstate->delete_graph_state;
+
+	if (delete_graph_state->num_pending_vertex_ids ==
+		delete_graph_state->max_pending_vertex_ids)
+	{
+		int			max_ids = delete_graph_state->max_pending_vertex_ids;
+		int			limit_ids = (work_mem * 1024L) / sizeof(Graphid);
+
+		if (max_ids >= limit_ids)
+		{
+			/* do not grow beyond work_mem, remove the edges found so far */
+			ExecFlushDeleteGraph(mgstate);
+		}
+		else if (max_ids == 0)
+		{
+			max_ids = Min(1024, limit_ids);
+			delete_graph_state->pending_vertex_ids =
+				MemoryContextAlloc(mgstate->ps.state->es_query_cxt,
+								   max_ids * sizeof(Graphid));
+			delete_graph_state->max_pending_vertex_ids = max_ids;
+		}
+		else
+		{
+			max_ids = Min(max_ids * 2, limit_ids);
+			delete_graph_state->pending_vertex_ids =
+				repalloc(delete_graph_state->pending_vertex_ids,
+						 max_ids * sizeof(Graphid));
+			delete_graph_state->max_pending_vertex_ids = max_ids;
+		}
+	}
+
+	delete_graph_state->pending_vertex_ids[
+										   delete_graph_state->num_pending_vertex_ids++] = vertex_id;
+}
+
+static int
+graphid_qsort_cmp(const void *a, const void *b)
+{
+	Graphid		id1 = *(const Graphid *) a;
+	Graphid		id2 = *(const Graphid *) b;
+
+	if (id1 < id2)
+		return -1;
+	if (id1 > id2)
+		return 1;
+	return 0;
+}
+
+/*
+ * find_connected_edges
+ * Remove the edges connected to any of the given vertices. `vertex_ids` must
+ * be sorted and unique if there is more than one.
+ */
 static void
-find_connected_edges(ModifyGraphState *mgstate, Graphid vertex_id)
+find_connected_edges(ModifyGraphState *mgstate, Graphid *vertex_ids,
+					 int nvertices)
 {
 	ModifyGraph *plan = (ModifyGraph *) mgstate->ps.plan;
 	DeleteGraphState *delete_graph_state = mgstate->delete_graph_state;
 	EState	   *estate = mgstate->ps.state;
-	Datum		datum_vertex_id = GraphidGetDatum(vertex_id);
-	ResultRelInfo *resultRelInfo = delete_graph_state->edge_labels;
 	CommandId	saved_command_id;
 	int			i;
 
@@ -339,11 +439,12 @@ find_connected_edges(ModifyGraphState *mgstate, Graphid vertex_id)
 
 	for (i = 0; i < delete_graph_state->num_edge_labels; i++)
 	{
-		find_connected_edges_internal(mgstate, plan, estate, resultRelInfo,
-									  Anum_table_edge_start, datum_vertex_id);
-		find_connected_edges_internal(mgstate, plan, estate, resultRelInfo,
-									  Anum_table_edge_end, datum_vertex_id);
-		resultRelInfo++;
+		find_connected_edges_internal(mgstate, plan, estate, i,
+									  Anum_table_edge_start,
+									  vertex_ids, nvertices);
+		find_connected_edges_internal(mgstate, plan, estate, i,
+									  Anum_table_edge_end,
+									  vertex_ids, nvertices);
 	}
 
 	estate->es_snapshot->curcid = saved_command_id;
@@ -353,39 +454,137 @@ static void
 find_connected_edges_internal(ModifyGraphState *mgstate,
 							  ModifyGraph *plan,
 							  EState *estate,
-							  ResultRelInfo *resultRelInfo,
+							  int label_index,
 							  AttrNumber attr,
-							  Datum vertex_id)
+							  Graphid *vertex_ids,
+							  int nvertices)
 {
+	DeleteGraphState *delete_graph_state = mgstate->delete_graph_state;
+	ResultRelInfo *resultRelInfo = &delete_graph_state->edge_labels[label_index];
 	Relation	relation = resultRelInfo->ri_RelationDesc;
+	Relation	index_rel;
+	IndexScanDesc *index_scan;
 	HeapTuple	tup;
 	TableScanDesc scanDesc;
 	ScanKeyData skey;
 
-	ScanKeyInit(&skey, attr,
-				BTEqualStrategyNumber,
-				F_GRAPHID_EQ, vertex_id);
-	scanDesc = table_beginscan(relation, estate->es_snapshot, 1, &skey);
-	while ((tup = heap_getnext(scanDesc, ForwardScanDirection)) != NULL)
+	if (attr == Anum_table_edge_start)
 	{
-		bool		isnull;
-		Graphid		gid;
+		index_rel = delete_graph_state->start_index_rels[label_index];
+		index_scan = &delete_graph_state->start_index_scans[label_index];
+	}
+	else
+	{
+		index_rel = delete_graph_state->end_index_rels[label_index];
+		index_scan = &delete_graph_state->end_index_scans[label_index];
+	}
+
+	if (index_rel != NULL)
+	{
+		TupleTableSlot *slot = delete_graph_state->edge_slot;
 
-		if (!plan->detach)
+		if (nvertices == 1)
 		{
-			table_endscan(scanDesc);
-			elog(ERROR, "vertices with edges can not be removed");
+			ScanKeyInit(&skey, 1,
+						BTEqualStrategyNumber,
+						F_GRAPHID_EQ, GraphidGetDatum(vertex_ids[0]));
 		}
-		gid = DatumGetGraphid(heap_getattr(tup,
-										   Anum_table_edge_id,
-										   RelationGetDescr(relation),
-										   &isnull));
-		ExecDeleteEdgeOrVertex(mgstate,
-							   resultRelInfo,
-							   gid,
-							   tup,
-							   EDGEOID,
-							   true);
+		else
+		{
+			Datum	   *elems = palloc(nvertices * sizeof(Datum));
+			ArrayType  *arr;
+			int			i;
+
+			for (i = 0; i < nvertices; i++)
+				elems[i] = GraphidGetDatum(vertex_ids[i]);
+			arr = construct_array(elems, nvertices, GRAPHIDOID,
+								  sizeof(Graphid), FLOAT8PASSBYVAL,
+								  TYPALIGN_DOUBLE);
+			pfree(elems);
+
+			ScanKeyEntryInitialize(&skey,
+								   SK_SEARCHARRAY,
+								   1,
+								   BTEqualStrategyNumber,
+								   GRAPHIDOID,
+								   InvalidOid,
+								   F_GRAPHID_EQ,
+								   PointerGetDatum(arr));
+		}
+
+		/* the scan is kept open and reused for the following vertices */
+		if (*index_scan == NULL)
+			*index_scan = index_beginscan(relation, index_rel,
+										  estate->es_snapshot, 1, 0);
+		index_rescan(*index_scan, &skey, 1, NULL, 0);
+
+		while (index_getnext_slot(*index_scan, ForwardScanDirection, slot))
+		{
+			bool		should_free;
+
+			tup = ExecFetchSlotHeapTuple(slot, false, &should_free);
+			delete_connected_edge(mgstate, plan, resultRelInfo, tup);
+			if (should_free)
+				heap_freetuple(tup);
+		}
+		ExecClearTuple(slot);
+
+		if (nvertices > 1)
+			pfree(DatumGetPointer(skey.sk_argument));
+		return;
+	}
+
+	if (nvertices == 1)
+	{
+		ScanKeyInit(&skey, attr,
+					BTEqualStrategyNumber,
+					F_GRAPHID_EQ, GraphidGetDatum(vertex_ids[0]));
+		scanDesc = table_beginscan(relation, estate->es_snapshot, 1, &skey);
+	}
+	else
+	{
+		/* one pass over the edge label for all the vertices */
+		scanDesc = table_beginscan(relation, estate->es_snapshot, 0, NULL);
+	}
+
+	while ((tup = heap_getnext(scanDesc, ForwardScanDirection)) != NULL)
+	{
+		if (nvertices > 1)
+		{
+			bool		isnull;
+			Graphid		vertex_id;
+
+			vertex_id = DatumGetGraphid(heap_getattr(tup, attr,
+													 RelationGetDescr(relation),
+													 &isnull));
+			if (bsearch(&vertex_id, vertex_ids, nvertices, sizeof(Graphid),
+						graphid_qsort_cmp) == NULL)
+				continue;
+		}
+
+		delete_connected_edge(mgstate, plan, resultRelInfo, tup);
 	}
 	table_endscan(scanDesc);
 }
+
+static void
+delete_connected_edge(ModifyGraphState *mgstate, ModifyGraph *plan,
+					  ResultRelInfo *resultRelInfo, HeapTuple tup)
+{
+	bool		isnull;
+	Graphid		gid;
+
+	if (!plan->detach)
+		elog(ERROR, "vertices with edges can not be removed");
+
+	gid = DatumGetGraphid(heap_getattr(tup,
+									   Anum_table_edge_id,
+									   RelationGetDescr(resultRelInfo->ri_RelationDesc),
+									   &isnull));
+	ExecDeleteEdgeOrVertex(mgstate,
+						   resultRelInfo,
+						   gid,
+						   tup,
+						   EDGEOID,
+						   true);
+}
@@ -14,6 +14,7 @@
 #include "executor/execCypherSet.h"
 #include "executor/nodeModifyGraph.h"
 #include "executor/executor.h"
+#include "executor/nodeHashjoin.h"
 #include "utils/jsonb.h"
 #include "utils/rel.h"
 #include "access/tableam.h"
@@ -22,6 +23,7 @@
 #include "commands/trigger.h"
 
 static bool isMatchedMergePattern(PlanState *planstate);
+static void invalidateMergePattern(PlanState *planstate);
 static TupleTableSlot *createMergePath(ModifyGraphState *mgstate,
 									   GraphPath *path, TupleTableSlot *slot);
 static Datum createMergeVertex(ModifyGraphState *mgstate,
@@ -46,6 +48,7 @@ ExecMergeGraph(ModifyGraphState *mgstate, TupleTableSlot *slot)
 		if (mgstate->sets != NIL)
 		{
 			slot = LegacyExecSetGraph(mgstate, slot, GSP_ON_MATCH);
+			invalidateMergePattern(mgstate->subplan);
 		}
 	}
 	else
@@ -58,6 +61,8 @@ ExecMergeGraph(ModifyGraphState *mgstate, TupleTableSlot *slot)
 
 		MemoryContextSwitchTo(oldmctx);
 
+		invalidateMergePattern(mgstate->subplan);
+
 		if (mgstate->sets != NIL)
 		{
 			slot = LegacyExecSetGraph(mgstate, slot, GSP_ON_CREATE);
@@ -71,11 +76,26 @@ ExecMergeGraph(ModifyGraphState *mgstate, TupleTableSlot *slot)
 static bool
 isMatchedMergePattern(PlanState *planstate)
 {
+	if (IsA(planstate, HashJoinState))
+		return ((HashJoinState *) planstate)->hj_MatchedOuter;
+
 	Assert(IsA(planstate, NestLoopState));
 
 	return ((NestLoopState *) planstate)->nl_MatchedOuter;
 }
 
+/*
+ * The pattern has been created or modified. A nested loop sees the changes
+ * when it rescans the pattern for the next row, but a hash join has to build
+ * its hash table again.
+ */
+static void
+invalidateMergePattern(PlanState *planstate)
+{
+	if (IsA(planstate, HashJoinState))
+		ExecHashJoinInvalidateInner((HashJoinState *) planstate);
+}
+
 static TupleTableSlot *
 createMergePath(ModifyGraphState *mgstate, GraphPath *path,
 				TupleTableSlot *slot)
@@ -15,15 +15,49 @@
 #include "executor/executor.h"
 #include "executor/nodeModifyGraph.h"
 #include "utils/datum.h"
+#include "access/sysattr.h"
 #include "access/tableam.h"
 #include "utils/lsyscache.h"
 #include "access/xact.h"
 #include "catalog/ag_vertex_d.h"
 #include "catalog/ag_edge_d.h"
+#include "catalog/index.h"
 #include "commands/trigger.h"
+#include "optimizer/optimizer.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
 
 #define DatumGetItemPointer(X)	 ((ItemPointer) DatumGetPointer(X))
 
+/* an index whose entries depend on the property map of the elements */
+typedef struct SetPropIndex
+{
+	int			indexno;		/* in ri_IndexRelationDescs */
+	int16		typlen[INDEX_MAX_KEYS]; /* of the values of FormIndexDatum() */
+	bool		typbyval[INDEX_MAX_KEYS];
+} SetPropIndex;
+
+/*
+ * State of a label whose elements are SET.  Elements usually arrive grouped
+ * by label, so the label of the last element is looked up first.
+ *
+ * Updating the property map of an element never allows a HOT update by
+ * itself if the label has a property index, because the properties column
+ * is referenced by the index expressions.  If the values of all those
+ * expressions stay the same, the update can be done without new index
+ * entries, so they are compared before each update.
+ */
+typedef struct SetLabelState
+{
+	Labid		labid;
+	ResultRelInfo *resultRelInfo;
+	int			numPropIndexes;
+	SetPropIndex *propIndexes;
+	Bitmapset  *propAttrs;		/* the properties column, or NULL if no
+								 * property index has to be compared */
+	TupleTableSlot *oldSlot;	/* for the elements before the update */
+} SetLabelState;
+
 static TupleTableSlot *copyVirtualTupleTableSlot(TupleTableSlot *dstslot,
 												 TupleTableSlot *srcslot);
 static void findAndReflectNewestValue(ModifyGraphState *mgstate,
@@ -33,6 +67,14 @@ static void updateElementTable(ModifyGraphState *mgstate, Datum gid,
 static Datum GraphTableTupleUpdate(ModifyGraphState *mgstate,
 								   Oid tts_value_type, Datum tts_value,
 								   int attidx);
+static SetLabelState *getSetLabelState(ModifyGraphState *mgstate,
+									   Oid elemtype, Graphid gid);
+static void initSetLabelState(ModifyGraphState *mgstate, SetLabelState *sls,
+							  Oid elemtype, Labid labid,
+							  ResultRelInfo *resultRelInfo);
+static Bitmapset *getHotSafeAttrs(ModifyGraphState *mgstate,
+								  SetLabelState *sls, ItemPointer otid,
+								  TupleTableSlot *newslot);
 
 /*
  * LegacyExecSetGraph
@@ -46,6 +88,7 @@ LegacyExecSetGraph(ModifyGraphState *mgstate, TupleTableSlot *slot, GSPKind kind
 	ExprContext *econtext = mgstate->ps.ps_ExprContext;
 	ListCell   *ls;
 	TupleTableSlot *result = mgstate->ps.ps_ResultTupleSlot;
+	MemoryContext oldmctx;
 
 	/*
 	 * The results of previous clauses should be preserved. So, shallow
@@ -57,9 +100,11 @@ LegacyExecSetGraph(ModifyGraphState *mgstate, TupleTableSlot *slot, GSPKind kind
 	 * Reflect the newest value all types of scantuple before evaluating
 	 * expression.
 	 */
+	oldmctx = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
 	findAndReflectNewestValue(mgstate, econtext->ecxt_scantuple);
 	findAndReflectNewestValue(mgstate, econtext->ecxt_innertuple);
 	findAndReflectNewestValue(mgstate, econtext->ecxt_outertuple);
+	MemoryContextSwitchTo(oldmctx);
 
 	foreach(ls, mgstate->sets)
 	{
@@ -71,7 +116,6 @@ LegacyExecSetGraph(ModifyGraphState *mgstate, TupleTableSlot *slot, GSPKind kind
 		Datum		gid;
 		Datum		tid;
 		Datum		newelem;
-		MemoryContext oldmctx;
 		AttrNumber	attnum;
 
 		if (gsp->kind != kind)
@@ -291,10 +335,8 @@ GraphTableTupleUpdate(ModifyGraphState *mgstate, Oid tts_value_type,
 	TM_FailureData tmfd;
 	bool		update_indexes;
 	Datum		gid;
-	Oid			relid;
+	SetLabelState *sls;
 	ItemPointer ctid;
-	bool		hash_found;
-	ModifiedElemEntry *entry;
 	Datum		inserted_datum;
 	List	   *recheckIndexes = NIL;
 
@@ -309,9 +351,7 @@ GraphTableTupleUpdate(ModifyGraphState *mgstate, Oid tts_value_type,
 		gid = getEdgeIdDatum(tts_value);
 	}
 
-	hash_search(mgstate->elemTable, &gid, HASH_FIND,
-				&hash_found);
-	if (hash_found)
+	if (lookupModifiedElem(mgstate->elemTable, DatumGetGraphid(gid), NULL))
 	{
 		if (!enable_multiple_update)
 		{
@@ -324,9 +364,8 @@ GraphTableTupleUpdate(ModifyGraphState *mgstate, Oid tts_value_type,
 		return (Datum) 0;
 	}
 
-	relid = get_labid_relid(mgstate->graphid,
-							GraphidGetLabid(DatumGetGraphid(gid)));
-	resultRelInfo = getResultRelInfo(mgstate, relid);
+	sls = getSetLabelState(mgstate, tts_value_type, DatumGetGraphid(gid));
+	resultRelInfo = sls->resultRelInfo;
 
 	resultRelationDesc = resultRelInfo->ri_RelationDesc;
 
@@ -374,12 +413,15 @@ lreplace:
 	if (resultRelationDesc->rd_att->constr)
 		ExecConstraints(resultRelInfo, elemTupleSlot, estate);
 
-	result = table_tuple_update(resultRelationDesc, ctid, elemTupleSlot,
-								mgstate->modify_cid + MODIFY_CID_SET,
-								estate->es_snapshot,
-								estate->es_crosscheck_snapshot,
-								true /* wait for commit */ ,
-								&tmfd, &lockmode, &update_indexes);
+	result = table_tuple_update_hot_safe(resultRelationDesc, ctid,
+										 elemTupleSlot,
+										 mgstate->modify_cid + MODIFY_CID_SET,
+										 estate->es_snapshot,
+										 estate->es_crosscheck_snapshot,
+										 true /* wait for commit */ ,
+										 getHotSafeAttrs(mgstate, sls, ctid,
+														 elemTupleSlot),
+										 &tmfd, &lockmode, &update_indexes);
 
 	switch (result)
 	{
@@ -461,7 +503,7 @@ lreplace:
 						 * redundant update, otherwise error out.
 						 *
 						 * See also TM_SelfModified response to
-						 * table_tuple_update() above.
+						 * table_tuple_update_hot_safe() above.
 						 */
 						if (tmfd.cmax != estate->es_output_cid)
 							ereport(ERROR,
@@ -497,8 +539,6 @@ lreplace:
 
 	list_free(recheckIndexes);
 
-	entry = hash_search(mgstate->elemTable, &gid, HASH_ENTER, &hash_found);
-
 	if (tts_value_type == VERTEXOID)
 	{
 		inserted_datum = makeGraphVertexDatum(gid,
@@ -513,7 +553,8 @@ lreplace:
 											tts_values[Anum_ag_edge_properties - 1],
 											PointerGetDatum(&elemTupleSlot->tts_tid));
 	}
-	entry->elem = inserted_datum;
+	storeModifiedElem(mgstate->elemTable, DatumGetGraphid(gid),
+					  inserted_datum);
 	return inserted_datum;
 }
 
@@ -525,7 +566,7 @@ LegacyUpdateElemProp(ModifyGraphState *mgstate, Oid elemtype, Datum gid,
 	EState	   *estate = mgstate->ps.state;
 	EPQState   *epqstate = &mgstate->mt_epqstate;
 	TupleTableSlot *elemTupleSlot = mgstate->elemTupleSlot;
-	Oid			relid;
+	SetLabelState *sls;
 	ItemPointer ctid;
 	ResultRelInfo *resultRelInfo;
 	Relation	resultRelationDesc;
@@ -535,9 +576,8 @@ LegacyUpdateElemProp(ModifyGraphState *mgstate, Oid elemtype, Datum gid,
 	bool		update_indexes;
 	List	   *recheckIndexes = NIL;
 
-	relid = get_labid_relid(mgstate->graphid,
-							GraphidGetLabid(DatumGetGraphid(gid)));
-	resultRelInfo = getResultRelInfo(mgstate, relid);
+	sls = getSetLabelState(mgstate, elemtype, DatumGetGraphid(gid));
+	resultRelInfo = sls->resultRelInfo;
 	resultRelationDesc = resultRelInfo->ri_RelationDesc;
 
 	/*
@@ -587,12 +627,15 @@ LegacyUpdateElemProp(ModifyGraphState *mgstate, Oid elemtype, Datum gid,
 	if (resultRelationDesc->rd_att->constr)
 		ExecConstraints(resultRelInfo, elemTupleSlot, estate);
 
-	result = table_tuple_update(resultRelationDesc, ctid, elemTupleSlot,
-								mgstate->modify_cid + MODIFY_CID_SET,
-								estate->es_snapshot,
-								estate->es_crosscheck_snapshot,
-								true /* wait for commit */ ,
-								&tmfd, &lockmode, &update_indexes);
+	result = table_tuple_update_hot_safe(resultRelationDesc, ctid,
+										 elemTupleSlot,
+										 mgstate->modify_cid + MODIFY_CID_SET,
+										 estate->es_snapshot,
+										 estate->es_crosscheck_snapshot,
+										 true /* wait for commit */ ,
+										 getHotSafeAttrs(mgstate, sls, ctid,
+														 elemTupleSlot),
+										 &tmfd, &lockmode, &update_indexes);
 
 	switch (result)
 	{
@@ -663,21 +706,236 @@ makeModifiedElem(Datum elem, Oid elemtype,
 static void
 updateElementTable(ModifyGraphState *mgstate, Datum gid, Datum newelem)
 {
-	ModifiedElemEntry *entry;
-	bool		found;
+	Graphid		key = DatumGetGraphid(gid);
+
+	if (storeModifiedElem(mgstate->elemTable, key, newelem) &&
+		!enable_multiple_update)
+		ereport(WARNING,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("graph element(%hu," UINT64_FORMAT ") has been SET multiple times",
+						GraphidGetLabid(key),
+						GraphidGetLocid(key))));
+}
+
+/*
+ * getSetLabelState
+ *
+ * Returns the state of the label of the given element, setting it up the
+ * first time an element of the label is SET.
+ */
+static SetLabelState *
+getSetLabelState(ModifyGraphState *mgstate, Oid elemtype, Graphid gid)
+{
+	Labid		labid = GraphidGetLabid(gid);
+	SetLabelState *sls = mgstate->lastSetLabel;
+	ResultRelInfo *resultRelInfo;
+	int			i;
+
+	if (sls != NULL && sls->labid == labid)
+		return sls;
 
-	entry = hash_search(mgstate->elemTable, &gid, HASH_ENTER, &found);
-	if (found)
+	for (i = 0; i < mgstate->numSetLabels; i++)
 	{
-		if (enable_multiple_update)
-			pfree(DatumGetPointer(entry->elem));
-		else
-			ereport(WARNING,
-					(errcode(ERRCODE_INTERNAL_ERROR),
-					 errmsg("graph element(%hu," UINT64_FORMAT ") has been SET multiple times",
-							GraphidGetLabid(entry->key),
-							GraphidGetLocid(entry->key))));
+		sls = &mgstate->setLabels[i];
+		if (sls->labid == labid)
+		{
+			mgstate->lastSetLabel = sls;
+			return sls;
+		}
+	}
+
+	resultRelInfo = getResultRelInfo(mgstate,
+									 get_labid_relid(mgstate->graphid, labid));
+
+	/* every label has its own result relation */
+	if (mgstate->setLabels == NULL)
+		mgstate->setLabels = (SetLabelState *)
+			MemoryContextAlloc(mgstate->ps.state->es_query_cxt,
+							   sizeof(SetLabelState) *
+							   mgstate->numResultRelInfo);
+	Assert(mgstate->numSetLabels < mgstate->numResultRelInfo);
+
+	sls = &mgstate->setLabels[mgstate->numSetLabels];
+	initSetLabelState(mgstate, sls, elemtype, labid, resultRelInfo);
+	mgstate->numSetLabels++;
+
+	mgstate->lastSetLabel = sls;
+	return sls;
+}
+
+static void
+initSetLabelState(ModifyGraphState *mgstate, SetLabelState *sls,
+				  Oid elemtype, Labid labid, ResultRelInfo *resultRelInfo)
+{
+	EState	   *estate = mgstate->ps.state;
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	AttrNumber	propattno;
+	MemoryContext oldmctx;
+	int			i;
+
+	sls->labid = labid;
+	sls->resultRelInfo = resultRelInfo;
+	sls->numPropIndexes = 0;
+	sls->propIndexes = NULL;
+	sls->propAttrs = NULL;
+	sls->oldSlot = NULL;
+
+	if (elemtype == VERTEXOID)
+		propattno = Anum_ag_vertex_properties;
+	else
+		propattno = Anum_ag_edge_properties;
+
+	oldmctx = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	for (i = 0; i < resultRelInfo->ri_NumIndices; i++)
+	{
+		IndexInfo  *indexInfo = resultRelInfo->ri_IndexRelationInfo[i];
+		Bitmapset  *attrs = NULL;
+		SetPropIndex *propIndex;
+		ListCell   *indexpr_item;
+		int			k;
+
+		/*
+		 * If the property map itself is indexed, any change of it needs new
+		 * index entries.
+		 */
+		for (k = 0; k < indexInfo->ii_NumIndexAttrs; k++)
+		{
+			if (indexInfo->ii_IndexAttrNumbers[k] == propattno)
+			{
+				sls->numPropIndexes = 0;
+				MemoryContextSwitchTo(oldmctx);
+				return;
+			}
+		}
+
+		pull_varattnos((Node *) indexInfo->ii_Expressions, 1, &attrs);
+		pull_varattnos((Node *) indexInfo->ii_Predicate, 1, &attrs);
+		if (!bms_is_member(propattno - FirstLowInvalidHeapAttributeNumber,
+						   attrs))
+			continue;
+
+		if (sls->propIndexes == NULL)
+			sls->propIndexes = palloc(sizeof(SetPropIndex) *
+									  resultRelInfo->ri_NumIndices);
+		propIndex = &sls->propIndexes[sls->numPropIndexes++];
+		propIndex->indexno = i;
+
+		indexpr_item = list_head(indexInfo->ii_Expressions);
+		for (k = 0; k < indexInfo->ii_NumIndexAttrs; k++)
+		{
+			AttrNumber	attnum = indexInfo->ii_IndexAttrNumbers[k];
+
+			if (attnum != 0)
+			{
+				Form_pg_attribute attr = TupleDescAttr(tupdesc, attnum - 1);
+
+				propIndex->typlen[k] = attr->attlen;
+				propIndex->typbyval[k] = attr->attbyval;
+			}
+			else
+			{
+				Node	   *indexpr = (Node *) lfirst(indexpr_item);
+
+				get_typlenbyval(exprType(indexpr), &propIndex->typlen[k],
+								&propIndex->typbyval[k]);
+				indexpr_item = lnext(indexInfo->ii_Expressions, indexpr_item);
+			}
+		}
+	}
+
+	if (sls->numPropIndexes > 0)
+	{
+		sls->propAttrs =
+			bms_make_singleton(propattno - FirstLowInvalidHeapAttributeNumber);
+		sls->oldSlot = table_slot_create(rel, &estate->es_tupleTable);
+	}
+
+	MemoryContextSwitchTo(oldmctx);
+}
+
+/*
+ * getHotSafeAttrs
+ *
+ * Returns the properties column if the new version of the element leaves
+ * the entries of all property indexes of its label as they are, so that it
+ * does not prevent a HOT update.  See table_tuple_update_hot_safe().
+ */
+static Bitmapset *
+getHotSafeAttrs(ModifyGraphState *mgstate, SetLabelState *sls,
+				ItemPointer otid, TupleTableSlot *newslot)
+{
+	EState	   *estate = mgstate->ps.state;
+	ExprContext *econtext = GetPerTupleExprContext(estate);
+	ResultRelInfo *resultRelInfo = sls->resultRelInfo;
+	TupleTableSlot *oldslot = sls->oldSlot;
+	bool		unchanged = true;
+	int			i;
+
+	if (sls->propAttrs == NULL)
+		return NULL;
+
+	/* the tuple at otid cannot change, so any version of it will do */
+	if (!table_tuple_fetch_row_version(resultRelInfo->ri_RelationDesc, otid,
+									   SnapshotAny, oldslot))
+		return NULL;
+
+	for (i = 0; i < sls->numPropIndexes && unchanged; i++)
+	{
+		SetPropIndex *propIndex = &sls->propIndexes[i];
+		IndexInfo  *indexInfo =
+		resultRelInfo->ri_IndexRelationInfo[propIndex->indexno];
+		Datum		oldvalues[INDEX_MAX_KEYS];
+		bool		oldisnull[INDEX_MAX_KEYS];
+		Datum		newvalues[INDEX_MAX_KEYS];
+		bool		newisnull[INDEX_MAX_KEYS];
+		int			k;
+
+		/* the element must stay in or out of a partial index */
+		if (indexInfo->ii_Predicate != NIL)
+		{
+			bool		oldmatch;
+			bool		newmatch;
+
+			if (indexInfo->ii_PredicateState == NULL)
+				indexInfo->ii_PredicateState =
+					ExecPrepareQual(indexInfo->ii_Predicate, estate);
+
+			econtext->ecxt_scantuple = oldslot;
+			oldmatch = ExecQual(indexInfo->ii_PredicateState, econtext);
+			econtext->ecxt_scantuple = newslot;
+			newmatch = ExecQual(indexInfo->ii_PredicateState, econtext);
+
+			if (oldmatch != newmatch)
+			{
+				unchanged = false;
+				break;
+			}
+			if (!oldmatch)
+				continue;
+		}
+
+		econtext->ecxt_scantuple = oldslot;
+		FormIndexDatum(indexInfo, oldslot, estate, oldvalues, oldisnull);
+		econtext->ecxt_scantuple = newslot;
+		FormIndexDatum(indexInfo, newslot, estate, newvalues, newisnull);
+
+		for (k = 0; k < indexInfo->ii_NumIndexAttrs; k++)
+		{
+			if (oldisnull[k] != newisnull[k] ||
+				(!oldisnull[k] &&
+				 !datum_image_eq(oldvalues[k], newvalues[k],
+								 propIndex->typbyval[k],
+								 propIndex->typlen[k])))
+			{
+				unchanged = false;
+				break;
+			}
+		}
 	}
 
-	entry->elem = datumCopy(newelem, false, -1);
+	ExecClearTuple(oldslot);
+
+	return (unchanged ? sls->propAttrs : NULL);
 }
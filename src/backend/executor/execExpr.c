@@ -4336,6 +4336,7 @@ ExecInitCypherAccess(ExprEvalStep *scratch, CypherAccessExpr *accessexpr,
 {
 	Datum	   *argvalue;
 	bool	   *argnull;
+	CypherAccessArgCache *argcache;
 	int			pathlen;
 	CypherAccessPathElem *path;
 	int			i;
@@ -4347,6 +4348,26 @@ ExecInitCypherAccess(ExprEvalStep *scratch, CypherAccessExpr *accessexpr,
 	argnull = (bool *) palloc(sizeof(bool));
 	ExecInitExprRec(accessexpr->arg, state, argvalue, argnull);
 
+	argcache = NULL;
+	foreach(le, state->cypheraccess_argcaches)
+	{
+		CypherAccessArgCache *c = lfirst(le);
+
+		if (equal(c->arg, accessexpr->arg))
+		{
+			argcache = c;
+			break;
+		}
+	}
+	if (argcache == NULL)
+	{
+		argcache = palloc0(sizeof(*argcache));
+		argcache->arg = accessexpr->arg;
+		argcache->mcxt = CurrentMemoryContext;
+		state->cypheraccess_argcaches =
+			lappend(state->cypheraccess_argcaches, argcache);
+	}
+
 	pathlen = list_length(accessexpr->path);
 	path = (CypherAccessPathElem *)
 		palloc(sizeof(CypherAccessPathElem) * pathlen);
@@ -4377,6 +4398,7 @@ ExecInitCypherAccess(ExprEvalStep *scratch, CypherAccessExpr *accessexpr,
 	scratch->opcode = EEOP_CYPHERACCESSEXPR;
 	scratch->d.cypheraccessexpr.argvalue = argvalue;
 	scratch->d.cypheraccessexpr.argnull = argnull;
+	scratch->d.cypheraccessexpr.argcache = argcache;
 	scratch->d.cypheraccessexpr.path = path;
 	scratch->d.cypheraccessexpr.pathlen = pathlen;
 	ExprEvalPushStep(state, scratch);
@@ -56,6 +56,7 @@
  */
 #include "postgres.h"
 
+#include "access/detoast.h"
 #include "access/heaptoast.h"
 #include "catalog/pg_type.h"
 #include "commands/sequence.h"
@@ -181,6 +182,7 @@ static pg_attribute_always_inline void ExecAggPlainTransByRef(AggState *aggstate
 															  ExprContext *aggcontext,
 															  int setno);
 
+static Jsonb *cypher_access_arg(CypherAccessArgCache *argcache, Datum value);
 static JsonbValue *cypher_access_object(JsonbContainer *container,
 										CypherAccessPathElem *pathelem);
 static JsonbValue *cypher_access_bin_array(JsonbValue *ajv,
@@ -4824,7 +4826,8 @@ ExecEvalCypherAccessExpr(ExprState *state, ExprEvalStep *op)
 		return;
 	}
 
-	argjb = DatumGetJsonbP(*op->d.cypheraccessexpr.argvalue);
+	argjb = cypher_access_arg(op->d.cypheraccessexpr.argcache,
+							  *op->d.cypheraccessexpr.argvalue);
 	if (JB_ROOT_IS_SCALAR(argjb))
 	{
 		vjv = getIthJsonbValueFromContainer(&argjb->root, 0);
@@ -4909,6 +4912,80 @@ ExecEvalCypherAccessExpr(ExprState *state, ExprEvalStep *op)
 	*op->resnull = false;
 }
 
+/*
+ * Compressed property maps larger than this are detoasted on every access
+ * rather than kept to be compared with the next ones.  The maps compressed
+ * inline in heap tuples are normally smaller.
+ */
+#define CYPHER_ACCESS_MAX_RAWSIZE	TOAST_TUPLE_THRESHOLD
+
+/*
+ * Detoast the property map, reusing the result of the last access on the same
+ * map expression if the toasted value is the same.
+ */
+static Jsonb *
+cypher_access_arg(CypherAccessArgCache *argcache, Datum value)
+{
+	struct varlena *raw = (struct varlena *) DatumGetPointer(value);
+	struct varatt_external toast_pointer;
+	Size		rawsize = 0;
+	Jsonb	   *jb;
+	MemoryContext oldcxt;
+
+	if (VARATT_IS_EXTERNAL_ONDISK(raw))
+	{
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, raw);
+		if (argcache->ondisk &&
+			memcmp(&argcache->toast_pointer, &toast_pointer,
+				   sizeof(toast_pointer)) == 0)
+			return (Jsonb *) argcache->value;
+	}
+	else if (VARATT_IS_COMPRESSED(raw) &&
+			 VARSIZE_ANY(raw) <= CYPHER_ACCESS_MAX_RAWSIZE)
+	{
+		rawsize = VARSIZE_ANY(raw);
+		if (argcache->rawvalue != NULL &&
+			VARSIZE_ANY(argcache->rawvalue) == rawsize &&
+			memcmp(argcache->rawvalue, raw, rawsize) == 0)
+			return (Jsonb *) argcache->value;
+	}
+	else
+	{
+		/* expanded and indirect values are pointers to memory, don't keep them */
+		return DatumGetJsonbP(value);
+	}
+
+	if (argcache->value != NULL)
+	{
+		pfree(argcache->value);
+		argcache->value = NULL;
+	}
+	if (argcache->rawvalue != NULL)
+	{
+		pfree(argcache->rawvalue);
+		argcache->rawvalue = NULL;
+	}
+	argcache->ondisk = false;
+
+	oldcxt = MemoryContextSwitchTo(argcache->mcxt);
+	jb = DatumGetJsonbP(value);
+	if (rawsize > 0)
+	{
+		argcache->rawvalue = palloc(rawsize);
+		memcpy(argcache->rawvalue, raw, rawsize);
+	}
+	else
+	{
+		argcache->ondisk = true;
+		argcache->toast_pointer = toast_pointer;
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	argcache->value = (struct varlena *) jb;
+
+	return jb;
+}
+
 static JsonbValue *
 cypher_access_object(JsonbContainer *container, CypherAccessPathElem *pathelem)
 {
@@ -16,10 +16,16 @@
 #include "catalog/pg_inherits.h"
 #include "utils/lsyscache.h"
 #include "catalog/ag_graph_fn.h"
+#include "catalog/ag_label_fn.h"
+#include "access/genam.h"
 #include "access/table.h"
 #include "access/relscan.h"
 #include "access/tableam.h"
 #include "access/skey.h"
+#include "common/hashfn.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "utils/adjcache.h"
 #include "utils/fmgroids.h"
 
 #define VAR_START_VID	0
@@ -32,26 +38,60 @@
 
 #define MAXIMUM_OUTPUT_DEPTH_UNLIMITED  (INT_MAX)
 
+/*
+ * Edge labels smaller than this are scanned sequentially. Probing the btree
+ * costs a descent from the root plus a heap fetch, which does not pay off
+ * until the label spans more than a few pages.
+ */
+#define VLE_INDEX_SCAN_MIN_BLOCKS	4
+
 static TupleTableSlot *ExecGraphVLE(PlanState *pstate);
 
 static bool ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id);
+static bool ExecGraphVLEBFS(GraphVLEState *vle_state);
 
 static void array_clear(ArrayBuildState *astate);
 static void array_pop(ArrayBuildState *astate);
-static inline bool array_has(ArrayBuildState *astate, Graphid edge_id);
 
 /*
- * Idea for Edge uniqueness.
+ * Edge uniqueness.
  *
- * VLEDepthCtx have rel_index. so, we can use rel_index to identify the target
- * table.
- *
- * Bitmap set designed to 2-byte. but, label id is 6-byte...
+ * The ids of the edges on the current path are kept in a hash set next to
+ * `edge_ids`, and pushed and popped with it at each depth, so that checking a
+ * candidate edge does not cost a scan over the whole path.
  */
+typedef struct VLEEdgeIdEntry
+{
+	Graphid		edge_id;
+	char		status;			/* for simplehash */
+} VLEEdgeIdEntry;
+
+#define SH_PREFIX vle_edgeset
+#define SH_ELEMENT_TYPE VLEEdgeIdEntry
+#define SH_KEY_TYPE Graphid
+#define SH_KEY edge_id
+#define SH_HASH_KEY(tb, key) murmurhash32((uint32) ((key) ^ ((key) >> 32)))
+#define SH_EQUAL(tb, a, b) ((a) == (b))
+#define SH_SCOPE static inline
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+static void edge_ids_push(GraphVLEState *vle_state, Graphid edge_id);
+static void edge_ids_pop(GraphVLEState *vle_state);
+static void edge_ids_clear(GraphVLEState *vle_state);
 
 typedef struct VLEDepthCtx
 {
-	TableScanDesc desc;
+	TableScanDesc desc;			/* heap scan, if the label has no usable index */
+	IndexScanDesc index_desc;	/* index scan in use, one of index_descs */
+	IndexScanDesc *index_descs; /* (start, end) index scans per target label,
+								 * begun lazily and kept open for rescans */
+	TIDBitmap  *filter_tbm;		/* GIN matches of the filter for index_desc */
+	bool		adj_scan;		/* scanning adj_edges from the adjacency cache */
+	AdjCacheEdge *adj_edges;
+	int			adj_nedges;
+	int			adj_pos;
 	int			rel_index;
 	Graphid		start_id;
 	Graphid		end_id;
@@ -60,11 +100,47 @@ typedef struct VLEDepthCtx
 	uint8		direction_rotate;
 } VLEDepthCtx;
 
+/*
+ * A path expanded by the breadth-first search. Paths share their prefixes
+ * through `parent`; the path of the start vertex itself has no parent.
+ */
+typedef struct VLEPathNode
+{
+	struct VLEPathNode *parent;
+	int			depth;
+	Graphid		end_id;			/* vertex the path ends at */
+	Graphid		edge_id;		/* last edge of the path */
+	Datum		edge;
+	Datum		vertex;			/* vertex of end_id, if use_vertex_output */
+} VLEPathNode;
+
 static inline bool is_over_max_depth(GraphVLEState *vle_state, int depth);
+static bool edge_matches_filter(GraphVLEState *vle_state,
+								VLEDepthCtx *vle_depth_ctx);
+static TIDBitmap *get_filter_bitmap(GraphVLEState *vle_state, int rel_index);
+static VLEDepthCtx *make_depth_ctx(GraphVLEState *vle_state);
+static void bfs_start(GraphVLEState *vle_state, Graphid start_id);
+static void bfs_expand_level(GraphVLEState *vle_state);
+static void bfs_expand_vertex(GraphVLEState *vle_state, VLEPathNode **paths,
+							  int npaths, AttrNumber attnum);
+static void bfs_fetch_vertices(GraphVLEState *vle_state);
+static bool bfs_path_has_edge(VLEPathNode *path, Graphid edge_id);
+static void bfs_set_output(GraphVLEState *vle_state, VLEPathNode *path);
+static int	path_node_cmp_end_id(const void *a, const void *b);
+static void push_depth_ctx(GraphVLEState *vle_state, Graphid start_id,
+						   Graphid end_id, Graphid prev_end_id);
+static void pop_depth_ctx(GraphVLEState *vle_state);
+static void release_depth_ctxs(GraphVLEState *vle_state);
 static bool create_scan_desc(GraphVLEState *vle_state, VLEDepthCtx *vle_depth_ctx);
 static bool create_none_direction_scan_desc(GraphVLEState *vle_state,
 											VLEDepthCtx *vle_depth_ctx);
-static void free_scan_desc(VLEDepthCtx *vle_depth_ctx);
+static void begin_edge_scan(GraphVLEState *vle_state,
+							VLEDepthCtx *vle_depth_ctx,
+							AttrNumber attnum, Graphid vertex_id);
+static bool edge_scan_getnext(GraphVLEState *vle_state,
+							  VLEDepthCtx *vle_depth_ctx);
+static void end_edge_scan(VLEDepthCtx *vle_depth_ctx);
+static void free_scan_desc(GraphVLEState *vle_state, VLEDepthCtx *vle_depth_ctx);
 
 GraphVLEState *
 ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
@@ -103,6 +179,7 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 		vle_state->maximum_output_depth = MAXIMUM_OUTPUT_DEPTH_UNLIMITED;
 	}
 	vle_state->cypher_rel_direction = VLERel(vleplan)->direction;
+	vle_state->bfs = vleplan->bfs;
 
 	/*
 	 * initialize tuple type and projection info
@@ -119,6 +196,8 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 	ExecAssignExprContext(estate, &vle_state->ps);
 
 	vle_state->use_vertex_output = vle_state->ps.ps_ResultTupleDesc->natts > VAR_VERTICES;
+	if (vle_state->use_vertex_output)
+		vle_state->vertex_cache = create_graph_vertex_cache(estate->es_snapshot);
 
 	/* P-Map Jsonb */
 	if (VLERel(vleplan)->prop_map)
@@ -132,6 +211,10 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 															  econtext,
 															  &is_null));
 		ResetExprContext(econtext);
+
+		/* every property map contains an empty one */
+		if (JB_ROOT_COUNT(vle_state->jsonb_filter) == 0)
+			vle_state->jsonb_filter = NULL;
 	}
 	else
 	{
@@ -162,6 +245,16 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 												list_length(scan_label_oids) * sizeof(ResultRelInfo));
 	vle_state->target_rel_infos = target_rel_infos;
 	vle_state->num_target_rel_info = list_length(scan_label_oids);
+	vle_state->start_index_rels = (Relation *)
+		palloc0(list_length(scan_label_oids) * sizeof(Relation));
+	vle_state->end_index_rels = (Relation *)
+		palloc0(list_length(scan_label_oids) * sizeof(Relation));
+	vle_state->adjcache_refs = (AdjCacheRef *)
+		palloc0(list_length(scan_label_oids) * sizeof(AdjCacheRef));
+	vle_state->filter_index_rels = (Relation *)
+		palloc0(list_length(scan_label_oids) * sizeof(Relation));
+	vle_state->filter_tbms = (TIDBitmap **)
+		palloc0(list_length(scan_label_oids) * sizeof(TIDBitmap *));
 
 	/* Will be filled by below logic. */
 	vle_state->current_scan_tuple = NULL;
@@ -181,6 +274,50 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 						  NULL,
 						  0);
 		ExecOpenIndices(target_rel_infos, false);
+
+		/*
+		 * Expand each depth through the (start, end) and (end, start) btree
+		 * indexes, if the label is large enough for that to pay off.
+		 */
+		if (RelationGetNumberOfBlocks(relation) >= VLE_INDEX_SCAN_MIN_BLOCKS)
+		{
+			int			rel_index = target_rel_infos - vle_state->target_rel_infos;
+			Oid			index_oid;
+
+			index_oid = get_label_btree_index(relation, Anum_table_edge_start);
+			if (OidIsValid(index_oid))
+				vle_state->start_index_rels[rel_index] =
+					index_open(index_oid, AccessShareLock);
+
+			index_oid = get_label_btree_index(relation, Anum_table_edge_end);
+			if (OidIsValid(index_oid))
+				vle_state->end_index_rels[rel_index] =
+					index_open(index_oid, AccessShareLock);
+
+			/*
+			 * With a GIN index on the properties, the index scans skip the
+			 * edges that cannot match the property map without visiting the
+			 * heap.
+			 */
+			if (vle_state->jsonb_filter != NULL)
+			{
+				index_oid = get_label_gin_index(relation,
+												Anum_table_edge_prop_map);
+				if (OidIsValid(index_oid))
+					vle_state->filter_index_rels[rel_index] =
+						index_open(index_oid, AccessShareLock);
+			}
+		}
+
+		/*
+		 * Use the shared adjacency cache if it has the label. Acquiring it
+		 * may scan the whole label, which EXPLAIN does not need.
+		 */
+		if (!(eflags & EXEC_FLAG_EXPLAIN_ONLY))
+			AdjCacheAcquire(relation, estate->es_snapshot,
+							&vle_state->adjcache_refs[target_rel_infos -
+													  vle_state->target_rel_infos]);
+
 		target_rel_infos++;
 	}
 
@@ -196,6 +333,7 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 	vle_state->edge_ids = initArrayResult(GRAPHIDOID,
 										  CurrentMemoryContext,
 										  false);
+	vle_state->edge_id_set = vle_edgeset_create(CurrentMemoryContext, 64, NULL);
 	vle_state->edges = initArrayResult(EDGEOID,
 									   CurrentMemoryContext,
 									   false);
@@ -210,6 +348,14 @@ ExecInitGraphVLE(GraphVLE *vleplan, EState *estate, int eflags)
 		vle_state->vertices = NULL;
 	}
 
+	if (vle_state->bfs)
+	{
+		vle_state->bfs_mcxt = AllocSetContextCreate(CurrentMemoryContext,
+													"GraphVLE BFS paths",
+													ALLOCSET_DEFAULT_SIZES);
+		vle_state->bfs_depth_ctx = make_depth_ctx(vle_state);
+	}
+
 	return vle_state;
 }
 
@@ -254,7 +400,7 @@ ExecGraphVLE(PlanState *pstate)
 				return NULL;
 
 			array_clear(vle_state->edges);
-			array_clear(vle_state->edge_ids);
+			edge_ids_clear(vle_state);
 
 			vle_state->first_start_id = DatumGetGraphid(vle_state->subplan_tuple->tts_values[VAR_START_VID]);
 
@@ -263,12 +409,16 @@ ExecGraphVLE(PlanState *pstate)
 				array_clear(vle_state->vertices);
 
 				accumArrayResult(vle_state->vertices,
-								 get_vertex_from_graphid(vle_state->first_start_id),
+								 get_vertex_from_graphid_cached(vle_state->vertex_cache,
+																vle_state->first_start_id),
 								 false,
 								 VERTEXOID,
 								 CurrentMemoryContext);
 			}
 
+			if (vle_state->bfs)
+				bfs_start(vle_state, vle_state->first_start_id);
+
 			if (0 >= vle_state->minimum_output_depth &&
 				0 <= vle_state->maximum_output_depth)
 			{
@@ -276,9 +426,10 @@ ExecGraphVLE(PlanState *pstate)
 			}
 		}
 
-		/* Do DFS. */
-		if (!ExecGraphVLEDFS(vle_state,
-							 vle_state->first_start_id))
+		/* Do BFS or DFS. */
+		if (vle_state->bfs ?
+			!ExecGraphVLEBFS(vle_state) :
+			!ExecGraphVLEDFS(vle_state, vle_state->first_start_id))
 		{
 			vle_state->need_new_sp_tuple = true;
 			continue;
@@ -333,21 +484,7 @@ ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id)
 
 	/* is first time? */
 	if (vle_state->table_scan_desc_list == NIL)
-	{
-		vle_depth_ctx = (VLEDepthCtx *) palloc(sizeof(VLEDepthCtx));
-		vle_depth_ctx->desc = NULL;
-		vle_depth_ctx->rel_index = 0;
-		vle_depth_ctx->start_id = start_id;
-		vle_depth_ctx->end_id = start_id;
-
-		/* None-directional scanning. */
-		vle_depth_ctx->direction_rotate = 0;
-		vle_depth_ctx->prev_end_id = start_id;
-
-		create_scan_desc(vle_state, vle_depth_ctx); /* never not failing */
-		vle_state->table_scan_desc_list = lappend(vle_state->table_scan_desc_list,
-												  vle_depth_ctx);
-	}
+		push_depth_ctx(vle_state, start_id, start_id, start_id);
 
 	for (;;)
 	{
@@ -358,16 +495,13 @@ ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id)
 
 		vle_depth_ctx = llast(vle_state->table_scan_desc_list);
 
-		if (!table_scan_getnextslot(vle_depth_ctx->desc,
-									ForwardScanDirection,
-									vle_state->current_scan_tuple))
+		if (!edge_scan_getnext(vle_state, vle_depth_ctx))
 		{
 			/* find next target relation */
 			if (!create_scan_desc(vle_state, vle_depth_ctx))
 			{
 				/* move back depth. */
-				free_scan_desc(vle_depth_ctx);
-				vle_state->table_scan_desc_list = list_delete_last(vle_state->table_scan_desc_list);
+				pop_depth_ctx(vle_state);
 				if (vle_state->table_scan_desc_list == NIL)
 				{
 					/* terminate current tuple scan */
@@ -378,48 +512,32 @@ ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id)
 		}
 
 		/*
-		 * Fetch all attributes.
-		 *
-		 * todo: Make sure it is necessary from the results and branch out.
+		 * Deform only id, start and end until the edge is known to extend
+		 * the path. The properties are needed only for the filter and the
+		 * output.
 		 */
-		slot_getallattrs(vle_state->current_scan_tuple);
-
-		/* Property filtering. */
-		if (vle_state->jsonb_filter)
-		{
-			bool		isnull;
-			Jsonb	   *val = DatumGetJsonbP(slot_getattr(vle_state->current_scan_tuple,
-														  Anum_table_edge_prop_map,
-														  &isnull));
-			Jsonb	   *tmpl = vle_state->jsonb_filter;
-			JsonbIterator *it1,
-					   *it2;
-
-			it1 = JsonbIteratorInit(&val->root);
-			it2 = JsonbIteratorInit(&tmpl->root);
-
-			if (!JsonbDeepContains(&it1, &it2))
-				continue;
-		}
-
-		edge_id = vle_state->current_scan_tuple->tts_values[Anum_table_edge_id - 1];
+		slot_getsomeattrs(vle_state->current_scan_tuple, Anum_table_edge_end);
+		edge_id = DatumGetGraphid(vle_state->current_scan_tuple->tts_values[Anum_table_edge_id - 1]);
 
 		vle_scan_depth = list_length(vle_state->table_scan_desc_list);
 
 		while (vle_state->edge_ids->nelems >= vle_scan_depth)
 		{
 			array_pop(vle_state->edges);
-			array_pop(vle_state->edge_ids);
+			edge_ids_pop(vle_state);
 			if (vle_state->use_vertex_output)
 				array_pop(vle_state->vertices);
 		}
 
-		/* It is un-efficient. but, easy. */
-		if (array_has(vle_state->edge_ids, edge_id))
+		if (vle_edgeset_lookup(vle_state->edge_id_set, edge_id) != NULL)
 		{
 			continue;
 		}
 
+		/* Property filtering. */
+		if (!edge_matches_filter(vle_state, vle_depth_ctx))
+			continue;
+
 		/* Will be used from ExecGraphVLE() */
 		new_start_id = DatumGetGraphid(vle_state->current_scan_tuple->tts_values[Anum_table_edge_start - 1]);
 		new_end_id = DatumGetGraphid(vle_state->current_scan_tuple->tts_values[Anum_table_edge_end - 1]);
@@ -444,21 +562,19 @@ ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id)
 			}
 		}
 
+		slot_getallattrs(vle_state->current_scan_tuple);
 		accumArrayResult(vle_state->edges,
 						 make_edge_from_tuple(vle_state->current_scan_tuple),
 						 false,
 						 EDGEOID,
 						 CurrentMemoryContext);
-		accumArrayResult(vle_state->edge_ids,
-						 edge_id,
-						 false,
-						 GRAPHIDOID,
-						 CurrentMemoryContext);
+		edge_ids_push(vle_state, edge_id);
 
 		if (vle_state->use_vertex_output)
 		{
 			accumArrayResult(vle_state->vertices,
-							 get_vertex_from_graphid(vle_state->last_end_id),
+							 get_vertex_from_graphid_cached(vle_state->vertex_cache,
+															vle_state->last_end_id),
 							 false,
 							 VERTEXOID,
 							 CurrentMemoryContext);
@@ -470,22 +586,9 @@ ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id)
 		if (!is_over_max_depth(vle_state, vle_scan_depth + 1))
 		{
 			/* Move next depth */
-			VLEDepthCtx *top_vle_depth_ctx = vle_depth_ctx;
-
-			vle_depth_ctx = (VLEDepthCtx *) palloc(sizeof(VLEDepthCtx));
-			vle_depth_ctx->desc = NULL;
-			vle_depth_ctx->rel_index = 0;
-			vle_depth_ctx->start_id = new_start_id;
-			vle_depth_ctx->end_id = new_end_id;
-
-			/* None-directional scanning. */
-			vle_depth_ctx->direction_rotate = 0;
-			vle_depth_ctx->prev_end_id = top_vle_depth_ctx->prev_end_id == new_start_id ?
-				new_end_id : new_start_id;
-
-			create_scan_desc(vle_state, vle_depth_ctx); /* never not failing */
-			vle_state->table_scan_desc_list = lappend(vle_state->table_scan_desc_list,
-													  vle_depth_ctx);
+			push_depth_ctx(vle_state, new_start_id, new_end_id,
+						   vle_depth_ctx->prev_end_id == new_start_id ?
+						   new_end_id : new_start_id);
 		}
 
 		if (return_as_results)
@@ -497,13 +600,405 @@ ExecGraphVLEDFS(GraphVLEState *vle_state, Graphid start_id)
 	return true;
 }
 
+/*
+ * ExecGraphVLEBFS
+ *
+ * Sets edges, edge_ids (and vertices) to the next path found by expanding the
+ * paths from the start vertex level by level. Returns false if there is no
+ * more path that corresponds to the condition.
+ */
+static bool
+ExecGraphVLEBFS(GraphVLEState *vle_state)
+{
+	for (;;)
+	{
+		VLEPathNode **level = vle_state->bfs_level;
+
+		if (vle_state->bfs_level_pos < vle_state->bfs_level_len &&
+			vle_state->bfs_depth >= vle_state->minimum_output_depth)
+		{
+			bfs_set_output(vle_state, level[vle_state->bfs_level_pos++]);
+			return true;
+		}
+
+		if (vle_state->bfs_level_len == 0 ||
+			is_over_max_depth(vle_state, vle_state->bfs_depth + 1))
+			return false;
+
+		bfs_expand_level(vle_state);
+	}
+}
+
+/*
+ * Checks the current scan tuple against the property map of the relationship.
+ * Sequential scans have already checked it with their scan key.
+ */
+static bool
+edge_matches_filter(GraphVLEState *vle_state, VLEDepthCtx *vle_depth_ctx)
+{
+	bool		isnull;
+	Jsonb	   *val;
+	Jsonb	   *tmpl = vle_state->jsonb_filter;
+	JsonbIterator *it1,
+			   *it2;
+
+	if (tmpl == NULL || vle_depth_ctx->desc != NULL)
+		return true;
+
+	val = DatumGetJsonbP(slot_getattr(vle_state->current_scan_tuple,
+									  Anum_table_edge_prop_map,
+									  &isnull));
+
+	it1 = JsonbIteratorInit(&val->root);
+	it2 = JsonbIteratorInit(&tmpl->root);
+
+	return JsonbDeepContains(&it1, &it2);
+}
+
+/*
+ * Starts a new breadth-first search whose first level is the path of the
+ * start vertex alone. That path is never returned by ExecGraphVLEBFS(), since
+ * ExecGraphVLE() returns the subplan tuple itself for zero-length paths.
+ */
 static void
-free_scan_desc(VLEDepthCtx *vle_depth_ctx)
+bfs_start(GraphVLEState *vle_state, Graphid start_id)
 {
-	if (vle_depth_ctx->desc)
+	MemoryContext oldmcxt;
+	VLEPathNode *path;
+
+	MemoryContextReset(vle_state->bfs_mcxt);
+	oldmcxt = MemoryContextSwitchTo(vle_state->bfs_mcxt);
+
+	path = (VLEPathNode *) palloc0(sizeof(VLEPathNode));
+	path->end_id = start_id;
+
+	vle_state->bfs_level = palloc(sizeof(VLEPathNode *));
+	vle_state->bfs_level[0] = path;
+	vle_state->bfs_level_len = 1;
+	vle_state->bfs_level_pos = 1;
+	vle_state->bfs_depth = 0;
+
+	MemoryContextSwitchTo(oldmcxt);
+}
+
+/*
+ * Expands every path of the current level by one edge.
+ *
+ * The paths are sorted by the vertex they end at, so that the edge indexes
+ * are probed once per distinct vertex and in graphid order.
+ */
+static void
+bfs_expand_level(GraphVLEState *vle_state)
+{
+	VLEPathNode **level = vle_state->bfs_level;
+	int			nlevel = vle_state->bfs_level_len;
+	int			i;
+
+	vle_state->bfs_next_level = NULL;
+	vle_state->bfs_next_level_len = 0;
+	vle_state->bfs_next_level_size = 0;
+
+	qsort(level, nlevel, sizeof(VLEPathNode *), path_node_cmp_end_id);
+
+	i = 0;
+	while (i < nlevel)
 	{
-		table_endscan(vle_depth_ctx->desc);
+		VLEDepthCtx *vle_depth_ctx = vle_state->bfs_depth_ctx;
+		int			j = i + 1;
+
+		while (j < nlevel && level[j]->end_id == level[i]->end_id)
+			j++;
+
+		for (vle_depth_ctx->rel_index = 0;
+			 vle_depth_ctx->rel_index < vle_state->num_target_rel_info;
+			 vle_depth_ctx->rel_index++)
+		{
+			if (vle_state->cypher_rel_direction != CYPHER_REL_DIR_LEFT)
+				bfs_expand_vertex(vle_state, level + i, j - i,
+								  Anum_table_edge_start);
+			if (vle_state->cypher_rel_direction != CYPHER_REL_DIR_RIGHT)
+				bfs_expand_vertex(vle_state, level + i, j - i,
+								  Anum_table_edge_end);
+		}
+
+		i = j;
 	}
+
+	vle_state->bfs_level = vle_state->bfs_next_level;
+	vle_state->bfs_level_len = vle_state->bfs_next_level_len;
+	vle_state->bfs_level_pos = 0;
+	vle_state->bfs_depth++;
+
+	if (vle_state->use_vertex_output)
+		bfs_fetch_vertices(vle_state);
+}
+
+/*
+ * Fetches the end vertices of the paths of the current level all at once.
+ */
+static void
+bfs_fetch_vertices(GraphVLEState *vle_state)
+{
+	VLEPathNode **level = vle_state->bfs_level;
+	int			nlevel = vle_state->bfs_level_len;
+	MemoryContext oldmcxt;
+	Graphid    *vertex_ids;
+	Datum	   *vertices;
+	int			i;
+
+	if (nlevel == 0)
+		return;
+
+	oldmcxt = MemoryContextSwitchTo(vle_state->bfs_mcxt);
+
+	vertex_ids = palloc(nlevel * sizeof(Graphid));
+	vertices = palloc(nlevel * sizeof(Datum));
+	for (i = 0; i < nlevel; i++)
+		vertex_ids[i] = level[i]->end_id;
+
+	get_vertices_from_graphids(vle_state->vertex_cache, vertex_ids, nlevel,
+							   vertices);
+
+	for (i = 0; i < nlevel; i++)
+		level[i]->vertex = vertices[i];
+
+	pfree(vertex_ids);
+	pfree(vertices);
+
+	MemoryContextSwitchTo(oldmcxt);
+}
+
+/*
+ * Extends `paths`, which all end at the same vertex, with the edges of the
+ * current target label whose `attnum` column is that vertex.
+ */
+static void
+bfs_expand_vertex(GraphVLEState *vle_state, VLEPathNode **paths, int npaths,
+				  AttrNumber attnum)
+{
+	VLEDepthCtx *vle_depth_ctx = vle_state->bfs_depth_ctx;
+	TupleTableSlot *slot = vle_state->current_scan_tuple;
+
+	begin_edge_scan(vle_state, vle_depth_ctx, attnum, paths[0]->end_id);
+
+	while (edge_scan_getnext(vle_state, vle_depth_ctx))
+	{
+		MemoryContext oldmcxt;
+		Graphid		edge_id;
+		Graphid		end_id;
+		Datum		edge = (Datum) 0;
+		int			i;
+
+		if (!edge_matches_filter(vle_state, vle_depth_ctx))
+			continue;
+
+		slot_getallattrs(slot);
+
+		edge_id = DatumGetGraphid(slot->tts_values[Anum_table_edge_id - 1]);
+		if (attnum == Anum_table_edge_start)
+			end_id = DatumGetGraphid(slot->tts_values[Anum_table_edge_end - 1]);
+		else
+			end_id = DatumGetGraphid(slot->tts_values[Anum_table_edge_start - 1]);
+
+		oldmcxt = MemoryContextSwitchTo(vle_state->bfs_mcxt);
+
+		for (i = 0; i < npaths; i++)
+		{
+			VLEPathNode *path;
+
+			if (bfs_path_has_edge(paths[i], edge_id))
+				continue;
+
+			/* build the edge once for all the paths it extends */
+			if (edge == (Datum) 0)
+				edge = make_edge_from_tuple(slot);
+
+			path = (VLEPathNode *) palloc(sizeof(VLEPathNode));
+			path->parent = paths[i];
+			path->depth = paths[i]->depth + 1;
+			path->end_id = end_id;
+			path->edge_id = edge_id;
+			path->edge = edge;
+			path->vertex = (Datum) 0;	/* see bfs_fetch_vertices() */
+
+			if (vle_state->bfs_next_level_len >= vle_state->bfs_next_level_size)
+			{
+				if (vle_state->bfs_next_level_size == 0)
+				{
+					vle_state->bfs_next_level_size = 64;
+					vle_state->bfs_next_level =
+						palloc(vle_state->bfs_next_level_size *
+							   sizeof(VLEPathNode *));
+				}
+				else
+				{
+					vle_state->bfs_next_level_size *= 2;
+					vle_state->bfs_next_level =
+						repalloc(vle_state->bfs_next_level,
+								 vle_state->bfs_next_level_size *
+								 sizeof(VLEPathNode *));
+				}
+			}
+			vle_state->bfs_next_level[vle_state->bfs_next_level_len++] = path;
+		}
+
+		MemoryContextSwitchTo(oldmcxt);
+	}
+
+	end_edge_scan(vle_depth_ctx);
+}
+
+static bool
+bfs_path_has_edge(VLEPathNode *path, Graphid edge_id)
+{
+	for (; path->parent != NULL; path = path->parent)
+	{
+		if (path->edge_id == edge_id)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Fills the output arrays with the edges (and vertices) of `path`, the way
+ * ExecGraphVLEDFS() leaves them for ExecGraphVLE().
+ */
+static void
+bfs_set_output(GraphVLEState *vle_state, VLEPathNode *path)
+{
+	VLEPathNode **nodes;
+	VLEPathNode *node;
+	int			i;
+
+	array_clear(vle_state->edges);
+	edge_ids_clear(vle_state);
+	if (vle_state->use_vertex_output)
+	{
+		/* keep the start vertex */
+		while (vle_state->vertices->nelems > 1)
+			array_pop(vle_state->vertices);
+	}
+
+	nodes = (VLEPathNode **) palloc(path->depth * sizeof(VLEPathNode *));
+	i = path->depth;
+	for (node = path; node->parent != NULL; node = node->parent)
+		nodes[--i] = node;
+
+	for (i = 0; i < path->depth; i++)
+	{
+		accumArrayResult(vle_state->edges,
+						 nodes[i]->edge,
+						 false,
+						 EDGEOID,
+						 CurrentMemoryContext);
+		edge_ids_push(vle_state, nodes[i]->edge_id);
+		if (vle_state->use_vertex_output)
+			accumArrayResult(vle_state->vertices,
+							 nodes[i]->vertex,
+							 false,
+							 VERTEXOID,
+							 CurrentMemoryContext);
+	}
+
+	pfree(nodes);
+
+	vle_state->last_end_id = path->end_id;
+}
+
+static int
+path_node_cmp_end_id(const void *a, const void *b)
+{
+	Graphid		id1 = (*(VLEPathNode *const *) a)->end_id;
+	Graphid		id2 = (*(VLEPathNode *const *) b)->end_id;
+
+	if (id1 < id2)
+		return -1;
+	if (id1 > id2)
+		return 1;
+	return 0;
+}
+
+/*
+ * Pushes a new depth onto the DFS stack and starts scanning edges from it.
+ *
+ * Depth contexts popped earlier are reused, so that the index scans they hold
+ * are only rescanned with the new vertex id instead of being set up again.
+ */
+static void
+push_depth_ctx(GraphVLEState *vle_state, Graphid start_id, Graphid end_id,
+			   Graphid prev_end_id)
+{
+	VLEDepthCtx *vle_depth_ctx;
+
+	if (vle_state->free_depth_ctx_list != NIL)
+	{
+		vle_depth_ctx = llast(vle_state->free_depth_ctx_list);
+		vle_state->free_depth_ctx_list =
+			list_delete_last(vle_state->free_depth_ctx_list);
+	}
+	else
+	{
+		vle_depth_ctx = make_depth_ctx(vle_state);
+	}
+
+	vle_depth_ctx->rel_index = 0;
+	vle_depth_ctx->start_id = start_id;
+	vle_depth_ctx->end_id = end_id;
+
+	/* None-directional scanning. */
+	vle_depth_ctx->direction_rotate = 0;
+	vle_depth_ctx->prev_end_id = prev_end_id;
+
+	create_scan_desc(vle_state, vle_depth_ctx); /* never not failing */
+	vle_state->table_scan_desc_list = lappend(vle_state->table_scan_desc_list,
+											  vle_depth_ctx);
+}
+
+static VLEDepthCtx *
+make_depth_ctx(GraphVLEState *vle_state)
+{
+	VLEDepthCtx *vle_depth_ctx;
+
+	vle_depth_ctx = (VLEDepthCtx *) palloc0(sizeof(VLEDepthCtx));
+	vle_depth_ctx->index_descs = (IndexScanDesc *)
+		palloc0(vle_state->num_target_rel_info * 2 * sizeof(IndexScanDesc));
+
+	return vle_depth_ctx;
+}
+
+static void
+pop_depth_ctx(GraphVLEState *vle_state)
+{
+	VLEDepthCtx *vle_depth_ctx = llast(vle_state->table_scan_desc_list);
+
+	end_edge_scan(vle_depth_ctx);
+	vle_state->table_scan_desc_list =
+		list_delete_last(vle_state->table_scan_desc_list);
+	vle_state->free_depth_ctx_list =
+		lappend(vle_state->free_depth_ctx_list, vle_depth_ctx);
+}
+
+static void
+release_depth_ctxs(GraphVLEState *vle_state)
+{
+	while (vle_state->table_scan_desc_list != NIL)
+		pop_depth_ctx(vle_state);
+}
+
+static void
+free_scan_desc(GraphVLEState *vle_state, VLEDepthCtx *vle_depth_ctx)
+{
+	int			i;
+
+	end_edge_scan(vle_depth_ctx);
+
+	for (i = 0; i < vle_state->num_target_rel_info * 2; i++)
+	{
+		if (vle_depth_ctx->index_descs[i] != NULL)
+			index_endscan(vle_depth_ctx->index_descs[i]);
+	}
+	pfree(vle_depth_ctx->index_descs);
 	pfree(vle_depth_ctx);
 }
 
@@ -511,8 +1006,6 @@ static bool
 create_scan_desc(GraphVLEState *vle_state,
 				 VLEDepthCtx *vle_depth_ctx)
 {
-	ScanKeyData scan_key_data;
-	ResultRelInfo *result_rel_info = vle_state->target_rel_infos + vle_depth_ctx->rel_index;
 	uint32		cypher_rel_direction = vle_state->cypher_rel_direction;
 
 	if (vle_state->cypher_rel_direction == CYPHER_REL_DIR_NONE)
@@ -520,12 +1013,11 @@ create_scan_desc(GraphVLEState *vle_state,
 		return create_none_direction_scan_desc(vle_state, vle_depth_ctx);
 	}
 
-	if (vle_depth_ctx->desc != NULL)
+	if (vle_depth_ctx->desc != NULL || vle_depth_ctx->index_desc != NULL ||
+		vle_depth_ctx->adj_scan)
 	{
-		table_endscan(vle_depth_ctx->desc);
-		vle_depth_ctx->desc = NULL;
+		end_edge_scan(vle_depth_ctx);
 
-		result_rel_info++;
 		vle_depth_ctx->rel_index++;
 
 		if (vle_depth_ctx->rel_index >= vle_state->num_target_rel_info)
@@ -539,28 +1031,16 @@ create_scan_desc(GraphVLEState *vle_state,
 	if (cypher_rel_direction == CYPHER_REL_DIR_RIGHT)
 	{
 		/* CYPHER_REL_DIR_RIGHT, CYPHER_REL_DIR_NONE */
-		ScanKeyInit(&scan_key_data,
-					Anum_table_edge_start,
-					BTEqualStrategyNumber,
-					F_GRAPHID_EQ,
-					vle_depth_ctx->end_id);
+		begin_edge_scan(vle_state, vle_depth_ctx,
+						Anum_table_edge_start, vle_depth_ctx->end_id);
 	}
 	else if (cypher_rel_direction == CYPHER_REL_DIR_LEFT)
 	{
 		/* CYPHER_REL_DIR_LEFT, CYPHER_REL_DIR_NONE */
-		ScanKeyInit(&scan_key_data,
-					Anum_table_edge_end,
-					BTEqualStrategyNumber,
-					F_GRAPHID_EQ,
-					vle_depth_ctx->start_id);
+		begin_edge_scan(vle_state, vle_depth_ctx,
+						Anum_table_edge_end, vle_depth_ctx->start_id);
 	}
 
-	/* Create TableScanDesc */
-	vle_depth_ctx->desc = table_beginscan(result_rel_info->ri_RelationDesc,
-										  vle_state->ps.state->es_snapshot,
-										  1,
-										  &scan_key_data);
-
 	return true;
 }
 
@@ -568,18 +1048,14 @@ static bool
 create_none_direction_scan_desc(GraphVLEState *vle_state,
 								VLEDepthCtx *vle_depth_ctx)
 {
-	ScanKeyData scan_key_data;
-	ResultRelInfo *result_rel_info = vle_state->target_rel_infos + vle_depth_ctx->rel_index;
-
-	if (vle_depth_ctx->desc != NULL)
+	if (vle_depth_ctx->desc != NULL || vle_depth_ctx->index_desc != NULL ||
+		vle_depth_ctx->adj_scan)
 	{
-		table_endscan(vle_depth_ctx->desc);
-		vle_depth_ctx->desc = NULL;
+		end_edge_scan(vle_depth_ctx);
 
 		if (vle_depth_ctx->direction_rotate > 0)
 		{
 			vle_depth_ctx->direction_rotate = -1;
-			result_rel_info++;
 			vle_depth_ctx->rel_index++;
 
 			if (vle_depth_ctx->rel_index >= vle_state->num_target_rel_info)
@@ -594,29 +1070,229 @@ create_none_direction_scan_desc(GraphVLEState *vle_state,
 	if (vle_depth_ctx->direction_rotate == 0)
 	{
 		/* CYPHER_REL_DIR_RIGHT, CYPHER_REL_DIR_NONE */
-		ScanKeyInit(&scan_key_data,
-					Anum_table_edge_start,
+		begin_edge_scan(vle_state, vle_depth_ctx,
+						Anum_table_edge_start, vle_depth_ctx->prev_end_id);
+	}
+	else
+	{
+		/* CYPHER_REL_DIR_LEFT, CYPHER_REL_DIR_NONE */
+		begin_edge_scan(vle_state, vle_depth_ctx,
+						Anum_table_edge_end, vle_depth_ctx->prev_end_id);
+	}
+
+	return true;
+}
+
+/*
+ * Starts scanning the edges of the current target label whose `attnum`
+ * column (start or end) equals `vertex_id`.
+ */
+static void
+begin_edge_scan(GraphVLEState *vle_state, VLEDepthCtx *vle_depth_ctx,
+				AttrNumber attnum, Graphid vertex_id)
+{
+	int			rel_index = vle_depth_ctx->rel_index;
+	Relation	heap_rel = vle_state->target_rel_infos[rel_index].ri_RelationDesc;
+	Relation	index_rel;
+	ScanKeyData scan_key_data[2];
+	int			nkeys;
+
+	Assert(attnum == Anum_table_edge_start || attnum == Anum_table_edge_end);
+
+	if (OidIsValid(vle_state->adjcache_refs[rel_index].relid))
+	{
+		int			nedges;
+
+		nedges = AdjCacheLookup(&vle_state->adjcache_refs[rel_index],
+								vertex_id, attnum == Anum_table_edge_start,
+								&vle_depth_ctx->adj_edges);
+		if (nedges >= 0)
+		{
+			vle_depth_ctx->adj_scan = true;
+			vle_depth_ctx->adj_nedges = nedges;
+			vle_depth_ctx->adj_pos = 0;
+			return;
+		}
+
+		/* the label has been changed, stop using the cache */
+		vle_state->adjcache_refs[rel_index].relid = InvalidOid;
+	}
+
+	if (attnum == Anum_table_edge_start)
+		index_rel = vle_state->start_index_rels[rel_index];
+	else
+		index_rel = vle_state->end_index_rels[rel_index];
+
+	if (index_rel != NULL)
+	{
+		int			desc_index = rel_index * 2 +
+		(attnum == Anum_table_edge_start ? 0 : 1);
+		IndexScanDesc index_desc = vle_depth_ctx->index_descs[desc_index];
+
+		if (index_desc == NULL)
+		{
+			index_desc = index_beginscan(heap_rel, index_rel,
+										 vle_state->ps.state->es_snapshot,
+										 1, 0);
+			vle_depth_ctx->index_descs[desc_index] = index_desc;
+		}
+
+		/* the column is the leading key of the index */
+		ScanKeyInit(&scan_key_data[0],
+					1,
 					BTEqualStrategyNumber,
 					F_GRAPHID_EQ,
-					vle_depth_ctx->prev_end_id);
+					GraphidGetDatum(vertex_id));
+		index_rescan(index_desc, scan_key_data, 1, NULL, 0);
+
+		vle_depth_ctx->index_desc = index_desc;
+		vle_depth_ctx->filter_tbm = get_filter_bitmap(vle_state, rel_index);
 	}
 	else
 	{
-		/* CYPHER_REL_DIR_LEFT, CYPHER_REL_DIR_NONE */
-		ScanKeyInit(&scan_key_data,
-					Anum_table_edge_end,
+		ScanKeyInit(&scan_key_data[0],
+					attnum,
 					BTEqualStrategyNumber,
 					F_GRAPHID_EQ,
-					vle_depth_ctx->prev_end_id);
+					GraphidGetDatum(vertex_id));
+		nkeys = 1;
+
+		/* check the property map on the page, before the tuple is stored */
+		if (vle_state->jsonb_filter != NULL)
+		{
+			ScanKeyInit(&scan_key_data[1],
+						Anum_table_edge_prop_map,
+						JsonbContainsStrategyNumber,
+						F_JSONB_CONTAINS,
+						JsonbPGetDatum(vle_state->jsonb_filter));
+			nkeys = 2;
+		}
+
+		vle_depth_ctx->desc = table_beginscan(heap_rel,
+											  vle_state->ps.state->es_snapshot,
+											  nkeys,
+											  scan_key_data);
 	}
+}
 
-	/* Create TableScanDesc */
-	vle_depth_ctx->desc = table_beginscan(result_rel_info->ri_RelationDesc,
-										  vle_state->ps.state->es_snapshot,
-										  1,
-										  &scan_key_data);
+/*
+ * Returns the bitmap of the edges of the target label that the GIN index on
+ * its properties finds for the property map, or NULL if the label has no such
+ * index. The index returns the root of each HOT chain, as the btree indexes
+ * do, so an index scan can look up the TIDs it returns in the bitmap.
+ */
+static TIDBitmap *
+get_filter_bitmap(GraphVLEState *vle_state, int rel_index)
+{
+	Relation	index_rel = vle_state->filter_index_rels[rel_index];
+	TIDBitmap  *tbm = vle_state->filter_tbms[rel_index];
+	EState	   *estate = vle_state->ps.state;
+	IndexScanDesc scan;
+	ScanKeyData scan_key_data;
+	MemoryContext oldmcxt;
 
-	return true;
+	if (index_rel == NULL || tbm != NULL)
+		return tbm;
+
+	oldmcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	tbm = tbm_create(work_mem * 1024L, NULL);
+
+	scan = index_beginscan_bitmap(index_rel, estate->es_snapshot, 1);
+	ScanKeyInit(&scan_key_data,
+				1,
+				JsonbContainsStrategyNumber,
+				F_JSONB_CONTAINS,
+				JsonbPGetDatum(vle_state->jsonb_filter));
+	index_rescan(scan, &scan_key_data, 1, NULL, 0);
+	index_getbitmap(scan, tbm);
+	index_endscan(scan);
+
+	MemoryContextSwitchTo(oldmcxt);
+
+	vle_state->filter_tbms[rel_index] = tbm;
+
+	return tbm;
+}
+
+static bool
+edge_scan_getnext(GraphVLEState *vle_state, VLEDepthCtx *vle_depth_ctx)
+{
+	if (vle_depth_ctx->adj_scan)
+	{
+		Relation	heap_rel;
+
+		heap_rel = vle_state->target_rel_infos[vle_depth_ctx->rel_index].ri_RelationDesc;
+
+		/* the edges are fetched by TID, skipping those not visible to us */
+		while (vle_depth_ctx->adj_pos < vle_depth_ctx->adj_nedges)
+		{
+			AdjCacheEdge *edge;
+
+			edge = &vle_depth_ctx->adj_edges[vle_depth_ctx->adj_pos++];
+			if (table_tuple_fetch_row_version(heap_rel, &edge->tid,
+											  vle_state->ps.state->es_snapshot,
+											  vle_state->current_scan_tuple))
+				return true;
+		}
+
+		return false;
+	}
+
+	if (vle_depth_ctx->index_desc != NULL)
+	{
+		IndexScanDesc index_desc = vle_depth_ctx->index_desc;
+
+		if (vle_depth_ctx->filter_tbm == NULL)
+			return index_getnext_slot(index_desc, ForwardScanDirection,
+									  vle_state->current_scan_tuple);
+
+		/* skip the edges the GIN index rules out without visiting the heap */
+		for (;;)
+		{
+			if (!index_desc->xs_heap_continue)
+			{
+				ItemPointer tid;
+
+				tid = index_getnext_tid(index_desc, ForwardScanDirection);
+				if (tid == NULL)
+					return false;
+
+				if (!tbm_contains_tuple(vle_depth_ctx->filter_tbm, tid))
+					continue;
+			}
+
+			if (index_fetch_heap(index_desc, vle_state->current_scan_tuple))
+				return true;
+		}
+	}
+
+	return table_scan_getnextslot(vle_depth_ctx->desc,
+								  ForwardScanDirection,
+								  vle_state->current_scan_tuple);
+}
+
+/*
+ * Stops the current scan of the depth. Index scans are left open so that the
+ * next scan of the same label only needs a rescan.
+ */
+static void
+end_edge_scan(VLEDepthCtx *vle_depth_ctx)
+{
+	if (vle_depth_ctx->desc != NULL)
+	{
+		table_endscan(vle_depth_ctx->desc);
+		vle_depth_ctx->desc = NULL;
+	}
+	vle_depth_ctx->index_desc = NULL;
+	vle_depth_ctx->filter_tbm = NULL;
+
+	if (vle_depth_ctx->adj_edges != NULL)
+	{
+		pfree(vle_depth_ctx->adj_edges);
+		vle_depth_ctx->adj_edges = NULL;
+	}
+	vle_depth_ctx->adj_scan = false;
 }
 
 static inline bool
@@ -628,6 +1304,7 @@ is_over_max_depth(GraphVLEState *vle_state, int depth)
 void
 ExecReScanGraphVLE(GraphVLEState *vle_state)
 {
+	release_depth_ctxs(vle_state);
 	vle_state->need_new_sp_tuple = true;
 	ExecReScan(vle_state->subplan);
 }
@@ -639,23 +1316,45 @@ ExecEndGraphVLE(GraphVLEState *vle_state)
 	ListCell   *lc;
 	ResultRelInfo *result_rel_info = vle_state->target_rel_infos;
 
-	foreach(lc, vle_state->table_scan_desc_list)
+	release_depth_ctxs(vle_state);
+	foreach(lc, vle_state->free_depth_ctx_list)
 	{
 		VLEDepthCtx *vle_depth_ctx = lfirst(lc);
 
-		free_scan_desc(vle_depth_ctx);
+		free_scan_desc(vle_state, vle_depth_ctx);
+	}
+	list_free(vle_state->free_depth_ctx_list);
+	if (vle_state->bfs)
+	{
+		free_scan_desc(vle_state, vle_state->bfs_depth_ctx);
+		MemoryContextDelete(vle_state->bfs_mcxt);
 	}
-	list_free(vle_state->table_scan_desc_list);
 
 	ExecDropSingleTupleTableSlot(vle_state->current_scan_tuple);
+	vle_edgeset_destroy(vle_state->edge_id_set);
+	if (vle_state->use_vertex_output)
+		free_graph_vertex_cache(vle_state->vertex_cache);
 
 	for (i = 0; i < vle_state->num_target_rel_info; i++)
 	{
+		if (vle_state->start_index_rels[i] != NULL)
+			index_close(vle_state->start_index_rels[i], AccessShareLock);
+		if (vle_state->end_index_rels[i] != NULL)
+			index_close(vle_state->end_index_rels[i], AccessShareLock);
+		if (vle_state->filter_index_rels[i] != NULL)
+			index_close(vle_state->filter_index_rels[i], AccessShareLock);
+		if (vle_state->filter_tbms[i] != NULL)
+			tbm_free(vle_state->filter_tbms[i]);
 		ExecCloseIndices(result_rel_info);
 		table_close(result_rel_info->ri_RelationDesc, AccessShareLock);
 		result_rel_info++;
 	}
 	pfree(vle_state->target_rel_infos);
+	pfree(vle_state->start_index_rels);
+	pfree(vle_state->end_index_rels);
+	pfree(vle_state->adjcache_refs);
+	pfree(vle_state->filter_index_rels);
+	pfree(vle_state->filter_tbms);
 
 	/*
 	 * clean out the tuple table
@@ -690,18 +1389,36 @@ array_pop(ArrayBuildState *astate)
 	}
 }
 
-static inline bool
-array_has(ArrayBuildState *astate, Graphid edge_id)
+static void
+edge_ids_push(GraphVLEState *vle_state, Graphid edge_id)
 {
-	int			i;
+	bool		found;
+
+	accumArrayResult(vle_state->edge_ids,
+					 GraphidGetDatum(edge_id),
+					 false,
+					 GRAPHIDOID,
+					 CurrentMemoryContext);
+	vle_edgeset_insert(vle_state->edge_id_set, edge_id, &found);
+	Assert(!found);
+}
 
-	for (i = 0; i < astate->nelems; i++)
-	{
-		Graphid		cur_array_gid = DatumGetGraphid(astate->dvalues[i]);
+static void
+edge_ids_pop(GraphVLEState *vle_state)
+{
+	ArrayBuildState *astate = vle_state->edge_ids;
 
-		if (cur_array_gid == edge_id)
-			return true;
+	if (astate->nelems > 0)
+	{
+		vle_edgeset_delete(vle_state->edge_id_set,
+						   DatumGetGraphid(astate->dvalues[astate->nelems - 1]));
+		array_pop(astate);
 	}
+}
 
-	return false;
+static void
+edge_ids_clear(GraphVLEState *vle_state)
+{
+	array_clear(vle_state->edge_ids);
+	vle_edgeset_reset(vle_state->edge_id_set);
 }
@@ -27,6 +27,7 @@
 #include "parser/parsetree.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
+#include "utils/adjcache.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/lsyscache.h"
@@ -414,6 +415,7 @@ ExecSimpleRelationInsert(ResultRelInfo *resultRelInfo,
 	Assert(rel->rd_rel->relkind == RELKIND_RELATION);
 
 	CheckCmdReplicaIdentity(rel, CMD_INSERT);
+	AdjCacheRelationModified(rel);
 
 	/* BEFORE ROW INSERT Triggers */
 	if (resultRelInfo->ri_TrigDesc &&
@@ -480,6 +482,7 @@ ExecSimpleRelationUpdate(ResultRelInfo *resultRelInfo,
 	Assert(rel->rd_rel->relkind == RELKIND_RELATION);
 
 	CheckCmdReplicaIdentity(rel, CMD_UPDATE);
+	AdjCacheRelationModified(rel);
 
 	/* BEFORE ROW UPDATE Triggers */
 	if (resultRelInfo->ri_TrigDesc &&
@@ -540,6 +543,7 @@ ExecSimpleRelationDelete(ResultRelInfo *resultRelInfo,
 	ItemPointer tid = &searchslot->tts_tid;
 
 	CheckCmdReplicaIdentity(rel, CMD_DELETE);
+	AdjCacheRelationModified(rel);
 
 	/* BEFORE ROW DELETE Triggers */
 	if (resultRelInfo->ri_TrigDesc &&
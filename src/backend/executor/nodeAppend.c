@@ -64,6 +64,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/latch.h"
+#include "utils/graph.h"
 
 /* Shared state for parallel-aware Append. */
 struct ParallelAppendState
@@ -93,6 +94,7 @@ static bool ExecAppendAsyncGetNext(AppendState *node, TupleTableSlot **result);
 static bool ExecAppendAsyncRequest(AppendState *node, TupleTableSlot **result);
 static void ExecAppendAsyncEventWait(AppendState *node);
 static void classify_matching_subplans(AppendState *node);
+static Bitmapset *find_graph_label_subplans(AppendState *node);
 
 /* ----------------------------------------------------------------
  *		ExecInitAppend
@@ -183,6 +185,34 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 		appendstate->as_valid_subplans = validsubplans =
 			bms_add_range(NULL, 0, nplans - 1);
 		appendstate->as_prune_state = NULL;
+
+		/*
+		 * The children of a graph label are chosen by the label of the id
+		 * they are scanned by.  An id that does not change between scans,
+		 * such as a parameter of a generic plan, chooses them once here, and
+		 * the others are not initialized at all.  Otherwise they are chosen
+		 * at each scan.
+		 */
+		if (node->graph_id_expr != NULL && !node->plan.parallel_aware &&
+			node->nasyncplans == 0)
+		{
+			ExecAssignExprContext(estate, &appendstate->ps);
+			appendstate->as_graph_id_expr =
+				ExecInitExpr(node->graph_id_expr, &appendstate->ps);
+
+			if (node->graph_id_exec)
+			{
+				appendstate->as_valid_subplans = NULL;
+			}
+			else
+			{
+				validsubplans = find_graph_label_subplans(appendstate);
+				nplans = bms_num_members(validsubplans);
+				appendstate->as_valid_subplans =
+					(nplans > 0 ? bms_add_range(NULL, 0, nplans - 1) : NULL);
+				appendstate->as_graph_id_expr = NULL;
+			}
+		}
 	}
 
 	/*
@@ -435,6 +465,13 @@ ExecReScanAppend(AppendState *node)
 		}
 	}
 
+	/* The id that chooses the child of a graph label may have changed. */
+	if (node->as_graph_id_expr != NULL)
+	{
+		bms_free(node->as_valid_subplans);
+		node->as_valid_subplans = NULL;
+	}
+
 	for (i = 0; i < node->as_nplans; i++)
 	{
 		PlanState  *subnode = node->appendplans[i];
@@ -588,6 +625,11 @@ choose_next_subplan_locally(AppendState *node)
 			/* We'd have filled as_valid_subplans already */
 			Assert(node->as_valid_subplans);
 		}
+		else if (node->as_graph_id_expr != NULL)
+		{
+			if (node->as_valid_subplans == NULL)
+				node->as_valid_subplans = find_graph_label_subplans(node);
+		}
 		else if (node->as_valid_subplans == NULL)
 			node->as_valid_subplans =
 				ExecFindMatchingSubPlans(node->as_prune_state);
@@ -1184,3 +1226,39 @@ classify_matching_subplans(AppendState *node)
 	/* Save valid async subplans. */
 	node->as_valid_asyncplans = valid_asyncplans;
 }
+
+/* ----------------------------------------------------------------
+ *		find_graph_label_subplans
+ *
+ *		Returns the subplans that scan the label of the graphid
+ *		as_graph_id_expr evaluates to.  There is at most one, unless
+ *		a label is scanned more than once.
+ * ----------------------------------------------------------------
+ */
+static Bitmapset *
+find_graph_label_subplans(AppendState *node)
+{
+	Append	   *plan = (Append *) node->ps.plan;
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	Datum		id;
+	bool		isnull;
+	Labid		labid;
+	Bitmapset  *result = NULL;
+	ListCell   *lc;
+	int			i = 0;
+
+	ResetExprContext(econtext);
+	id = ExecEvalExprSwitchContext(node->as_graph_id_expr, econtext, &isnull);
+	if (isnull)
+		return NULL;
+
+	labid = GraphidGetLabid(DatumGetGraphid(id));
+	foreach(lc, plan->graph_labids)
+	{
+		if (lfirst_int(lc) == labid)
+			result = bms_add_member(result, i);
+		i++;
+	}
+
+	return result;
+}
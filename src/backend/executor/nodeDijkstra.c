@@ -16,6 +16,12 @@
  *		ExecDijkstra	 	- execute dijkstra's algorithm
  *		ExecInitDijkstra 	- initialize
  *		ExecEndDijkstra 	- shut down
+ *
+ * NOTES
+ *		With LIMIT, the paths that are as short as the shortest one are
+ *		returned. With ALL LIMIT, paths are returned one at a time in order of
+ *		their weight until the limit is reached, whether or not they are as
+ *		short as the first one. See exec_dijkstra_topk().
  */
 
 #include "postgres.h"
@@ -120,11 +126,18 @@ vnode_next_path(vnode *vertex)
 	return false;
 }
 
+typedef struct dijkstra_estimate
+{
+	Graphid		id;				/* hash key */
+	double		estimate;
+} dijkstra_estimate;
+
 typedef struct dijkstra_pq_entry
 {
 	pairingheap_node ph_node;
 	Graphid		to;
-	double		weight;
+	double		weight;			/* priority; dist plus the A* estimate */
+	double		dist;			/* weight of the path from the source */
 } dijkstra_pq_entry;
 
 static int
@@ -134,7 +147,19 @@ pq_cmp(const pairingheap_node *a, const pairingheap_node *b, void *arg)
 	dijkstra_pq_entry *y = (dijkstra_pq_entry *) b;
 
 	if (y->weight == x->weight)
-		return 0;
+	{
+		/*
+		 * With an A* estimate, the vertexes on every shortest path to the
+		 * target have the same priority as the target. Visit the closer ones
+		 * first so that the target is reached through all of them.
+		 */
+		if (y->dist == x->dist)
+			return 0;
+		else if (y->dist > x->dist)
+			return 1;
+		else
+			return -1;
+	}
 	else if (y->weight > x->weight)
 		return 1;
 	else
@@ -142,7 +167,8 @@ pq_cmp(const pairingheap_node *a, const pairingheap_node *b, void *arg)
 }
 
 static dijkstra_pq_entry *
-pq_add(pairingheap *pq, MemoryContext pq_mcxt, Graphid to, double weight)
+pq_add(pairingheap *pq, MemoryContext pq_mcxt, Graphid to, double dist,
+	   double estimate)
 {
 	dijkstra_pq_entry *n;
 
@@ -151,7 +177,8 @@ pq_add(pairingheap *pq, MemoryContext pq_mcxt, Graphid to, double weight)
 	n = (dijkstra_pq_entry *) MemoryContextAlloc(pq_mcxt,
 												 sizeof(dijkstra_pq_entry));
 	n->to = to;
-	n->weight = weight;
+	n->weight = dist + estimate;
+	n->dist = dist;
 	pairingheap_add(pq, &n->ph_node);
 	return n;
 }
@@ -207,45 +234,15 @@ eval_array(List *elems, ExprContext *econtext)
 }
 
 static TupleTableSlot *
-proj_path(DijkstraState *node)
+store_path(DijkstraState *node, List *vertexes, List *edges, double weight)
 {
-	Dijkstra   *plan;
+	Dijkstra   *plan = (Dijkstra *) node->ps.plan;
 	ProjectionInfo *projInfo;
 	ExprContext *econtext;
-	vnode	   *end;
-	vnode	   *vertex;
-	enode	   *edge;
-	bool		found;
-	double		weight;
-	List	   *vertexes = NIL;
-	List	   *edges = NIL;
-	ListCell   *null_edge;
 	TupleTableSlot *slot;
 	Datum	   *tts_values;
 	bool	   *tts_isnull;
 
-	plan = (Dijkstra *) node->ps.plan;
-
-	vertex = end = (vnode *) hash_search(node->visited_nodes, &node->target_id,
-										 HASH_FIND, &found);
-	Assert(found);
-
-	weight = vertex->weight;
-	while (vertex != NULL)
-	{
-		vertexes = lcons(&vertex->id, vertexes);
-		edge = vnode_get_curr_enode(vertex);
-		edges = lcons(&edge->id, edges);
-		vertex = edge->prev;
-	}
-
-	node->n++;
-	if (vnode_next_path((end)))
-		node->n = node->max_n;	/* no more path */
-
-	null_edge = list_nth_cell(edges, 0);
-	edges = list_delete_cell(edges, null_edge);
-
 	projInfo = node->ps.ps_ProjInfo;
 	slot = projInfo->pi_state.resultslot;
 	econtext = projInfo->pi_exprContext;
@@ -273,6 +270,41 @@ proj_path(DijkstraState *node)
 	return ExecStoreVirtualTuple(slot);
 }
 
+static TupleTableSlot *
+proj_path(DijkstraState *node)
+{
+	vnode	   *end;
+	vnode	   *vertex;
+	enode	   *edge;
+	bool		found;
+	double		weight;
+	List	   *vertexes = NIL;
+	List	   *edges = NIL;
+	ListCell   *null_edge;
+
+	vertex = end = (vnode *) hash_search(node->visited_nodes, &node->target_id,
+										 HASH_FIND, &found);
+	Assert(found);
+
+	weight = vertex->weight;
+	while (vertex != NULL)
+	{
+		vertexes = lcons(&vertex->id, vertexes);
+		edge = vnode_get_curr_enode(vertex);
+		edges = lcons(&edge->id, edges);
+		vertex = edge->prev;
+	}
+
+	node->n++;
+	if (vnode_next_path((end)))
+		node->n = node->max_n;	/* no more path */
+
+	null_edge = list_nth_cell(edges, 0);
+	edges = list_delete_cell(edges, null_edge);
+
+	return store_path(node, vertexes, edges, weight);
+}
+
 static void
 compute_limit(DijkstraState *node)
 {
@@ -334,6 +366,488 @@ replace_vertexRow_graphid(TupleDesc tupleDesc, HeapTuple vertexRow,
 	return vertexRow;
 }
 
+/*
+ * Rescan the subplan for the edges out of the given vertex. The parameter is
+ * also used in the parent plan, so the caller must restore it from
+ * *orig_param once it is done with the subplan.
+ */
+static ParamExecData *
+rescan_edges(DijkstraState *node, Graphid vid, Datum *orig_param)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	int			paramno;
+	ParamExecData *prm;
+
+	if (IsA(node->source->expr, FieldSelect))
+		paramno = ((Param *) ((FieldSelect *) node->source->expr)->arg)->paramid;
+	else
+		paramno = ((Param *) node->source->expr)->paramid;
+
+	prm = &(econtext->ecxt_param_exec_vals[paramno]);
+	*orig_param = prm->value;
+
+	if (IsA(node->source->expr, FieldSelect))
+	{
+		HeapTuple	vertexRow;
+
+		vertexRow = replace_vertexRow_graphid(node->tupleDesc,
+											  node->vertexRow, vid);
+		prm->value = HeapTupleGetDatum(vertexRow);
+	}
+	else
+		prm->value = UInt64GetDatum(vid);
+
+	outerPlan->chgParam = bms_add_member(outerPlan->chgParam, paramno);
+	ExecReScan(outerPlan);
+
+	return prm;
+}
+
+/* read an edge returned by the subplan */
+static void
+get_edge(DijkstraState *node, TupleTableSlot *slot, Graphid *to,
+		 Graphid *eid, double *weight, double *estimate)
+{
+	Dijkstra   *dijkstra = (Dijkstra *) node->ps.plan;
+	Datum		datum;
+	bool		is_null;
+
+	datum = slot_getattr(slot, dijkstra->end_id, &is_null);
+	*to = DatumGetGraphid(datum);
+
+	datum = slot_getattr(slot, dijkstra->edge_id, &is_null);
+	*eid = DatumGetGraphid(datum);
+
+	datum = slot_getattr(slot, dijkstra->weight, &is_null);
+	*weight = DatumGetFloat8(datum);
+	if (*weight < 0.0)
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("WEIGHT must be larger than 0")));
+
+	/*
+	 * In A* mode, vertices are visited in the order of the weight so far plus
+	 * the estimated remaining weight to the target. The estimate must not
+	 * exceed the actual weight; NULL or a negative value means no estimate.
+	 * It depends only on the vertex at the other side of the edge, so it is
+	 * evaluated for the first edge to each vertex only.
+	 */
+	*estimate = 0.0;
+	if (node->heuristic != NULL)
+	{
+		dijkstra_estimate *entry;
+		bool		found;
+
+		entry = hash_search(node->estimates, to, HASH_ENTER, &found);
+		if (!found)
+		{
+			ExprContext *econtext = node->ps.ps_ExprContext;
+
+			econtext->ecxt_outertuple = slot;
+			datum = ExecEvalExprSwitchContext(node->heuristic, econtext,
+											  &is_null);
+			entry->estimate = (is_null ? 0.0 : Max(DatumGetFloat8(datum), 0.0));
+		}
+		*estimate = entry->estimate;
+	}
+}
+
+/*
+ * k shortest loopless paths
+ *
+ * This is Yen's algorithm. Every path after the first one is the shortest
+ * of the candidates made by taking a prefix (the root) of a path returned
+ * before and searching for the rest of the path (the spur) from its last
+ * vertex, without the vertexes of the root and without the edges that the
+ * paths returned so far take out of it. Following Lawler, only the vertexes
+ * of the last returned path from the one it deviated from its parent at are
+ * used as spur vertexes; the others were already tried for the parent.
+ *
+ * The next path is computed only when it is fetched, and the edges out of
+ * each vertex are read from the subplan once and kept in ksp_adjacency, so
+ * the spur searches do not rescan the subplan.
+ */
+
+typedef struct ksp_edge
+{
+	Graphid		to;
+	Graphid		eid;
+	double		weight;
+	double		estimate;
+} ksp_edge;
+
+typedef struct ksp_adj
+{
+	Graphid		id;				/* hash key */
+	int			nedges;
+	ksp_edge   *edges;
+} ksp_adj;
+
+typedef struct ksp_path
+{
+	pairingheap_node ph_node;
+	double		weight;
+	int			deviation;		/* index of the spur vertex */
+	int			nvertexes;
+	Graphid    *vertexes;
+	Graphid    *edges;			/* nvertexes - 1 edges */
+	double	   *dists;			/* weight up to each vertex */
+} ksp_path;
+
+/* a vertex reached by a spur search */
+typedef struct ksp_vnode
+{
+	Graphid		id;				/* hash key */
+	bool		blocked;		/* in the root path */
+	double		dist;
+	struct ksp_vnode *prev;
+	Graphid		prev_eid;
+} ksp_vnode;
+
+static int
+ksp_cmp(const pairingheap_node *a, const pairingheap_node *b, void *arg)
+{
+	const ksp_path *x = pairingheap_const_container(ksp_path, ph_node, a);
+	const ksp_path *y = pairingheap_const_container(ksp_path, ph_node, b);
+
+	if (x->weight < y->weight)
+		return 1;
+	if (x->weight > y->weight)
+		return -1;
+
+	/* prefer fewer hops among paths of the same weight */
+	if (x->nvertexes < y->nvertexes)
+		return 1;
+	if (x->nvertexes > y->nvertexes)
+		return -1;
+	return 0;
+}
+
+static ksp_adj *
+ksp_expand(DijkstraState *node, Graphid vid)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+	ksp_adj    *adj;
+	bool		found;
+	int			maxedges = 0;
+	Datum		orig_param;
+	ParamExecData *prm;
+
+	adj = hash_search(node->ksp_adjacency, &vid, HASH_ENTER, &found);
+	if (found)
+		return adj;
+
+	adj->nedges = 0;
+	adj->edges = NULL;
+
+	prm = rescan_edges(node, vid, &orig_param);
+	for (;;)
+	{
+		TupleTableSlot *slot;
+		ksp_edge   *edge;
+
+		slot = ExecProcNode(outerPlan);
+		if (TupIsNull(slot))
+			break;
+
+		if (adj->nedges >= maxedges)
+		{
+			if (maxedges == 0)
+			{
+				maxedges = 8;
+				adj->edges = MemoryContextAlloc(node->ksp_mcxt,
+												sizeof(ksp_edge) * maxedges);
+			}
+			else
+			{
+				maxedges *= 2;
+				adj->edges = repalloc(adj->edges,
+									  sizeof(ksp_edge) * maxedges);
+			}
+		}
+
+		edge = &adj->edges[adj->nedges++];
+		get_edge(node, slot, &edge->to, &edge->eid, &edge->weight,
+				 &edge->estimate);
+	}
+	prm->value = orig_param;
+
+	return adj;
+}
+
+/*
+ * Find the shortest path from the spur vertex to the target that does not
+ * go through the first spur_idx vertexes of root, nor through the banned
+ * edges out of the spur vertex. The path found is appended to that part of
+ * root. If root is NULL, spur_id is the source.
+ */
+static ksp_path *
+ksp_search(DijkstraState *node, Graphid spur_id, ksp_path *root, int spur_idx,
+		   Graphid *banned, int nbanned)
+{
+	MemoryContext search_mcxt;
+	MemoryContext oldContext;
+	HASHCTL		hash_ctl;
+	HTAB	   *vnodes;
+	pairingheap *pq;
+	ksp_vnode  *spur;
+	ksp_vnode  *end = NULL;
+	ksp_path   *path = NULL;
+	double		spur_dist;
+	int			i;
+
+	search_mcxt = AllocSetContextCreate(node->ksp_mcxt,
+										"dijkstra's spur search",
+										ALLOCSET_DEFAULT_SIZES);
+
+	hash_ctl.keysize = sizeof(Graphid);
+	hash_ctl.entrysize = sizeof(ksp_vnode);
+	hash_ctl.hcxt = search_mcxt;
+	vnodes = hash_create("dijkstra's spur search vertexes", 1024, &hash_ctl,
+						 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	oldContext = MemoryContextSwitchTo(search_mcxt);
+	pq = pairingheap_allocate(pq_cmp, NULL);
+	MemoryContextSwitchTo(oldContext);
+
+	for (i = 0; i < spur_idx; i++)
+	{
+		ksp_vnode  *vertex;
+
+		vertex = hash_search(vnodes, &root->vertexes[i], HASH_ENTER, NULL);
+		vertex->blocked = true;
+	}
+
+	spur_dist = (root == NULL ? 0.0 : root->dists[spur_idx]);
+	spur = hash_search(vnodes, &spur_id, HASH_ENTER, NULL);
+	spur->blocked = false;
+	spur->dist = spur_dist;
+	spur->prev = NULL;
+	spur->prev_eid = 0;
+	pq_add(pq, search_mcxt, spur_id, spur_dist, 0.0);
+
+	while (!pairingheap_is_empty(pq))
+	{
+		dijkstra_pq_entry *min_pq_entry;
+		ksp_vnode  *frontier;
+		ksp_adj    *adj;
+
+		min_pq_entry = (dijkstra_pq_entry *) pairingheap_remove_first(pq);
+		frontier = hash_search(vnodes, &min_pq_entry->to, HASH_FIND, NULL);
+		Assert(frontier != NULL);
+
+		if (min_pq_entry->dist > frontier->dist)
+			continue;
+
+		if (frontier->id == node->target_id)
+		{
+			end = frontier;
+			break;
+		}
+
+		adj = ksp_expand(node, frontier->id);
+		for (i = 0; i < adj->nedges; i++)
+		{
+			ksp_edge   *edge = &adj->edges[i];
+			ksp_vnode  *neighbor;
+			double		new_dist;
+			bool		found;
+
+			if (frontier == spur)
+			{
+				int			j;
+
+				for (j = 0; j < nbanned; j++)
+				{
+					if (banned[j] == edge->eid)
+						break;
+				}
+				if (j < nbanned)
+					continue;
+			}
+
+			new_dist = frontier->dist + edge->weight;
+
+			neighbor = hash_search(vnodes, &edge->to, HASH_ENTER, &found);
+			if (found && (neighbor->blocked || new_dist >= neighbor->dist))
+				continue;
+
+			neighbor->blocked = false;
+			neighbor->dist = new_dist;
+			neighbor->prev = frontier;
+			neighbor->prev_eid = edge->eid;
+			pq_add(pq, search_mcxt, edge->to, new_dist, edge->estimate);
+		}
+	}
+
+	if (end != NULL)
+	{
+		ksp_vnode  *vertex;
+		int			nvertexes = spur_idx + 1;
+
+		for (vertex = end; vertex != spur; vertex = vertex->prev)
+			nvertexes++;
+
+		path = MemoryContextAlloc(node->ksp_mcxt, sizeof(ksp_path));
+		path->weight = end->dist;
+		path->deviation = spur_idx;
+		path->nvertexes = nvertexes;
+		path->vertexes = MemoryContextAlloc(node->ksp_mcxt,
+											sizeof(Graphid) * nvertexes);
+		path->edges = MemoryContextAlloc(node->ksp_mcxt,
+										 sizeof(Graphid) * nvertexes);
+		path->dists = MemoryContextAlloc(node->ksp_mcxt,
+										 sizeof(double) * nvertexes);
+
+		for (i = 0; i < spur_idx; i++)
+		{
+			path->vertexes[i] = root->vertexes[i];
+			path->edges[i] = root->edges[i];
+			path->dists[i] = root->dists[i];
+		}
+
+		i = nvertexes - 1;
+		for (vertex = end; vertex != NULL; vertex = vertex->prev)
+		{
+			path->vertexes[i] = vertex->id;
+			path->dists[i] = vertex->dist;
+			if (vertex->prev != NULL)
+				path->edges[i - 1] = vertex->prev_eid;
+			i--;
+		}
+		Assert(i == spur_idx - 1);
+	}
+
+	MemoryContextDelete(search_mcxt);
+
+	return path;
+}
+
+static bool
+ksp_path_equal(ksp_path *a, ksp_path *b)
+{
+	return a->nvertexes == b->nvertexes &&
+		memcmp(a->vertexes, b->vertexes, sizeof(Graphid) * a->nvertexes) == 0 &&
+		memcmp(a->edges, b->edges, sizeof(Graphid) * (a->nvertexes - 1)) == 0;
+}
+
+static ksp_path *
+ksp_next_path(DijkstraState *node)
+{
+	ksp_path   *last = llast(node->ksp_paths);
+	Graphid    *banned;
+	int			i;
+
+	banned = palloc(sizeof(Graphid) * list_length(node->ksp_paths));
+
+	for (i = last->deviation; i < last->nvertexes - 1; i++)
+	{
+		ksp_path   *candidate;
+		ListCell   *lc;
+		int			nbanned = 0;
+
+		/* ban the edges out of the spur vertex of the paths with this root */
+		foreach(lc, node->ksp_paths)
+		{
+			ksp_path   *path = lfirst(lc);
+
+			if (path->nvertexes > i + 1 &&
+				memcmp(path->vertexes, last->vertexes,
+					   sizeof(Graphid) * (i + 1)) == 0 &&
+				memcmp(path->edges, last->edges, sizeof(Graphid) * i) == 0)
+				banned[nbanned++] = path->edges[i];
+		}
+
+		candidate = ksp_search(node, last->vertexes[i], last, i,
+							   banned, nbanned);
+		if (candidate != NULL)
+			pairingheap_add(node->ksp_candidates, &candidate->ph_node);
+	}
+
+	pfree(banned);
+
+	/* the same candidate can be made from different paths */
+	while (!pairingheap_is_empty(node->ksp_candidates))
+	{
+		ksp_path   *candidate;
+		ListCell   *lc;
+
+		candidate = pairingheap_container(ksp_path, ph_node,
+										  pairingheap_remove_first(node->ksp_candidates));
+		foreach(lc, node->ksp_paths)
+		{
+			if (ksp_path_equal(candidate, lfirst(lc)))
+				break;
+		}
+		if (lc == NULL)
+			return candidate;
+	}
+
+	return NULL;
+}
+
+static TupleTableSlot *
+exec_dijkstra_topk(DijkstraState *node)
+{
+	ksp_path   *path;
+	MemoryContext oldContext;
+	List	   *vertexes = NIL;
+	List	   *edges = NIL;
+	int			i;
+
+	if (!node->is_executed)
+	{
+		ExprContext *econtext = node->ps.ps_ExprContext;
+		HASHCTL		hash_ctl;
+		Datum		start_vid;
+		Datum		end_vid;
+		bool		is_null;
+
+		node->is_executed = true;
+
+		compute_limit(node);
+
+		start_vid = ExecEvalExpr(node->source, econtext, &is_null);
+		end_vid = ExecEvalExpr(node->target, econtext, &is_null);
+		node->target_id = DatumGetGraphid(end_vid);
+
+		hash_ctl.keysize = sizeof(Graphid);
+		hash_ctl.entrysize = sizeof(ksp_adj);
+		hash_ctl.hcxt = node->ksp_mcxt;
+		node->ksp_adjacency = hash_create("dijkstra's adjacency lists",
+										  1024, &hash_ctl,
+										  HASH_ELEM | HASH_BLOBS |
+										  HASH_CONTEXT);
+		oldContext = MemoryContextSwitchTo(node->ksp_mcxt);
+		node->ksp_candidates = pairingheap_allocate(ksp_cmp, NULL);
+		MemoryContextSwitchTo(oldContext);
+
+		path = ksp_search(node, DatumGetGraphid(start_vid), NULL, 0, NULL, 0);
+	}
+	else if (node->n < node->max_n)
+		path = ksp_next_path(node);
+	else
+		return NULL;
+
+	if (path == NULL)
+	{
+		node->n = node->max_n;	/* no more path */
+		return NULL;
+	}
+
+	node->n++;
+	oldContext = MemoryContextSwitchTo(node->ksp_mcxt);
+	node->ksp_paths = lappend(node->ksp_paths, path);
+	MemoryContextSwitchTo(oldContext);
+
+	for (i = 0; i < path->nvertexes; i++)
+		vertexes = lappend(vertexes, &path->vertexes[i]);
+	for (i = 0; i < path->nvertexes - 1; i++)
+		edges = lappend(edges, &path->edges[i]);
+
+	return store_path(node, vertexes, edges, path->weight);
+}
+
 static TupleTableSlot *
 ExecDijkstra(PlanState *pstate)
 {
@@ -358,6 +872,9 @@ ExecDijkstra(PlanState *pstate)
 	 */
 	ResetExprContext(econtext);
 
+	if (dijkstra->topk)
+		return exec_dijkstra_topk(node);
+
 	if (node->is_executed)
 	{
 		if (node->n < node->max_n)
@@ -372,7 +889,7 @@ ExecDijkstra(PlanState *pstate)
 
 	start_vid = ExecEvalExpr(node->source, econtext, &is_null);
 	start_node = pq_add(node->pq, node->pq_mcxt, DatumGetGraphid(start_vid),
-						0.0);
+						0.0, 0.0);
 
 	end_vid = ExecEvalExpr(node->target, econtext, &is_null);
 	node->target_id = DatumGetGraphid(end_vid);
@@ -387,7 +904,6 @@ ExecDijkstra(PlanState *pstate)
 		bool		found;
 		dijkstra_pq_entry *min_pq_entry;
 		vnode	   *frontier;
-		int			paramno;
 		Datum		orig_param;
 		ParamExecData *prm;
 
@@ -399,58 +915,36 @@ ExecDijkstra(PlanState *pstate)
 										 &min_pq_entry->to, HASH_FIND, &found);
 		Assert(found);
 
-		if (IsA(node->source->expr, FieldSelect))
-			paramno = ((Param *) ((FieldSelect *) node->source->expr)->arg)->paramid;
-		else
-			paramno = ((Param *) node->source->expr)->paramid;
-
-		prm = &(econtext->ecxt_param_exec_vals[paramno]);
-		orig_param = prm->value;
-
-		if (IsA(node->source->expr, FieldSelect))
+		/*
+		 * A shorter path to the vertex has been found after this entry was
+		 * queued. The vertex is expanded through the entry of that path, so
+		 * skip this one instead of rescanning its edges again.
+		 */
+		if (min_pq_entry->dist > frontier->weight)
 		{
-			HeapTuple	vertexRow;
-
-			vertexRow = replace_vertexRow_graphid(node->tupleDesc,
-												  node->vertexRow,
-												  min_pq_entry->to);
-			prm->value = HeapTupleGetDatum(vertexRow);
+			pfree(min_pq_entry);
+			continue;
 		}
-		else
-			prm->value = UInt64GetDatum(min_pq_entry->to);
 
-		outerPlan->chgParam = bms_add_member(outerPlan->chgParam, paramno);
-		ExecReScan(outerPlan);
+		prm = rescan_edges(node, min_pq_entry->to, &orig_param);
 
 		pfree(min_pq_entry);
 
 		for (;;)
 		{
-			Datum		to;
-			Datum		eid;
-			Datum		weight;
 			Graphid		to_val;
 			Graphid		eid_val;
 			double		weight_val;
 			double		new_weight;
+			double		estimate_val;
 			vnode	   *neighbor;
 
 			outerTupleSlot = ExecProcNode(outerPlan);
 			if (TupIsNull(outerTupleSlot))
 				break;
 
-			to = slot_getattr(outerTupleSlot, dijkstra->end_id, &is_null);
-			to_val = DatumGetGraphid(to);
-
-			eid = slot_getattr(outerTupleSlot, dijkstra->edge_id, &is_null);
-			eid_val = DatumGetGraphid(eid);
-
-			weight = slot_getattr(outerTupleSlot, dijkstra->weight, &is_null);
-			weight_val = DatumGetFloat8(weight);
-			if (weight_val < 0.0)
-				ereport(ERROR,
-						(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
-						 errmsg("WEIGHT must be larger than 0")));
+			get_edge(node, outerTupleSlot, &to_val, &eid_val, &weight_val,
+					 &estimate_val);
 
 			new_weight = frontier->weight + weight_val;
 
@@ -459,14 +953,16 @@ ExecDijkstra(PlanState *pstate)
 
 			if (!found)
 			{
-				pq_add(node->pq, node->pq_mcxt, to_val, new_weight);
+				pq_add(node->pq, node->pq_mcxt, to_val, new_weight,
+					   estimate_val);
 
 				neighbor->incoming_enodes = NIL;
 				vnode_add_enode(neighbor, new_weight, eid_val, frontier);
 			}
 			else if (new_weight < neighbor->weight)
 			{
-				pq_add(node->pq, node->pq_mcxt, to_val, new_weight);
+				pq_add(node->pq, node->pq_mcxt, to_val, new_weight,
+					   estimate_val);
 
 				vnode_update_enode(neighbor, new_weight, eid_val, frontier);
 			}
@@ -523,10 +1019,32 @@ ExecInitDijkstra(Dijkstra *node, EState *estate, int eflags)
 	dstate->visited_nodes = hash_create("dijkstra's visited nodes",
 										1024, &hash_ctl,
 										HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	if (node->topk)
+		dstate->ksp_mcxt = AllocSetContextCreate(CurrentMemoryContext,
+												 "dijkstra's k shortest paths",
+												 ALLOCSET_DEFAULT_SIZES);
+	else
+		dstate->ksp_mcxt = NULL;
+	dstate->ksp_adjacency = NULL;
+	dstate->ksp_paths = NIL;
+	dstate->ksp_candidates = NULL;
 
 	dstate->source = ExecInitExpr((Expr *) node->source, (PlanState *) dstate);
 	dstate->target = ExecInitExpr((Expr *) node->target, (PlanState *) dstate);
 	dstate->limit = ExecInitExpr((Expr *) node->limit, (PlanState *) dstate);
+	dstate->heuristic = ExecInitExpr((Expr *) node->heuristic,
+									 (PlanState *) dstate);
+	if (node->heuristic != NULL)
+	{
+		hash_ctl.keysize = sizeof(Graphid);
+		hash_ctl.entrysize = sizeof(dijkstra_estimate);
+		hash_ctl.hcxt = CurrentMemoryContext;
+		dstate->estimates = hash_create("dijkstra's estimates", 1024,
+										&hash_ctl,
+										HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+	else
+		dstate->estimates = NULL;
 
 	/*
 	 * initialize child nodes
@@ -631,5 +1149,24 @@ ExecReScanDijkstra(DijkstraState *node)
 	MemoryContextReset(node->pq_mcxt);
 	pairingheap_reset(node->pq);
 
+	/* the estimates are of the remaining weight to the previous target */
+	if (node->estimates != NULL)
+	{
+		hash_destroy(node->estimates);
+		hash_ctl.keysize = sizeof(Graphid);
+		hash_ctl.entrysize = sizeof(dijkstra_estimate);
+		hash_ctl.hcxt = node->ps.state->es_query_cxt;
+		node->estimates = hash_create("dijkstra's estimates", 1024, &hash_ctl,
+									  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	if (node->ksp_mcxt != NULL)
+	{
+		MemoryContextReset(node->ksp_mcxt);
+		node->ksp_adjacency = NULL;
+		node->ksp_paths = NIL;
+		node->ksp_candidates = NULL;
+	}
+
 	ExecClearTuple(node->selfTupleSlot);
 }
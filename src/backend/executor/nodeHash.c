@@ -367,6 +367,7 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->ps.ExecProcNode = ExecHash;
 	hashstate->hashtable = NULL;
 	hashstate->hashkeys = NIL;	/* will be set by parent HashJoin */
+	hashstate->single_batch = false;	/* ditto */
 
 	/*
 	 * Miscellaneous initialization
@@ -468,6 +469,15 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 							&space_allowed,
 							&nbuckets, &nbatch, &num_skew_mcvs);
 
+	/*
+	 * A join that cannot process batches keeps the whole relation in one,
+	 * exceeding hash_mem if the relation turns out larger than the planner
+	 * expected or hash_mem was lowered after planning.  The buckets are
+	 * enlarged to fit the tuples as they are loaded.
+	 */
+	if (state->single_batch)
+		nbatch = 1;
+
 	/* nbuckets must be a power of 2 */
 	log2_nbuckets = my_log2(nbuckets);
 	Assert(nbuckets == (1 << log2_nbuckets));
@@ -496,7 +506,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 	hashtable->curbatch = 0;
 	hashtable->nbatch_original = nbatch;
 	hashtable->nbatch_outstart = nbatch;
-	hashtable->growEnabled = true;
+	hashtable->growEnabled = !state->single_batch;
 	hashtable->totalTuples = 0;
 	hashtable->partialTuples = 0;
 	hashtable->skewTuples = 0;
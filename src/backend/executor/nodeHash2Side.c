@@ -210,6 +210,9 @@ ExecInitHash2Side(Hash2Side *node, EState *estate, int eflags)
 	hashstate->totalPaths = 0;
 	hashstate->hops = 0;
 	hashstate->spacePeak = 0;
+	hashstate->preds = NULL;	/* will be set by parent Shortestpath */
+	hashstate->npreds = 0;
+	hashstate->maxpreds = 0;
 
 	/*
 	 * Miscellaneous initialization
@@ -279,7 +282,7 @@ ExecEndHash2Side(Hash2SideState *node)
  */
 HashJoinTable
 ExecHash2SideTableCreate(Hash2SideState *node, List *hashOperators,
-						 double ntuples, double npaths, long hops, Size spacePeak)
+						 double ntuples, double npaths, Size spacePeak)
 {
 	HashJoinTable hashtable;
 	Plan	   *outerNode;
@@ -298,7 +301,7 @@ ExecHash2SideTableCreate(Hash2SideState *node, List *hashOperators,
 	 */
 	outerNode = outerPlan(node->ps.plan);
 
-	ExecChooseHash2SideTableSize(ntuples, node->totalPaths, outerNode->plan_width, hops,
+	ExecChooseHash2SideTableSize(ntuples, node->totalPaths, outerNode->plan_width,
 								 &nbuckets, &nbatch);
 
 	/* nbuckets must be a power of 2 */
@@ -553,7 +556,6 @@ void
 ExecChooseHash2SideTableSize(double ntuples,
 							 double npaths,
 							 int tupwidth,
-							 long hops,
 							 int *numbuckets,
 							 int *numbatches)
 {
@@ -582,9 +584,10 @@ ExecChooseHash2SideTableSize(double ntuples,
 		MAXALIGN(SizeofMinimalTupleHeader) +
 		MAXALIGN(tupwidth);
 	inner_rel_bytes = (ntuples - npaths) * tupsize;
+	/* a path tuple carries the index of its predecessor on top of that */
 	tupsize = HJTUPLE_OVERHEAD +
 		MAXALIGN(SizeofMinimalTupleHeader) +
-		MAXALIGN(tupwidth * hops + sizeof(Graphid));
+		MAXALIGN(tupwidth + sizeof(int64));
 	inner_rel_bytes += npaths * tupsize;
 
 	/*
@@ -146,6 +146,7 @@ static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
 static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
 static bool ExecParallelHashJoinNewBatch(HashJoinState *hjstate);
 static void ExecParallelHashJoinPartitionOuter(HashJoinState *node);
+static void ExecHashJoinDestroyHashTable(HashJoinState *node);
 
 
 /* ----------------------------------------------------------------
@@ -344,6 +345,19 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 
 			case HJ_NEED_NEW_OUTER:
 
+				/*
+				 * Cypher MERGE has modified the inner relation, so the next
+				 * outer tuple has to be probed against a new hash table.
+				 */
+				if (unlikely(node->hj_RebuildHashTable))
+				{
+					Assert(!parallel);
+					ExecHashJoinDestroyHashTable(node);
+					hashtable = NULL;
+					node->hj_RebuildHashTable = false;
+					continue;
+				}
+
 				/*
 				 * We don't have an outer tuple, try to get the next one
 				 */
@@ -690,6 +704,7 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 			break;
 		case JOIN_LEFT:
 		case JOIN_ANTI:
+		case JOIN_CYPHER_MERGE:
 			hjstate->hj_NullInnerTupleSlot =
 				ExecInitNullTupleSlot(estate, innerDesc, &TTSOpsVirtual);
 			break;
@@ -720,6 +735,15 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 		TupleTableSlot *slot = hashstate->ps.ps_ResultTupleSlot;
 
 		hjstate->hj_HashTupleSlot = slot;
+
+		/*
+		 * Cypher MERGE rebuilds the hash table instead of rescanning the
+		 * outer relation, which only works with a single batch.  The planner
+		 * only chooses a hash join for it if the inner relation is expected
+		 * to fit in one, but a cached plan can run with less hash_mem than
+		 * it was made for, so the batch is never split at run time either.
+		 */
+		hashstate->single_batch = (node->join.jointype == JOIN_CYPHER_MERGE);
 	}
 
 	/*
@@ -751,6 +775,7 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_JoinState = HJ_BUILD_HASHTABLE;
 	hjstate->hj_MatchedOuter = false;
 	hjstate->hj_OuterNotEmpty = false;
+	hjstate->hj_RebuildHashTable = false;
 
 	return hjstate;
 }
@@ -1287,6 +1312,40 @@ ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
 }
 
 
+/*
+ * ExecHashJoinDestroyHashTable
+ *		Destroys the hash table, so that it is built again by the next
+ *		ExecHashJoin.
+ */
+static void
+ExecHashJoinDestroyHashTable(HashJoinState *node)
+{
+	HashState  *hashNode = castNode(HashState, innerPlanState(node));
+
+	Assert(hashNode->hashtable == node->hj_HashTable);
+	/* accumulate stats from old hash table, if wanted */
+	/* (this should match ExecShutdownHash) */
+	if (hashNode->ps.instrument && !hashNode->hinstrument)
+		hashNode->hinstrument = (HashInstrumentation *)
+			palloc0(sizeof(HashInstrumentation));
+	if (hashNode->hinstrument)
+		ExecHashAccumInstrumentation(hashNode->hinstrument,
+									 hashNode->hashtable);
+	/* for safety, be sure to clear child plan node's pointer too */
+	hashNode->hashtable = NULL;
+
+	ExecHashTableDestroy(node->hj_HashTable);
+	node->hj_HashTable = NULL;
+	node->hj_JoinState = HJ_BUILD_HASHTABLE;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (node->js.ps.righttree->chgParam == NULL)
+		ExecReScan(node->js.ps.righttree);
+}
+
 void
 ExecReScanHashJoin(HashJoinState *node)
 {
@@ -1328,33 +1387,12 @@ ExecReScanHashJoin(HashJoinState *node)
 		else
 		{
 			/* must destroy and rebuild hash table */
-			HashState  *hashNode = castNode(HashState, innerPlanState(node));
-
-			Assert(hashNode->hashtable == node->hj_HashTable);
-			/* accumulate stats from old hash table, if wanted */
-			/* (this should match ExecShutdownHash) */
-			if (hashNode->ps.instrument && !hashNode->hinstrument)
-				hashNode->hinstrument = (HashInstrumentation *)
-					palloc0(sizeof(HashInstrumentation));
-			if (hashNode->hinstrument)
-				ExecHashAccumInstrumentation(hashNode->hinstrument,
-											 hashNode->hashtable);
-			/* for safety, be sure to clear child plan node's pointer too */
-			hashNode->hashtable = NULL;
-
-			ExecHashTableDestroy(node->hj_HashTable);
-			node->hj_HashTable = NULL;
-			node->hj_JoinState = HJ_BUILD_HASHTABLE;
-
-			/*
-			 * if chgParam of subnode is not null then plan will be re-scanned
-			 * by first ExecProcNode.
-			 */
-			if (node->js.ps.righttree->chgParam == NULL)
-				ExecReScan(node->js.ps.righttree);
+			ExecHashJoinDestroyHashTable(node);
 		}
 	}
 
+	node->hj_RebuildHashTable = false;
+
 	/* Always reset intra-tuple state */
 	node->hj_CurHashValue = 0;
 	node->hj_CurBucketNo = 0;
@@ -1372,6 +1410,25 @@ ExecReScanHashJoin(HashJoinState *node)
 		ExecReScan(node->js.ps.lefttree);
 }
 
+/*
+ * ExecHashJoinInvalidateInner
+ *		Tells the join that the inner relation has been modified.
+ *
+ * Cypher MERGE creates its pattern, or sets properties of it, in the middle
+ * of the join, and the following outer tuples must see those changes as a
+ * rescanned inner relation would.  The hash table is rebuilt before the next
+ * outer tuple is probed; the rest of the current outer tuple's matches are
+ * still returned from the old one, as a nested loop would do.
+ */
+void
+ExecHashJoinInvalidateInner(HashJoinState *node)
+{
+	Assert(node->js.jointype == JOIN_CYPHER_MERGE);
+
+	if (node->hj_HashTable != NULL)
+		node->hj_RebuildHashTable = true;
+}
+
 void
 ExecShutdownHashJoin(HashJoinState *node)
 {
@@ -10,19 +10,25 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
 #include "access/htup_details.h"
+#include "access/tableam.h"
 #include "access/xact.h"
 #include "catalog/ag_graph_fn.h"
 #include "catalog/pg_type.h"
+#include "common/hashfn.h"
 #include "executor/executor.h"
 #include "executor/nodeModifyGraph.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "parser/parse_relation.h"
 #include "pgstat.h"
+#include "storage/buffile.h"
+#include "utils/adjcache.h"
 #include "utils/arrayaccess.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "access/heapam.h"
 #include "executor/execCypherCreate.h"
@@ -49,6 +55,264 @@ static void reflectModifiedProp(ModifyGraphState *mgstate);
 static bool isEdgeArrayOfPath(List *exprs, char *variable);
 
 static void openResultRelInfosIndices(ModifyGraphState *mgstate);
+static Relation findEdgeIndex(ResultRelInfo *resultRelInfo, AttrNumber attnum);
+
+/*
+ * Modified element table
+ *
+ * Keeps the graph elements modified by a ModifyGraph, keyed by graphid, so
+ * that the rows returned by an eager ModifyGraph and the later SETs of the
+ * same statement see their newest values. DELETE only records the graphids.
+ *
+ * The entries are kept in a compact open-addressing hash table. The elements
+ * are kept in memory up to work_mem, and the ones stored after that are
+ * written to a temporary file, so that a large MATCH ... SET does not have to
+ * keep a copy of every element it modified in memory.
+ *
+ * An element stored again goes to the slot of the file it was written to
+ * before, if it fits there. Otherwise it gets a new slot at the end of the
+ * file, at least twice as large as the old one, and the old slot is left
+ * unused. So the slots of an element take at most about four times the size
+ * of its largest version, however often it is stored.
+ */
+typedef struct ModifiedElemEntry
+{
+	Graphid		key;			/* hash key */
+	Datum		elem;			/* the element in memory, or 0 */
+	off_t		offset;			/* slot of the element in the file */
+	int			fileno;			/* file number of the slot */
+	Size		slotlen;		/* size of the slot, or 0 if there is none */
+	bool		spilled;		/* is the element in the slot? */
+	char		status;			/* hash status */
+} ModifiedElemEntry;
+
+#define SH_PREFIX		elemtab
+#define SH_ELEMENT_TYPE	ModifiedElemEntry
+#define SH_KEY_TYPE		Graphid
+#define SH_KEY			key
+#define SH_HASH_KEY(tb, key)	murmurhash32((uint32) ((key) ^ ((key) >> 32)))
+#define SH_EQUAL(tb, a, b)		((a) == (b))
+#define SH_SCOPE		static inline
+#define SH_DEFINE
+#define SH_DECLARE
+#include "lib/simplehash.h"
+
+struct ModifiedElemTable
+{
+	MemoryContext cxt;			/* for the entries and elements in memory */
+	elemtab_hash *hash;
+	Size		mem_used;		/* size of the elements in memory */
+	Size		mem_allowed;
+	BufFile    *file;			/* spilled elements, or NULL */
+	int			end_fileno;		/* where to add the next slot */
+	off_t		end_offset;
+};
+
+ModifiedElemTable *
+createModifiedElemTable(void)
+{
+	ModifiedElemTable *table;
+	MemoryContext cxt;
+
+	cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"modified element table",
+								ALLOCSET_DEFAULT_SIZES);
+
+	table = MemoryContextAlloc(cxt, sizeof(*table));
+	table->cxt = cxt;
+	table->hash = elemtab_create(cxt, 128, NULL);
+	table->mem_used = 0;
+	table->mem_allowed = work_mem * 1024L;
+	table->file = NULL;
+	table->end_fileno = 0;
+	table->end_offset = 0;
+
+	return table;
+}
+
+void
+destroyModifiedElemTable(ModifiedElemTable *table)
+{
+	if (table->file != NULL)
+		BufFileClose(table->file);
+
+	MemoryContextDelete(table->cxt);
+}
+
+uint64
+countModifiedElems(ModifiedElemTable *table)
+{
+	return table->hash->members;
+}
+
+static void
+releaseModifiedElem(ModifiedElemTable *table, ModifiedElemEntry *entry)
+{
+	entry->spilled = false;
+
+	if (entry->elem == (Datum) 0)
+		return;
+
+	table->mem_used -= VARSIZE_ANY(DatumGetPointer(entry->elem));
+	pfree(DatumGetPointer(entry->elem));
+	entry->elem = (Datum) 0;
+}
+
+static void
+seekModifiedElem(ModifiedElemTable *table, int fileno, off_t offset)
+{
+	if (BufFileSeek(table->file, fileno, offset, SEEK_SET) != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not seek in modified element table temporary file")));
+}
+
+static void
+spillModifiedElem(ModifiedElemTable *table, ModifiedElemEntry *entry,
+				  Datum elem)
+{
+	Size		len = VARSIZE_ANY(DatumGetPointer(elem));
+
+	if (len > entry->slotlen)
+	{
+		Size		slotlen = Max(len, entry->slotlen * 2);
+
+		if (table->file == NULL)
+		{
+			MemoryContext oldmctx = MemoryContextSwitchTo(table->cxt);
+
+			table->file = BufFileCreateTemp(false);
+
+			MemoryContextSwitchTo(oldmctx);
+		}
+		else
+		{
+			seekModifiedElem(table, table->end_fileno, table->end_offset);
+		}
+
+		entry->offset = table->end_offset;
+		entry->fileno = table->end_fileno;
+		entry->slotlen = slotlen;
+
+		/* write the whole slot so that the next one starts after it */
+		BufFileWrite(table->file, &len, sizeof(len));
+		BufFileWrite(table->file, DatumGetPointer(elem), len);
+		if (slotlen > len)
+		{
+			char	   *padding = palloc0(slotlen - len);
+
+			BufFileWrite(table->file, padding, slotlen - len);
+			pfree(padding);
+		}
+
+		BufFileTell(table->file, &table->end_fileno, &table->end_offset);
+	}
+	else
+	{
+		seekModifiedElem(table, entry->fileno, entry->offset);
+
+		BufFileWrite(table->file, &len, sizeof(len));
+		BufFileWrite(table->file, DatumGetPointer(elem), len);
+	}
+
+	entry->spilled = true;
+}
+
+static Datum
+readModifiedElem(ModifiedElemTable *table, ModifiedElemEntry *entry)
+{
+	Size		len;
+	char	   *elem;
+
+	if (!entry->spilled)
+		return entry->elem;
+
+	seekModifiedElem(table, entry->fileno, entry->offset);
+
+	if (BufFileRead(table->file, &len, sizeof(len)) != sizeof(len))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from modified element table temporary file")));
+
+	elem = palloc(len);
+	if (BufFileRead(table->file, elem, len) != len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from modified element table temporary file")));
+
+	return PointerGetDatum(elem);
+}
+
+/*
+ * lookupModifiedElem
+ *
+ * Returns whether the element of the given graphid has been modified. If
+ * elem is not NULL, it is set to the modified element, or to 0 if there is
+ * none. An element read back from the temporary file is palloc'd in the
+ * current memory context; otherwise it is valid until it is stored again.
+ */
+bool
+lookupModifiedElem(ModifiedElemTable *table, Graphid gid, Datum *elem)
+{
+	ModifiedElemEntry *entry;
+
+	entry = elemtab_lookup(table->hash, gid);
+	if (entry == NULL)
+		return false;
+
+	if (elem != NULL)
+		*elem = readModifiedElem(table, entry);
+
+	return true;
+}
+
+/*
+ * storeModifiedElem
+ *
+ * Stores a copy of the modified element of the given graphid, which may be 0
+ * if there is no element to keep, replacing the previous one. Returns whether
+ * the element had been stored already.
+ */
+bool
+storeModifiedElem(ModifiedElemTable *table, Graphid gid, Datum elem)
+{
+	ModifiedElemEntry *entry;
+	bool		found;
+
+	entry = elemtab_insert(table->hash, gid, &found);
+	if (found)
+	{
+		releaseModifiedElem(table, entry);
+	}
+	else
+	{
+		entry->elem = (Datum) 0;
+		entry->offset = 0;
+		entry->fileno = 0;
+		entry->slotlen = 0;
+		entry->spilled = false;
+	}
+
+	if (elem != (Datum) 0)
+	{
+		Size		len = VARSIZE_ANY(DatumGetPointer(elem));
+
+		/* an element that has a slot already keeps using it if it fits */
+		if (len > entry->slotlen &&
+			table->mem_used + len <= table->mem_allowed)
+		{
+			entry->elem = PointerGetDatum(MemoryContextAlloc(table->cxt, len));
+			memcpy(DatumGetPointer(entry->elem), DatumGetPointer(elem), len);
+			table->mem_used += len;
+		}
+		else
+		{
+			spillModifiedElem(table, entry, elem);
+		}
+	}
+
+	return found;
+}
 
 ModifyGraphState *
 ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
@@ -88,7 +352,8 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 
 	mgstate->subplan = ExecInitNode(mgplan->subplan, estate, eflags);
 	AssertArg(mgplan->operation != GWROP_MERGE ||
-			  IsA(mgstate->subplan, NestLoopState));
+			  IsA(mgstate->subplan, NestLoopState) ||
+			  IsA(mgstate->subplan, HashJoinState));
 
 	mgstate->graphid = get_graph_path_oid();
 	mgstate->pattern = ExecInitGraphPattern(mgplan->pattern, mgstate);
@@ -112,6 +377,9 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 	/* For Set Operation. */
 	mgstate->sets = ExecInitGraphSets(mgplan->sets, mgstate);
 	mgstate->update_cols = NULL;
+	mgstate->setLabels = NULL;
+	mgstate->numSetLabels = 0;
+	mgstate->lastSetLabel = NULL;
 
 	/* Initialize for EPQ. */
 	EvalPlanQualInit(&mgstate->mt_epqstate, estate, NULL, NIL,
@@ -125,29 +393,24 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 		(mgstate->sets != NIL && enable_multiple_update) ||
 		mgstate->exprs != NIL)
 	{
-		HASHCTL		ctl;
-
-		memset(&ctl, 0, sizeof(ctl));
-		ctl.keysize = sizeof(Graphid);
-		ctl.entrysize = sizeof(ModifiedElemEntry);
-		ctl.hcxt = CurrentMemoryContext;
-
-		mgstate->elemTable =
-			hash_create("modified object table", 128, &ctl,
-						HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+		mgstate->elemTable = createModifiedElemTable();
 	}
 	else
 	{
 		/* We will not use eager action */
 		mgstate->elemTable = NULL;
 	}
+	mgstate->num_elem_cols = 0;
+	mgstate->elem_cols = NULL;
 	mgstate->tuplestorestate = tuplestore_begin_heap(false, false, eager_mem);
 
 	mgstate->delete_graph_state = NULL;
+	mgstate->create_graph_state = NULL;
 
 	switch (mgplan->operation)
 	{
 		case GWROP_CREATE:
+			ExecInitCreateGraph(mgstate);
 			mgstate->execProc = ExecCreateGraph;
 			break;
 		case GWROP_DELETE:
@@ -158,6 +421,12 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 																			estate->es_snapshot, mgstate->graphid);
 				int			num_edge_labels = list_length(edge_label_oids);
 
+				deleteGraphState->start_index_rels = NULL;
+				deleteGraphState->end_index_rels = NULL;
+				deleteGraphState->start_index_scans = NULL;
+				deleteGraphState->end_index_scans = NULL;
+				deleteGraphState->edge_slot = NULL;
+
 				if (num_edge_labels > 0)
 				{
 					ResultRelInfo *edge_label_resultRelInfos =
@@ -166,6 +435,16 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 					ResultRelInfo *resultRelInfoForDel =
 					edge_label_resultRelInfos;
 					ListCell   *lc;
+					int			i = 0;
+
+					deleteGraphState->start_index_rels =
+						palloc0(num_edge_labels * sizeof(Relation));
+					deleteGraphState->end_index_rels =
+						palloc0(num_edge_labels * sizeof(Relation));
+					deleteGraphState->start_index_scans =
+						palloc0(num_edge_labels * sizeof(IndexScanDesc));
+					deleteGraphState->end_index_scans =
+						palloc0(num_edge_labels * sizeof(IndexScanDesc));
 
 					foreach(lc, edge_label_oids)
 					{
@@ -178,7 +457,25 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 										  NULL,
 										  0);
 						ExecOpenIndices(resultRelInfoForDel, false);
+						AdjCacheRelationModified(relation);
+
+						deleteGraphState->start_index_rels[i] =
+							findEdgeIndex(resultRelInfoForDel,
+										  Anum_table_edge_start);
+						deleteGraphState->end_index_rels[i] =
+							findEdgeIndex(resultRelInfoForDel,
+										  Anum_table_edge_end);
+
+						if (deleteGraphState->edge_slot == NULL &&
+							(deleteGraphState->start_index_rels[i] != NULL ||
+							 deleteGraphState->end_index_rels[i] != NULL))
+							deleteGraphState->edge_slot =
+								ExecInitExtraTupleSlot(estate,
+													   RelationGetDescr(relation),
+													   table_slot_callbacks(relation));
+
 						resultRelInfoForDel++;
+						i++;
 					}
 
 					deleteGraphState->edge_labels = edge_label_resultRelInfos;
@@ -190,6 +487,17 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 				deleteGraphState->num_edge_labels = num_edge_labels;
 				list_free(edge_label_oids);
 
+				/*
+				 * Connected edges can be removed after all the vertices are
+				 * deleted only if no tuple is returned to the parent plan
+				 * until the subplan is done.
+				 */
+				deleteGraphState->bulk = (mgplan->detach &&
+										  (mgplan->last || mgstate->eagerness));
+				deleteGraphState->pending_vertex_ids = NULL;
+				deleteGraphState->num_pending_vertex_ids = 0;
+				deleteGraphState->max_pending_vertex_ids = 0;
+
 				deleteGraphState->cached_values =
 					palloc0(sizeof(Datum) * Anum_table_edge_prop_map);
 				deleteGraphState->cached_isnull =
@@ -213,82 +521,96 @@ ExecInitModifyGraph(ModifyGraph *mgplan, EState *estate, int eflags)
 	return mgstate;
 }
 
+/*
+ * Finds the output columns whose values may have to be replaced with the
+ * modified elements, i.e. the vertices, the edges, and the graphpaths.
+ */
+static void
+findElemColumns(ModifyGraphState *mgstate, TupleDesc tupDesc)
+{
+	int			i;
+
+	mgstate->elem_cols = palloc(tupDesc->natts * sizeof(AttrNumber));
+	mgstate->num_elem_cols = 0;
+
+	for (i = 0; i < tupDesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupDesc, i);
+
+		if (attr->atttypid == GRAPHPATHOID)
+		{
+			/*
+			 * When deleting the graphpath, edge array of graphpath is deleted
+			 * first and vertex array is deleted in the next plan. So, the
+			 * graphpath must be passed to the next plan for deleting vertex
+			 * array of the graphpath.
+			 */
+			if (isEdgeArrayOfPath(mgstate->exprs, NameStr(attr->attname)))
+				continue;
+		}
+		else if (attr->atttypid != VERTEXOID && attr->atttypid != EDGEOID)
+		{
+			/*
+			 * The edges of an edge array are used only for removal, not for
+			 * result output.
+			 *
+			 * This assumes that there are only variable references in the
+			 * target list.
+			 */
+			continue;
+		}
+
+		mgstate->elem_cols[mgstate->num_elem_cols++] = attr->attnum;
+	}
+}
+
 static void
 reflectTupleChanges(PlanState *pstate, TupleTableSlot *result)
 {
 	ModifyGraphState *mgstate = castNode(ModifyGraphState, pstate);
-	ModifyGraph *plan = (ModifyGraph *) mgstate->ps.plan;
 	TupleDesc	tupDesc = result->tts_tupleDescriptor;
-	int			natts = tupDesc->natts;
 	int			i;
 
-	for (i = 0; i < natts; i++)
+	if (mgstate->elem_cols == NULL)
+		findElemColumns(mgstate, tupDesc);
+
+	for (i = 0; i < mgstate->num_elem_cols; i++)
 	{
+		AttrNumber	attnum = mgstate->elem_cols[i];
 		Oid			type;
 		Datum		orig_elem;
 		Datum		elem;
+		bool		found;
 
-		if (result->tts_isnull[i])
+		if (result->tts_isnull[attnum - 1])
 			continue;
 
-		orig_elem = result->tts_values[i];
-		type = TupleDescAttr(tupDesc, i)->atttypid;
+		orig_elem = result->tts_values[attnum - 1];
+		type = TupleDescAttr(tupDesc, attnum - 1)->atttypid;
 		if (type == VERTEXOID)
 		{
-			Datum		graphid;
-			bool		found;
-
-			graphid = getVertexIdDatum(orig_elem);
-			elem = getElementFromEleTable(mgstate, type, orig_elem, graphid,
-										  &found);
+			elem = getElementFromEleTable(mgstate, type, orig_elem,
+										  getVertexIdDatum(orig_elem), &found);
 			if (!found)
-			{
 				continue;
-			}
 		}
 		else if (type == EDGEOID)
 		{
-			Datum		graphid;
-			bool		found;
-
-			graphid = getEdgeIdDatum(orig_elem);
-			elem = getElementFromEleTable(mgstate, type, orig_elem, graphid,
-										  &found);
+			elem = getElementFromEleTable(mgstate, type, orig_elem,
+										  getEdgeIdDatum(orig_elem), &found);
 			if (!found)
-			{
 				continue;
-			}
 		}
-		else if (type == GRAPHPATHOID)
+		else
 		{
-			/*
-			 * When deleting the graphpath, edge array of graphpath is deleted
-			 * first and vertex array is deleted in the next plan. So, the
-			 * graphpath must be passed to the next plan for deleting vertex
-			 * array of the graphpath.
-			 */
-			if (isEdgeArrayOfPath(mgstate->exprs,
-								  NameStr(TupleDescAttr(tupDesc, i)->attname)))
-				continue;
+			Assert(type == GRAPHPATHOID);
 
 			elem = getPathFinal(mgstate, orig_elem);
-		}
-		else if (type == EDGEARRAYOID && plan->operation == GWROP_DELETE)
-		{
-			/*
-			 * The edges are used only for removal, not for result output.
-			 *
-			 * This assumes that there are only variable references in the
-			 * target list.
-			 */
-			continue;
-		}
-		else
-		{
-			continue;
+			if (elem == orig_elem)
+				continue;
 		}
 
-		setSlotValueByAttnum(result, elem, i + 1);
+		setSlotValueByAttnum(result, elem, attnum);
 	}
 }
 
@@ -354,6 +676,11 @@ ExecModifyGraph(PlanState *pstate)
 
 		mgstate->child_done = true;
 
+		if (plan->operation == GWROP_CREATE)
+			ExecFlushCreateGraph(mgstate);
+		else if (plan->operation == GWROP_DELETE)
+			ExecFlushDeleteGraph(mgstate);
+
 		if (mgstate->elemTable != NULL
 			&& plan->operation != GWROP_DELETE
 			&& plan->operation != GWROP_SET)
@@ -363,6 +690,7 @@ ExecModifyGraph(PlanState *pstate)
 	if (mgstate->eagerness)
 	{
 		TupleTableSlot *result;
+		MemoryContext oldmctx;
 
 		/* don't care about scan direction */
 		result = mgstate->ps.ps_ResultTupleSlot;
@@ -374,11 +702,17 @@ ExecModifyGraph(PlanState *pstate)
 		slot_getallattrs(result);
 
 		if (mgstate->elemTable == NULL ||
-			hash_get_num_entries(mgstate->elemTable) < 1)
+			countModifiedElems(mgstate->elemTable) < 1)
 			return result;
 
+		/* the modified elements of the previous row are not needed anymore */
+		ResetExprContext(mgstate->ps.ps_ExprContext);
+		oldmctx = MemoryContextSwitchTo(mgstate->ps.ps_ExprContext->ecxt_per_tuple_memory);
+
 		reflectTupleChanges(pstate, result);
 
+		MemoryContextSwitchTo(oldmctx);
+
 		return result;
 	}
 
@@ -392,6 +726,9 @@ ExecEndModifyGraph(ModifyGraphState *mgstate)
 {
 	CommandId	used_cid;
 
+	if (mgstate->create_graph_state != NULL)
+		ExecEndCreateGraph(mgstate);
+
 	if (mgstate->delete_graph_state != NULL)
 	{
 		DeleteGraphState *delete_graph_state = mgstate->delete_graph_state;
@@ -403,12 +740,23 @@ ExecEndModifyGraph(ModifyGraphState *mgstate)
 
 			for (i = 0; i < delete_graph_state->num_edge_labels; i++)
 			{
+				if (delete_graph_state->start_index_scans[i] != NULL)
+					index_endscan(delete_graph_state->start_index_scans[i]);
+				if (delete_graph_state->end_index_scans[i] != NULL)
+					index_endscan(delete_graph_state->end_index_scans[i]);
+
 				ExecCloseIndices(resultRelInfo);
 				table_close(resultRelInfo->ri_RelationDesc, RowExclusiveLock);
 				resultRelInfo++;
 			}
 			pfree(delete_graph_state->edge_labels);
+			pfree(delete_graph_state->start_index_rels);
+			pfree(delete_graph_state->end_index_rels);
+			pfree(delete_graph_state->start_index_scans);
+			pfree(delete_graph_state->end_index_scans);
 		}
+		if (delete_graph_state->pending_vertex_ids != NULL)
+			pfree(delete_graph_state->pending_vertex_ids);
 		pfree(delete_graph_state->cached_values);
 		pfree(delete_graph_state->cached_isnull);
 		pfree(delete_graph_state);
@@ -422,7 +770,7 @@ ExecEndModifyGraph(ModifyGraphState *mgstate)
 	tuplestore_end(mgstate->tuplestorestate);
 
 	if (mgstate->elemTable != NULL)
-		hash_destroy(mgstate->elemTable);
+		destroyModifiedElemTable(mgstate->elemTable);
 
 	/*
 	 * clean out the tuple table
@@ -549,15 +897,16 @@ getElementFromEleTable(ModifyGraphState *mgstate, Oid type_oid, Datum orig_elem,
 					   Datum gid, bool *found)
 {
 	ModifyGraph *plan = (ModifyGraph *) mgstate->ps.plan;
-	ModifiedElemEntry *entry;
+	Datum		elem;
 
-	entry = hash_search(mgstate->elemTable, &gid, HASH_FIND, found);
+	*found = lookupModifiedElem(mgstate->elemTable, DatumGetGraphid(gid),
+								&elem);
 
 	/* Unmodified or deleted */
 	if (!(*found) || plan->operation == GWROP_DELETE)
 		return (Datum) 0;
 	else
-		return entry->elem;
+		return elem;
 }
 
 Datum
@@ -686,22 +1035,33 @@ getPathFinal(ModifyGraphState *mgstate, Datum origin)
 static void
 reflectModifiedProp(ModifyGraphState *mgstate)
 {
-	HASH_SEQ_STATUS seq;
+	ModifiedElemTable *table = mgstate->elemTable;
+	elemtab_iterator iter;
 	ModifiedElemEntry *entry;
+	MemoryContext tmpcxt;
+	MemoryContext oldmctx;
+
+	Assert(table != NULL);
 
-	Assert(mgstate->elemTable != NULL);
+	tmpcxt = AllocSetContextCreate(CurrentMemoryContext,
+								   "reflect modified properties",
+								   ALLOCSET_DEFAULT_SIZES);
+	oldmctx = MemoryContextSwitchTo(tmpcxt);
 
-	hash_seq_init(&seq, mgstate->elemTable);
-	while ((entry = hash_seq_search(&seq)) != NULL)
+	elemtab_start_iterate(table->hash, &iter);
+	while ((entry = elemtab_iterate(table->hash, &iter)) != NULL)
 	{
 		ItemPointer ctid;
-		Datum		gid = PointerGetDatum(entry->key);
+		Datum		gid = GraphidGetDatum(entry->key);
+		Datum		elem;
 		Oid			type;
 
+		elem = readModifiedElem(table, entry);
+
 		type = get_labid_typeoid(mgstate->graphid,
 								 GraphidGetLabid(DatumGetGraphid(gid)));
 
-		ctid = LegacyUpdateElemProp(mgstate, type, gid, entry->elem);
+		ctid = LegacyUpdateElemProp(mgstate, type, gid, elem);
 
 		if (mgstate->eagerness)
 		{
@@ -709,19 +1069,24 @@ reflectModifiedProp(ModifyGraphState *mgstate)
 			Datum		newelem;
 
 			if (type == VERTEXOID)
-				property = getVertexPropDatum(entry->elem);
+				property = getVertexPropDatum(elem);
 			else if (type == EDGEOID)
-				property = getEdgePropDatum(entry->elem);
+				property = getEdgePropDatum(elem);
 			else
 				elog(ERROR, "unexpected graph type %d", type);
 
-			newelem = makeModifiedElem(entry->elem, type, gid, property,
+			newelem = makeModifiedElem(elem, type, gid, property,
 									   PointerGetDatum(ctid));
 
-			pfree(DatumGetPointer(entry->elem));
-			entry->elem = newelem;
+			/* only replaces the element of the current entry */
+			storeModifiedElem(table, entry->key, newelem);
 		}
+
+		MemoryContextReset(tmpcxt);
 	}
+
+	MemoryContextSwitchTo(oldmctx);
+	MemoryContextDelete(tmpcxt);
 }
 
 ResultRelInfo *
@@ -860,6 +1225,33 @@ openResultRelInfosIndices(ModifyGraphState *mgstate)
 	for (index = 0; index < mgstate->numResultRelInfo; index++)
 	{
 		ExecOpenIndices(resultRelInfo, false);
+		AdjCacheRelationModified(resultRelInfo->ri_RelationDesc);
 		resultRelInfo++;
 	}
 }
+
+/*
+ * findEdgeIndex
+ * Return the opened btree index of the edge label whose leading key is
+ * `attnum`, or NULL if there is none.
+ */
+static Relation
+findEdgeIndex(ResultRelInfo *resultRelInfo, AttrNumber attnum)
+{
+	Oid			index_oid;
+	int			i;
+
+	index_oid = get_label_btree_index(resultRelInfo->ri_RelationDesc, attnum);
+	if (!OidIsValid(index_oid))
+		return NULL;
+
+	for (i = 0; i < resultRelInfo->ri_NumIndices; i++)
+	{
+		Relation	index_rel = resultRelInfo->ri_IndexRelationDescs[i];
+
+		if (RelationGetRelid(index_rel) == index_oid)
+			return index_rel;
+	}
+
+	return NULL;
+}
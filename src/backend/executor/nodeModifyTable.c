@@ -48,6 +48,7 @@
 #include "rewrite/rewriteHandler.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
+#include "utils/adjcache.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/memutils.h"
@@ -2809,6 +2810,8 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 		 */
 		CheckValidResultRel(resultRelInfo, operation);
 
+		AdjCacheRelationModified(resultRelInfo->ri_RelationDesc);
+
 		resultRelInfo++;
 		i++;
 	}
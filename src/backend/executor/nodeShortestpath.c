@@ -43,6 +43,30 @@
 #define SP_SCAN_BUCKET			5
 #define SP_NEED_NEW_BATCH       6
 
+/*
+ * A path tuple holds the graphid of the last vertex of the path, the rowid of
+ * the edge to it, and the index of its entry in the predecessor array of the
+ * side that owns the tuple. The entry holds the same graphid and rowid along
+ * with the index of the entry of the previous vertex on the path, or -1 if
+ * the previous vertex is the start (or end) vertex of the side. Paths are
+ * rebuilt from these entries when the two sides meet, so the size of a tuple
+ * does not grow with the number of hops.
+ */
+typedef struct SpPred
+{
+	int64		parent;
+	Graphid		vid;
+	/* rowid follows */
+} SpPred;
+
+#define SP_PRED_SIZE(spstate) \
+	MAXALIGN(sizeof(SpPred) + (spstate)->sp_RowidSize)
+#define SP_PRED(node, spstate, idx) \
+	((SpPred *) ((node)->preds + (idx) * SP_PRED_SIZE(spstate)))
+#define SP_PRED_ROWID(pred) ((unsigned char *) ((pred) + 1))
+
+#define SP_INITIAL_PREDS		1024
+
 static TupleTableSlot *ExecShortestpathOuterGetTuple(ShortestpathState *spstate,
 													 uint32 *hashvalue);
 static TupleTableSlot *ExecShortestpathProcOuterNode(PlanState *node,
@@ -50,17 +74,20 @@ static TupleTableSlot *ExecShortestpathProcOuterNode(PlanState *node,
 static bool ExecShortestpathRescanOuterNode(Hash2SideState *node,
 											ShortestpathState *spstate);
 static bool ExecShortestpathNewBatch(ShortestpathState *spstate);
+static int64 ExecShortestpathAddPred(Hash2SideState *node,
+									 ShortestpathState *spstate,
+									 MinimalTuple tuple);
+static int64 ExecShortestpathGetPred(ShortestpathState *spstate,
+									 MinimalTuple tuple);
 static Datum ExecShortestpathProjectEvalArray(Oid element_typeid,
 											  const unsigned char *elems,
 											  long len,
 											  ExprContext *econtext);
 static TupleTableSlot *ExecShortestpathProject(ShortestpathState *node,
-											   unsigned char *outerids,
+											   MinimalTuple outerTuple,
 											   long lenOuterids,
-											   unsigned char *innerids,
-											   long lenInnerids,
-											   int sizeGraphid,
-											   int sizeRowid);
+											   MinimalTuple innerTuple,
+											   long lenInnerids);
 static HeapTuple replace_vertexRow_graphid(TupleDesc tupleDesc,
 										   HeapTuple vertexRow,
 										   Datum graphid);
@@ -130,6 +157,8 @@ ExecShortestpath(PlanState *pstate)
 
 				outerNode->hops = 0;
 				innerNode->hops = 0;
+				outerNode->npreds = 0;
+				innerNode->npreds = 0;
 
 				if (node->startVid == 0)
 					node->startVid = DatumGetGraphid(ExecEvalExpr(node->source, econtext, &isNull));
@@ -142,7 +171,6 @@ ExecShortestpath(PlanState *pstate)
 													 node->sp_HashOperators,
 													 1,
 													 1,
-													 outerNode->hops,
 													 outerNode->spacePeak);
 				hashvalue = hash_any((unsigned char *) &(node->startVid), sizeof(Graphid));
 				ExecHash2SideTableInsertGraphid(hashtable,
@@ -159,7 +187,6 @@ ExecShortestpath(PlanState *pstate)
 													 node->sp_HashOperators,
 													 1,
 													 1,
-													 innerNode->hops,
 													 innerNode->spacePeak);
 				hashvalue = hash_any((unsigned char *) &(node->endVid), sizeof(Graphid));
 				ExecHash2SideTableInsertGraphid(hashtable,
@@ -178,13 +205,7 @@ ExecShortestpath(PlanState *pstate)
 				{
 					TupleTableSlot *result;
 
-					result = ExecShortestpathProject(node,
-													 (unsigned char *) (&(node->startVid)),
-													 0,
-													 (unsigned char *) (&(node->endVid)),
-													 0,
-													 sizeof(Graphid),
-													 node->sp_RowidSize);
+					result = ExecShortestpathProject(node, NULL, 0, NULL, 0);
 					node->numResults++;
 					return result;
 				}
@@ -200,20 +221,6 @@ ExecShortestpath(PlanState *pstate)
 				}
 
 				node->hops++;
-				if (node->hops >= node->sp_Hops)
-				{
-					node->sp_Hops *= 2;
-					node->sp_OuterTuple = (MinimalTuple) repalloc(node->sp_OuterTuple,
-																  HJTUPLE_OVERHEAD +
-																  MAXALIGN(SizeofMinimalTupleHeader) +
-																  MAXALIGN(outerNode->ps.plan->plan_width *
-																		   node->sp_Hops +
-																		   sizeof(Graphid)));
-					node->sp_Vertexids = (unsigned char *) repalloc(node->sp_Vertexids,
-																	sizeof(Graphid) * (node->sp_Hops + 1));
-					node->sp_Edgeids = (unsigned char *) repalloc(node->sp_Edgeids,
-																  node->sp_RowidSize * node->sp_Hops);
-				}
 
 				Assert(node->outerNode->hashtable != NULL &&
 					   node->innerNode->hashtable != NULL);
@@ -241,7 +248,6 @@ ExecShortestpath(PlanState *pstate)
 						ExecChooseHash2SideTableSize(innerNode->hashtable->totalTuples,
 													 innerNode->totalPaths,
 													 innerNode->ps.plan->plan_width,
-													 innerNode->hops,
 													 &nbuckets,
 													 &nbatch);
 						if (nbatch != innerNode->hashtable->nbatch ||
@@ -255,7 +261,6 @@ ExecShortestpath(PlanState *pstate)
 																 node->sp_HashOperators,
 																 innerNode->hashtable->totalTuples,
 																 innerNode->totalPaths,
-																 innerNode->hops,
 																 innerNode->spacePeak);
 							for (i = 0; i < innerNode->hashtable->nbatch; i++)
 							{
@@ -426,7 +431,6 @@ ExecShortestpath(PlanState *pstate)
 																	outerNode->ps.plan->plan_rows,
 																	outerNode->totalPaths *
 																	outerNode->ps.plan->plan_rows,
-																	outerNode->hops,
 																	outerNode->spacePeak);
 				}
 				node->sp_KeyTable = outerNode->keytable;
@@ -456,6 +460,7 @@ ExecShortestpath(PlanState *pstate)
 					bool		shouldFree;
 					MemoryContext oldContext;
 					ExprContext *econtext = node->js.ps.ps_ExprContext;
+					int64		pred;
 
 					econtext->ecxt_outertuple = outerTupleSlot;
 					oldContext = MemoryContextSwitchTo(outerTupleSlot->tts_mcxt);
@@ -473,6 +478,12 @@ ExecShortestpath(PlanState *pstate)
 						heap_free_minimal_tuple(outerTuple);
 					}
 
+					pred = ExecShortestpathAddPred(outerNode, node,
+												   node->sp_OuterTuple);
+					memcpy(((unsigned char *) (node->sp_OuterTuple + 1)) +
+						   sizeof(Graphid) + node->sp_RowidSize,
+						   &pred, sizeof(pred));
+
 					if (ExecHash2SideTableInsertTuple(outertable,
 													  node->sp_OuterTuple,
 													  hashvalue,
@@ -483,6 +494,11 @@ ExecShortestpath(PlanState *pstate)
 						outertable->totalTuples += 1;
 						outerNode->totalPaths += 1;
 					}
+					else
+					{
+						/* nothing refers to the entry */
+						outerNode->npreds--;
+					}
 
 					/*
 					 * That tuple couldn't match because of a NULL, so discard
@@ -591,12 +607,10 @@ ExecShortestpath(PlanState *pstate)
 							innerHops = outerNode->hops;
 						}
 						result = ExecShortestpathProject(node,
-														 (unsigned char *) (outerTuple + 1),
+														 outerTuple,
 														 outerHops,
-														 (unsigned char *) (innerTuple + 1),
-														 innerHops,
-														 sizeof(Graphid),
-														 node->sp_RowidSize);
+														 innerTuple,
+														 innerHops);
 
 						if (outerShouldFree)
 						{
@@ -801,17 +815,15 @@ ExecInitShortestpath(Shortestpath *node, EState *estate, int eflags)
 	/* child Hash2Side node needs to evaluate inner hash keys, too */
 	((Hash2SideState *) innerPlanState(spstate))->hashkeys = rclauses;
 
-	spstate->sp_Hops = (node->maxhops < 32) ? node->maxhops : 32;
 	spstate->sp_RowidSize = outerNode->plan_width - sizeof(Graphid);
 	spstate->sp_GraphidTuple = (MinimalTuple) palloc(HJTUPLE_OVERHEAD +
 													 MAXALIGN(SizeofMinimalTupleHeader) +
 													 MAXALIGN(outerNode->plan_width));
 	spstate->sp_OuterTuple = (MinimalTuple) palloc(HJTUPLE_OVERHEAD +
 												   MAXALIGN(SizeofMinimalTupleHeader) +
-												   MAXALIGN(outerNode->plan_width * spstate->sp_Hops +
-															sizeof(Graphid)));
-	spstate->sp_Vertexids = (unsigned char *) palloc(sizeof(Graphid) * (spstate->sp_Hops + 1));
-	spstate->sp_Edgeids = (unsigned char *) palloc(spstate->sp_RowidSize * spstate->sp_Hops);
+												   MAXALIGN(outerNode->plan_width +
+															sizeof(int64)));
+	spstate->sp_CurPred = -1;
 
 	memset(spstate->sp_GraphidTuple, 0, sizeof(*(spstate->sp_GraphidTuple)) + outerNode->plan_width);
 	spstate->sp_GraphidTuple->t_len = sizeof(*(spstate->sp_GraphidTuple)) + outerNode->plan_width;
@@ -826,6 +838,11 @@ ExecInitShortestpath(Shortestpath *node, EState *estate, int eflags)
 	outerH2SNode = spstate->outerNode;
 	innerH2SNode = spstate->innerNode;
 
+	outerH2SNode->maxpreds = SP_INITIAL_PREDS;
+	outerH2SNode->preds = palloc(SP_PRED_SIZE(spstate) * SP_INITIAL_PREDS);
+	innerH2SNode->maxpreds = SP_INITIAL_PREDS;
+	innerH2SNode->preds = palloc(SP_PRED_SIZE(spstate) * SP_INITIAL_PREDS);
+
 	/*
 	 * Shortestpath was originally written without expectations that the start
 	 * and end nodes might reside in FieldSelect expressions. This code is to
@@ -913,8 +930,8 @@ ExecEndShortestpath(ShortestpathState *node)
 
 	pfree(node->sp_GraphidTuple);
 	pfree(node->sp_OuterTuple);
-	pfree(node->sp_Vertexids);
-	pfree(node->sp_Edgeids);
+	pfree(node->outerNode->preds);
+	pfree(node->innerNode->preds);
 
 	/*
 	 * clean up subtrees
@@ -1085,11 +1102,9 @@ ExecShortestpathRescanOuterNode(Hash2SideState *node, ShortestpathState *spstate
 				}
 
 				memcpy(spstate->sp_OuterTuple, tuple, sizeof(*tuple));
-				memcpy(((unsigned char *) (spstate->sp_OuterTuple + 1)) +
-					   sizeof(Graphid) + spstate->sp_RowidSize,
-					   tuple + 1,
-					   tuple->t_len - sizeof(*tuple));
-				spstate->sp_OuterTuple->t_len += sizeof(Graphid) + spstate->sp_RowidSize;
+				spstate->sp_OuterTuple->t_len = sizeof(*tuple) + sizeof(Graphid) +
+					spstate->sp_RowidSize + sizeof(int64);
+				spstate->sp_CurPred = ExecShortestpathGetPred(spstate, tuple);
 				paramno = node->correctedParam->paramid;
 				prm = &(spstate->js.ps.ps_ExprContext->ecxt_param_exec_vals[paramno]);
 
@@ -1153,17 +1168,15 @@ ExecShortestpathRescanOuterNode(Hash2SideState *node, ShortestpathState *spstate
 				}
 
 				memcpy(spstate->sp_OuterTuple, tuple, sizeof(*tuple));
-				memcpy(((unsigned char *) (spstate->sp_OuterTuple + 1)) +
-					   sizeof(Graphid) + spstate->sp_RowidSize,
-					   tuple + 1,
-					   tuple->t_len - sizeof(*tuple));
+				spstate->sp_OuterTuple->t_len = sizeof(*tuple) + sizeof(Graphid) +
+					spstate->sp_RowidSize + sizeof(int64);
+				spstate->sp_CurPred = ExecShortestpathGetPred(spstate, tuple);
 
 				if (shouldFree)
 				{
 					heap_free_minimal_tuple(tuple);
 				}
 
-				spstate->sp_OuterTuple->t_len += sizeof(Graphid) + spstate->sp_RowidSize;
 				paramno = node->correctedParam->paramid;
 				prm = &(spstate->js.ps.ps_ExprContext->ecxt_param_exec_vals[paramno]);
 
@@ -1548,73 +1561,135 @@ ExecShortestpathProjectEvalArray(Oid element_typeid, const unsigned char *elems,
 	return PointerGetDatum(result);
 }
 
+/*
+ * ExecShortestpathAddPred
+ *		add an entry for the path tuple to the predecessor array of the side
+ *
+ * The entry refers to spstate->sp_CurPred, the entry of the path tuple being
+ * expanded. Returns the index of the new entry.
+ */
+static int64
+ExecShortestpathAddPred(Hash2SideState *node, ShortestpathState *spstate,
+						MinimalTuple tuple)
+{
+	SpPred	   *pred;
+
+	if (node->npreds >= node->maxpreds)
+	{
+		node->maxpreds *= 2;
+		node->preds = repalloc_huge(node->preds,
+									SP_PRED_SIZE(spstate) * node->maxpreds);
+	}
+
+	pred = SP_PRED(node, spstate, node->npreds);
+	pred->parent = spstate->sp_CurPred;
+	memcpy(&pred->vid, tuple + 1, sizeof(Graphid));
+	memcpy(SP_PRED_ROWID(pred),
+		   ((unsigned char *) (tuple + 1)) + sizeof(Graphid),
+		   spstate->sp_RowidSize);
+
+	return node->npreds++;
+}
+
+/*
+ * ExecShortestpathGetPred
+ *		get the index of the predecessor entry of the path tuple
+ *
+ * Returns -1 for the start (or end) vertex itself.
+ */
+static int64
+ExecShortestpathGetPred(ShortestpathState *spstate, MinimalTuple tuple)
+{
+	int64		pred;
+
+	if (tuple->t_len == sizeof(*tuple) + sizeof(Graphid) + spstate->sp_RowidSize)
+		return -1;
+
+	Assert(tuple->t_len == sizeof(*tuple) + sizeof(Graphid) +
+		   spstate->sp_RowidSize + sizeof(int64));
+	memcpy(&pred,
+		   ((unsigned char *) (tuple + 1)) + sizeof(Graphid) + spstate->sp_RowidSize,
+		   sizeof(pred));
+
+	return pred;
+}
+
+/*
+ * outerTuple and innerTuple are the path tuples of the start and the end
+ * side that meet each other, or NULL if the side has not been expanded.
+ */
 TupleTableSlot *
 ExecShortestpathProject(ShortestpathState *node,
-						unsigned char *outerids,
+						MinimalTuple outerTuple,
 						long lenOuterids,
-						unsigned char *innerids,
-						long lenInnerids,
-						int sizeGraphid,
-						int sizeRowid)
+						MinimalTuple innerTuple,
+						long lenInnerids)
 {
+	Hash2SideState *startNode = (Hash2SideState *) outerPlanState(node);
+	Hash2SideState *endNode = (Hash2SideState *) innerPlanState(node);
+	int			sizeRowid = node->sp_RowidSize;
 	ProjectionInfo *projInfo;
 	ExprContext *econtext;
 	TupleTableSlot *slot;
 	Datum	   *tts_values;
 	bool	   *tts_isnull;
-	unsigned char *oids;
-	unsigned char *iids;
-	unsigned char *vids;
+	MemoryContext oldContext;
+	Graphid    *vids;
 	unsigned char *eids;
 	long		lenVids;
 	long		lenEids;
+	int64		idx;
 	long		i;
 
-	oids = outerids + (sizeGraphid + sizeRowid) * lenOuterids;
-	iids = innerids;
-	vids = node->sp_Vertexids;
-	eids = node->sp_Edgeids;
-	lenVids = 0;
-	lenEids = 0;
-	for (i = 0; i < lenOuterids; i++)
+	projInfo = node->js.ps.ps_ProjInfo;
+	slot = projInfo->pi_state.resultslot;
+	econtext = projInfo->pi_exprContext;
+
+	lenEids = lenOuterids + lenInnerids;
+	lenVids = lenEids + 1;
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+	vids = (Graphid *) palloc(sizeof(Graphid) * lenVids);
+	eids = (unsigned char *) palloc(sizeRowid * Max(lenEids, 1));
+	MemoryContextSwitchTo(oldContext);
+
+	/* from the meeting vertex back to the start vertex */
+	vids[0] = node->startVid;
+	idx = (lenOuterids > 0) ? ExecShortestpathGetPred(node, outerTuple) : -1;
+	for (i = lenOuterids; i > 0; i--)
 	{
-		memcpy(vids, oids, sizeGraphid);
-		vids += sizeGraphid;
-		oids -= sizeRowid;
-		lenVids++;
-		memcpy(eids, oids, sizeRowid);
-		eids += sizeRowid;
-		oids -= sizeGraphid;
-		lenEids++;
+		SpPred	   *pred = SP_PRED(startNode, node, idx);
+
+		vids[i] = pred->vid;
+		memcpy(eids + (i - 1) * sizeRowid, SP_PRED_ROWID(pred), sizeRowid);
+		idx = pred->parent;
 	}
-	memcpy(vids, iids, sizeGraphid);
-	vids += sizeGraphid;
-	iids += sizeGraphid;
-	lenVids++;
+	Assert(idx == -1);
+
+	/* from the meeting vertex to the end vertex */
+	idx = (lenInnerids > 0) ? ExecShortestpathGetPred(node, innerTuple) : -1;
 	for (i = 0; i < lenInnerids; i++)
 	{
-		memcpy(eids, iids, sizeRowid);
-		eids += sizeRowid;
-		iids += sizeRowid;
-		lenEids++;
-		memcpy(vids, iids, sizeGraphid);
-		vids += sizeGraphid;
-		iids += sizeGraphid;
-		lenVids++;
+		SpPred	   *pred = SP_PRED(endNode, node, idx);
+
+		memcpy(eids + (lenOuterids + i) * sizeRowid, SP_PRED_ROWID(pred),
+			   sizeRowid);
+		idx = pred->parent;
+		if (idx < 0)
+			vids[lenOuterids + i + 1] = node->endVid;
+		else
+			vids[lenOuterids + i + 1] = SP_PRED(endNode, node, idx)->vid;
 	}
-
-	projInfo = node->js.ps.ps_ProjInfo;
-	slot = projInfo->pi_state.resultslot;
-	econtext = projInfo->pi_exprContext;
+	Assert(idx == -1);
 
 	ExecClearTuple(slot);
 
 	tts_values = slot->tts_values;
 	tts_isnull = slot->tts_isnull;
 
-	tts_values[0] = ExecShortestpathProjectEvalArray(GRAPHIDOID, node->sp_Vertexids, lenVids, econtext);
+	tts_values[0] = ExecShortestpathProjectEvalArray(GRAPHIDOID, (unsigned char *) vids, lenVids, econtext);
 	tts_isnull[0] = false;
-	tts_values[1] = ExecShortestpathProjectEvalArray(ROWIDOID, node->sp_Edgeids, lenEids, econtext);
+	tts_values[1] = ExecShortestpathProjectEvalArray(ROWIDOID, eids, lenEids, econtext);
 	tts_isnull[1] = false;
 
 	return ExecStoreVirtualTuple(slot);
@@ -251,6 +251,9 @@ _copyAppend(const Append *from)
 	COPY_SCALAR_FIELD(nasyncplans);
 	COPY_SCALAR_FIELD(first_partial_plan);
 	COPY_NODE_FIELD(part_prune_info);
+	COPY_NODE_FIELD(graph_id_expr);
+	COPY_NODE_FIELD(graph_labids);
+	COPY_SCALAR_FIELD(graph_id_exec);
 
 	return newnode;
 }
@@ -1330,6 +1333,8 @@ _copyDijkstra(const Dijkstra *from)
 	COPY_NODE_FIELD(source);
 	COPY_NODE_FIELD(target);
 	COPY_NODE_FIELD(limit);
+	COPY_NODE_FIELD(heuristic);
+	COPY_SCALAR_FIELD(topk);
 
 	return newnode;
 }
@@ -2518,6 +2523,7 @@ _copyRestrictInfo(const RestrictInfo *from)
 	COPY_SCALAR_FIELD(can_join);
 	COPY_SCALAR_FIELD(pseudoconstant);
 	COPY_SCALAR_FIELD(leakproof);
+	COPY_SCALAR_FIELD(join_redundant);
 	COPY_SCALAR_FIELD(has_volatile);
 	COPY_SCALAR_FIELD(security_level);
 	COPY_BITMAPSET_FIELD(clause_relids);
@@ -3381,7 +3387,9 @@ _copyQuery(const Query *from)
 	COPY_SCALAR_FIELD(dijkstraWeightOut);
 	COPY_NODE_FIELD(dijkstraEndId);
 	COPY_NODE_FIELD(dijkstraEdgeId);
+	COPY_NODE_FIELD(dijkstraHeuristic);
 	COPY_NODE_FIELD(dijkstraLimit);
+	COPY_SCALAR_FIELD(dijkstraTopK);
 	COPY_NODE_FIELD(shortestpathEndIdLeft);
 	COPY_NODE_FIELD(shortestpathEndIdRight);
 	COPY_NODE_FIELD(shortestpathTableOidLeft);
@@ -5461,6 +5469,7 @@ _copyGraphVLE(const GraphVLE *from)
 
 	COPY_NODE_FIELD(subplan);
 	COPY_NODE_FIELD(vle_rel);
+	COPY_SCALAR_FIELD(bfs);
 
 	return newnode;
 }
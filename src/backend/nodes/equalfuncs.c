@@ -1087,7 +1087,9 @@ _equalQuery(const Query *a, const Query *b)
 	COMPARE_SCALAR_FIELD(dijkstraWeightOut);
 	COMPARE_NODE_FIELD(dijkstraEndId);
 	COMPARE_NODE_FIELD(dijkstraEdgeId);
+	COMPARE_NODE_FIELD(dijkstraHeuristic);
 	COMPARE_NODE_FIELD(dijkstraLimit);
+	COMPARE_SCALAR_FIELD(dijkstraTopK);
 	COMPARE_NODE_FIELD(shortestpathEndIdLeft);
 	COMPARE_NODE_FIELD(shortestpathEndIdRight);
 	COMPARE_NODE_FIELD(shortestpathTableOidLeft);
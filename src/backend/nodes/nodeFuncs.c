@@ -2569,6 +2569,8 @@ query_tree_walker(Query *query,
 		return true;
 	if (walker(query->dijkstraEdgeId, context))
 		return true;
+	if (walker(query->dijkstraHeuristic, context))
+		return true;
 	if (walker(query->dijkstraLimit, context))
 		return true;
 	if (walker(query->shortestpathEndIdLeft, context))
@@ -3610,6 +3612,7 @@ query_tree_mutator(Query *query,
 
 	MUTATE(query->dijkstraEndId, query->dijkstraEndId, Node *);
 	MUTATE(query->dijkstraEdgeId, query->dijkstraEdgeId, Node *);
+	MUTATE(query->dijkstraHeuristic, query->dijkstraHeuristic, Node *);
 	MUTATE(query->dijkstraLimit, query->dijkstraLimit, Node *);
 	MUTATE(query->shortestpathEndIdLeft, query->shortestpathEndIdLeft, Node *);
 	MUTATE(query->shortestpathEndIdRight, query->shortestpathEndIdRight, Node *);
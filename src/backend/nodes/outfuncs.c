@@ -439,6 +439,9 @@ _outAppend(StringInfo str, const Append *node)
 	WRITE_INT_FIELD(nasyncplans);
 	WRITE_INT_FIELD(first_partial_plan);
 	WRITE_NODE_FIELD(part_prune_info);
+	WRITE_NODE_FIELD(graph_id_expr);
+	WRITE_NODE_FIELD(graph_labids);
+	WRITE_BOOL_FIELD(graph_id_exec);
 }
 
 static void
@@ -1041,6 +1044,8 @@ _outDijkstra(StringInfo str, const Dijkstra *node)
 	WRITE_NODE_FIELD(source);
 	WRITE_NODE_FIELD(target);
 	WRITE_NODE_FIELD(limit);
+	WRITE_NODE_FIELD(heuristic);
+	WRITE_BOOL_FIELD(topk);
 }
 
 static void
@@ -2383,9 +2388,11 @@ _outDijkstraPath(StringInfo str, const DijkstraPath *node)
 	WRITE_INT_FIELD(weight);
 	WRITE_NODE_FIELD(end_id);
 	WRITE_NODE_FIELD(edge_id);
+	WRITE_NODE_FIELD(heuristic);
 	WRITE_NODE_FIELD(source);
 	WRITE_NODE_FIELD(target);
 	WRITE_NODE_FIELD(limit);
+	WRITE_BOOL_FIELD(topk);
 }
 
 static void
@@ -2733,6 +2740,7 @@ _outRestrictInfo(StringInfo str, const RestrictInfo *node)
 	WRITE_BOOL_FIELD(can_join);
 	WRITE_BOOL_FIELD(pseudoconstant);
 	WRITE_BOOL_FIELD(leakproof);
+	WRITE_BOOL_FIELD(join_redundant);
 	WRITE_ENUM_FIELD(has_volatile, VolatileFunctionStatus);
 	WRITE_UINT_FIELD(security_level);
 	WRITE_BITMAPSET_FIELD(clause_relids);
@@ -3289,7 +3297,9 @@ _outQuery(StringInfo str, const Query *node)
 	WRITE_BOOL_FIELD(dijkstraWeightOut);
 	WRITE_NODE_FIELD(dijkstraEndId);
 	WRITE_NODE_FIELD(dijkstraEdgeId);
+	WRITE_NODE_FIELD(dijkstraHeuristic);
 	WRITE_NODE_FIELD(dijkstraLimit);
+	WRITE_BOOL_FIELD(dijkstraTopK);
 	WRITE_NODE_FIELD(shortestpathEndIdLeft);
 	WRITE_NODE_FIELD(shortestpathEndIdRight);
 	WRITE_NODE_FIELD(shortestpathTableOidLeft);
@@ -294,7 +294,9 @@ _readQuery(void)
 	READ_BOOL_FIELD(dijkstraWeightOut);
 	READ_NODE_FIELD(dijkstraEndId);
 	READ_NODE_FIELD(dijkstraEdgeId);
+	READ_NODE_FIELD(dijkstraHeuristic);
 	READ_NODE_FIELD(dijkstraLimit);
+	READ_BOOL_FIELD(dijkstraTopK);
 	READ_NODE_FIELD(shortestpathEndIdLeft);
 	READ_NODE_FIELD(shortestpathEndIdRight);
 	READ_NODE_FIELD(shortestpathTableOidLeft);
@@ -1754,6 +1756,9 @@ _readAppend(void)
 	READ_INT_FIELD(nasyncplans);
 	READ_INT_FIELD(first_partial_plan);
 	READ_NODE_FIELD(part_prune_info);
+	READ_NODE_FIELD(graph_id_expr);
+	READ_NODE_FIELD(graph_labids);
+	READ_BOOL_FIELD(graph_id_exec);
 
 	READ_DONE();
 }
@@ -2589,6 +2594,8 @@ _readDijkstra(void)
 	READ_NODE_FIELD(source);
 	READ_NODE_FIELD(target);
 	READ_NODE_FIELD(limit);
+	READ_NODE_FIELD(heuristic);
+	READ_BOOL_FIELD(topk);
 
 	READ_DONE();
 }
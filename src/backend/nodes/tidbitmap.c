@@ -671,6 +671,36 @@ tbm_is_empty(const TIDBitmap *tbm)
 	return (tbm->nentries == 0);
 }
 
+/*
+ * tbm_contains_tuple - might the TIDBitmap contain the given TID?
+ *
+ * Returns true if the TID is stored exactly, or its page is stored lossily.
+ */
+bool
+tbm_contains_tuple(const TIDBitmap *tbm, ItemPointer tid)
+{
+	BlockNumber blk = ItemPointerGetBlockNumber(tid);
+	OffsetNumber off = ItemPointerGetOffsetNumber(tid);
+	const PagetableEntry *page;
+	int			wordnum,
+				bitnum;
+
+	Assert(tbm->iterating == TBM_NOT_ITERATING);
+
+	if (tbm_page_is_lossy(tbm, blk))
+		return true;
+
+	page = tbm_find_pageentry(tbm, blk);
+	if (page == NULL)
+		return false;
+
+	Assert(off >= 1 && off <= MAX_TUPLES_PER_PAGE);
+	wordnum = WORDNUM(off - 1);
+	bitnum = BITNUM(off - 1);
+
+	return (page->words[wordnum] & ((bitmapword) 1 << bitnum)) != 0;
+}
+
 /*
  * tbm_begin_iterate - prepare to iterate through a TIDBitmap
  *
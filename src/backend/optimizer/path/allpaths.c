@@ -1025,7 +1025,8 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 		 * child RelOptInfo was built.  So we don't need any additional setup
 		 * before applying constraint exclusion.
 		 */
-		if (relation_excluded_by_constraints(root, childrel, childRTE))
+		if (relation_excluded_by_constraints(root, childrel, childRTE) ||
+			graph_label_excluded_by_id(root, childrel, childRTE))
 		{
 			/*
 			 * This child need not be scanned, so we can omit it from the
@@ -73,9 +73,14 @@
 
 #include <math.h>
 
+#include "ag_const.h"
 #include "access/amapi.h"
 #include "access/htup_details.h"
+#include "access/table.h"
 #include "access/tsmapi.h"
+#include "catalog/ag_graph_fn.h"
+#include "catalog/ag_graphmeta.h"
+#include "catalog/pg_inherits.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
 #include "executor/nodeHash.h"
@@ -108,6 +113,18 @@
  */
 #define APPEND_CPU_COST_MULTIPLIER 0.5
 
+/*
+ * A breadth-first GraphVLE sorts and batches the index probes of a whole
+ * frontier, which is not worth it for frontiers narrower than this.
+ */
+#define GRAPH_VLE_BFS_MIN_FRONTIER	32
+
+/* Estimated memory held per path by a breadth-first GraphVLE */
+#define GRAPH_VLE_BFS_PATH_WIDTH	128
+
+/* Number of hops assumed for a GraphVLE without a maximum */
+#define GRAPH_VLE_UNBOUNDED_HOPS	10
+
 /*
  * Maximum value for row estimates.  We cap row estimates to this to help
  * ensure that costs based on these estimates remain within the range of what
@@ -178,6 +195,7 @@ static double calc_joinrel_size_estimate(PlannerInfo *root,
 										 double inner_rows,
 										 SpecialJoinInfo *sjinfo,
 										 List *restrictlist);
+static List *remove_join_redundant_clauses(List *restrictlist);
 static Selectivity get_foreign_key_join_selectivity(PlannerInfo *root,
 													Relids outer_relids,
 													Relids inner_relids,
@@ -2421,6 +2439,228 @@ cost_dijkstra(Path *path,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * Sums the estimated number of tuples of the given labels.
+ */
+static double
+label_tuples(List *relids)
+{
+	ListCell   *lc;
+	double		ntuples = 0;
+
+	foreach(lc, relids)
+	{
+		Relation	rel = table_open(lfirst_oid(lc), AccessShareLock);
+		BlockNumber pages;
+		double		tuples;
+		double		allvisfrac;
+
+		estimate_rel_size(rel, NULL, &pages, &tuples, &allvisfrac);
+		ntuples += tuples;
+
+		table_close(rel, NoLock);
+	}
+
+	return ntuples;
+}
+
+/*
+ * Estimates the average degree of the vertices that can be an endpoint of the
+ * edges counted in `metas`, using the per-label edge counts of ag_graphmeta.
+ * The `start` or `end` labels of the entries are the vertices a hop starts
+ * from, depending on `outgoing`.
+ */
+static double
+graphmeta_degree(Oid graphoid, List *metas, bool outgoing)
+{
+	List	   *vertex_relids = NIL;
+	ListCell   *lc;
+	double		nedges = 0;
+
+	foreach(lc, metas)
+	{
+		Form_ag_graphmeta meta = (Form_ag_graphmeta) lfirst(lc);
+		Oid			vertex_relid;
+
+		vertex_relid = get_labid_relid(graphoid,
+									   outgoing ? meta->start : meta->end);
+		if (OidIsValid(vertex_relid))
+			vertex_relids = list_append_unique_oid(vertex_relids, vertex_relid);
+
+		nedges += meta->edgecount;
+	}
+
+	return nedges / clamp_row_est(label_tuples(vertex_relids));
+}
+
+/*
+ * estimate_graph_vle_fanout
+ *	  Estimates the number of edges a single hop of `vle_rel` follows from a
+ *	  vertex, i.e. the average degree of the vertices over its edge labels.
+ *
+ * The edge counts of ag_graphmeta are used if it has been gathered for the
+ * edge labels, so that the degree is taken over the vertex labels actually
+ * connected by them.  Otherwise the edges are spread over all vertices.
+ */
+double
+estimate_graph_vle_fanout(PlannerInfo *root, CypherRel *vle_rel)
+{
+	Oid			graphoid = get_graph_path_oid();
+	char	   *labname;
+	Oid			edge_relid;
+	List	   *edge_relids;
+	List	   *metas = NIL;
+	ListCell   *lc;
+	double		fanout;
+
+	labname = (vle_rel->types == NIL) ?
+		AG_EDGE : getCypherName(linitial(vle_rel->types));
+	edge_relid = get_laboid_relid(get_labname_laboid(labname, graphoid));
+	if (!OidIsValid(edge_relid))
+		return 1.0;
+
+	if (vle_rel->only)
+		edge_relids = list_make1_oid(edge_relid);
+	else
+		edge_relids = find_all_inheritors(edge_relid, AccessShareLock, NULL);
+
+	foreach(lc, get_planner_graphmeta_list(root, graphoid))
+	{
+		Form_ag_graphmeta meta = (Form_ag_graphmeta) lfirst(lc);
+
+		if (list_member_oid(edge_relids, get_labid_relid(graphoid, meta->edge)))
+			metas = lappend(metas, meta);
+	}
+
+	if (metas != NIL)
+	{
+		fanout = 0;
+		if (vle_rel->direction != CYPHER_REL_DIR_LEFT)
+			fanout += graphmeta_degree(graphoid, metas, true);
+		if (vle_rel->direction != CYPHER_REL_DIR_RIGHT)
+			fanout += graphmeta_degree(graphoid, metas, false);
+	}
+	else
+	{
+		Oid			vertex_relid;
+		double		nvertices;
+
+		vertex_relid = get_laboid_relid(get_labname_laboid(AG_VERTEX,
+														   graphoid));
+		nvertices = label_tuples(find_all_inheritors(vertex_relid,
+													 AccessShareLock, NULL));
+
+		fanout = label_tuples(edge_relids) / clamp_row_est(nvertices);
+
+		/* an undirected hop follows the edges of both directions */
+		if (vle_rel->direction == CYPHER_REL_DIR_NONE)
+			fanout *= 2;
+	}
+
+	return fanout;
+}
+
+/*
+ * graph_vle_prefers_bfs
+ *	  Decides whether a GraphVLE should expand its paths breadth-first.
+ *
+ * Breadth-first expansion probes the edge indexes once per frontier vertex,
+ * in graphid order, but has to keep the paths of every level it expanded in
+ * memory.  It is only chosen when the hops are bounded, the frontier to be
+ * expanded at the last hop is wide enough for the batching to pay off, and
+ * all the paths up to the maximum hop fit in work_mem.
+ */
+bool
+graph_vle_prefers_bfs(CypherRel *vle_rel, double fanout)
+{
+	A_Indices  *varlen = (A_Indices *) vle_rel->varlen;
+	int			min_hops;
+	int			max_hops;
+	double		frontier;
+	double		npaths;
+	int			hops;
+
+	if (varlen->uidx == NULL)
+		return false;
+
+	min_hops = ((A_Const *) varlen->lidx)->val.val.ival;
+	max_hops = ((A_Const *) varlen->uidx)->val.val.ival;
+	if (max_hops < 2 || max_hops < min_hops)
+		return false;
+
+	frontier = 1;
+	npaths = 0;
+	for (hops = 1; hops < max_hops; hops++)
+	{
+		frontier *= fanout;
+		npaths += frontier;
+	}
+	npaths += frontier * fanout;
+
+	if (frontier < GRAPH_VLE_BFS_MIN_FRONTIER)
+		return false;
+
+	return npaths * GRAPH_VLE_BFS_PATH_WIDTH <= work_mem * 1024.0;
+}
+
+/*
+ * cost_graph_vle
+ *	  Determines the cost of expanding the variable length paths
+ *	  of a GraphVLEPath from each row of its subpath.
+ *
+ * Every hop multiplies the number of paths by the fan-out of the edge label.
+ * Each path that is expanded further costs an index probe on the edge label,
+ * and each edge found costs a tuple fetch plus the uniqueness and property
+ * checks.  Only the paths between the minimum and maximum hops are returned.
+ * If there is no maximum, the paths are assumed to stop growing after
+ * GRAPH_VLE_UNBOUNDED_HOPS hops.
+ */
+void
+cost_graph_vle(GraphVLEPath *path, double fanout)
+{
+	CypherRel  *vle_rel = path->vle_rel;
+	Path	   *subpath = path->subpath;
+	A_Indices  *varlen = (A_Indices *) vle_rel->varlen;
+	int			min_hops;
+	int			max_hops;
+	double		frontier = 1;
+	double		nprobes = 0;
+	double		nedges = 0;
+	double		npaths;
+	Cost		cpu_per_edge;
+	Cost		run_cost_per_row;
+	int			hops;
+
+	min_hops = ((A_Const *) varlen->lidx)->val.val.ival;
+	if (varlen->uidx != NULL)
+		max_hops = ((A_Const *) varlen->uidx)->val.val.ival;
+	else
+		max_hops = Max(min_hops, GRAPH_VLE_UNBOUNDED_HOPS);
+
+	npaths = (min_hops == 0) ? 1 : 0;
+	for (hops = 1; hops <= max_hops; hops++)
+	{
+		nprobes += frontier;
+		frontier *= fanout;
+		nedges += frontier;
+		if (hops >= min_hops)
+			npaths += frontier;
+	}
+
+	cpu_per_edge = cpu_tuple_cost + cpu_operator_cost;
+	if (vle_rel->prop_map != NULL)
+		cpu_per_edge += cpu_operator_cost;
+
+	run_cost_per_row = nprobes * (random_page_cost + cpu_index_tuple_cost) +
+		nedges * cpu_per_edge +
+		npaths * cpu_tuple_cost;
+
+	path->path.rows = clamp_row_est(subpath->rows * npaths);
+	path->path.startup_cost = subpath->startup_cost;
+	path->path.total_cost = subpath->total_cost +
+		subpath->rows * run_cost_per_row;
+}
+
 /*
  * cost_memoize_rescan
  *	  Determines the estimated cost of rescanning a Memoize node.
@@ -3792,6 +4032,31 @@ initial_cost_hashjoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 		* inner_path_rows;
 	run_cost += cpu_operator_cost * num_hashclauses * outer_path_rows;
 
+	/*
+	 * Cypher MERGE creates the pattern for each outer row that does not match
+	 * it, and the hash table is built again before the next outer row is
+	 * probed (see ExecHashJoinInvalidateInner()).  Charge a rescan of the
+	 * inner relation and the hashing of its rows for each of those rows.
+	 */
+	if (jointype == JOIN_CYPHER_MERGE)
+	{
+		Selectivity match_selec;
+		double		nmisses;
+		Cost		rescan_startup_cost;
+		Cost		rescan_total_cost;
+
+		match_selec = clauselist_selectivity(root, hashclauses, 0,
+											 JOIN_INNER, extra->sjinfo);
+		nmisses = outer_path_rows *
+			Max(1.0 - inner_path_rows * match_selec, 0.0);
+
+		cost_rescan(root, inner_path, &rescan_startup_cost, &rescan_total_cost);
+		run_cost += nmisses *
+			(rescan_total_cost +
+			 (cpu_operator_cost * num_hashclauses + cpu_tuple_cost) *
+			 inner_path_rows);
+	}
+
 	/*
 	 * If this is a parallel hash build, then the value we have for
 	 * inner_rows_total currently refers only to the rows returned by each
@@ -5132,6 +5397,12 @@ calc_joinrel_size_estimate(PlannerInfo *root,
 											   sjinfo,
 											   &restrictlist);
 
+	/*
+	 * Ignore clauses that other joinclauses imply; their selectivity is
+	 * already counted.
+	 */
+	restrictlist = remove_join_redundant_clauses(restrictlist);
+
 	/*
 	 * For an outer join, we have to distinguish the selectivity of the join's
 	 * own clauses (JOIN/ON conditions) from any clauses that were "pushed
@@ -5232,6 +5503,38 @@ calc_joinrel_size_estimate(PlannerInfo *root,
 	return clamp_row_est(nrows);
 }
 
+/*
+ * remove_join_redundant_clauses
+ *		Drop the clauses marked join_redundant from a join's restrictlist.
+ *
+ * The input list is returned as-is if there are none, else a new list.
+ */
+static List *
+remove_join_redundant_clauses(List *restrictlist)
+{
+	List	   *result;
+	ListCell   *lc;
+
+	foreach(lc, restrictlist)
+	{
+		if (lfirst_node(RestrictInfo, lc)->join_redundant)
+			break;
+	}
+	if (lc == NULL)
+		return restrictlist;
+
+	result = NIL;
+	foreach(lc, restrictlist)
+	{
+		RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+
+		if (!rinfo->join_redundant)
+			result = lappend(result, rinfo);
+	}
+
+	return result;
+}
+
 /*
  * get_foreign_key_join_selectivity
  *		Estimate join selectivity for foreign-key-related clauses.
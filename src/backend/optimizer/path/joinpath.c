@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include "executor/executor.h"
+#include "executor/nodeHash.h"
 #include "foreign/fdwapi.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/cost.h"
@@ -99,6 +100,9 @@ static void generate_mergejoin_paths(PlannerInfo *root,
 static void add_cyphermerge_path(PlannerInfo *root, RelOptInfo *joinrel,
 								 RelOptInfo *outerrel, RelOptInfo *innerrel,
 								 JoinPathExtraData *extra);
+static void hash_cyphermerge_path(PlannerInfo *root, RelOptInfo *joinrel,
+								  RelOptInfo *outerrel, RelOptInfo *innerrel,
+								  JoinPathExtraData *extra);
 static void add_cypherdelete_path(PlannerInfo *root, RelOptInfo *joinrel,
 								  RelOptInfo *outerrel, RelOptInfo *innerrel,
 								  JoinType type, JoinPathExtraData *extra);
@@ -2416,8 +2420,8 @@ select_mergejoin_clauses(PlannerInfo *root,
 }
 
 /*
- * If Cypher MERGE join is explicitly specified,
- * no other join methods are considered.
+ * If Cypher MERGE join is explicitly specified, only nested loops and a
+ * single-batch hash join are considered.
  *
  * See match_unsorted_outer_for_vle().
  */
@@ -2454,11 +2458,75 @@ add_cyphermerge_path(PlannerInfo *root, RelOptInfo *joinrel,
 		}
 	}
 
+	hash_cyphermerge_path(root, joinrel, outerrel, innerrel, extra);
+
 	if (joinrel->consider_parallel && bms_is_empty(joinrel->lateral_relids))
 		consider_parallel_nestloop(root, joinrel, outerrel, innerrel,
 								   JOIN_CYPHER_MERGE, extra);
 }
 
+/*
+ * Consider a hash join for Cypher MERGE.
+ *
+ * The hash join probes a hash table of the pattern instead of rescanning it
+ * for every row, but MERGE modifies the pattern in the middle of the join.
+ * The hash table is then built again before the next row is probed (see
+ * ExecHashJoinInvalidateInner()), which is only possible while the outer
+ * relation has not been split into batches.  So the hash join is considered
+ * only if the pattern is expected to fit in a single batch, and never in
+ * parallel since the workers could not see what MERGE creates.  The rebuilds
+ * are charged by initial_cost_hashjoin().
+ */
+static void
+hash_cyphermerge_path(PlannerInfo *root, RelOptInfo *joinrel,
+					  RelOptInfo *outerrel, RelOptInfo *innerrel,
+					  JoinPathExtraData *extra)
+{
+	Path	   *outerpath = outerrel->cheapest_total_path;
+	Path	   *innerpath = innerrel->cheapest_total_path;
+	List	   *hashclauses = NIL;
+	ListCell   *l;
+	size_t		space_allowed;
+	int			numbuckets;
+	int			numbatches;
+	int			num_skew_mcvs;
+
+	foreach(l, extra->restrictlist)
+	{
+		RestrictInfo *restrictinfo = (RestrictInfo *) lfirst(l);
+
+		/* only use the join's own clauses, as for other outer joins */
+		if (RINFO_IS_PUSHED_DOWN(restrictinfo, joinrel->relids))
+			continue;
+
+		if (!restrictinfo->can_join ||
+			restrictinfo->hashjoinoperator == InvalidOid)
+			continue;			/* not hashjoinable */
+
+		if (!clause_sides_match_join(restrictinfo, outerrel, innerrel))
+			continue;			/* no good for these input relations */
+
+		hashclauses = lappend(hashclauses, restrictinfo);
+	}
+
+	if (hashclauses == NIL)
+		return;
+
+	if (PATH_PARAM_BY_REL(outerpath, innerrel) ||
+		PATH_PARAM_BY_REL(innerpath, outerrel))
+		return;
+
+	ExecChooseHashTableSize(innerpath->rows, innerpath->pathtarget->width,
+							true, false, 0,
+							&space_allowed, &numbuckets, &numbatches,
+							&num_skew_mcvs);
+	if (numbatches > 1)
+		return;
+
+	try_hashjoin_path(root, joinrel, outerpath, innerpath, hashclauses,
+					  JOIN_CYPHER_MERGE, extra);
+}
+
 /*
  * If Cypher DELETE/DETACH join is explicitly specified,
  * no other join methods are considered.
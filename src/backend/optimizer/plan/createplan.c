@@ -41,6 +41,7 @@
 #include "parser/parse_clause.h"
 #include "parser/parsetree.h"
 #include "partitioning/partprune.h"
+#include "utils/graph.h"
 #include "utils/lsyscache.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_type.h"
@@ -87,6 +88,7 @@ static Plan *create_join_plan(PlannerInfo *root, JoinPath *best_path);
 static bool is_async_capable_plan(Plan *plan, Path *path);
 static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path,
 								int flags);
+static bool contain_exec_param_walker(Node *node, void *context);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path,
 									  int flags);
 static Result *create_group_result_plan(PlannerInfo *root,
@@ -1387,6 +1389,57 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path, int flags)
 										 prunequal);
 	}
 
+	/*
+	 * A graph label and its children are not partitioned, but every graphid
+	 * carries the label of its vertex or edge. If the scan is by an id known
+	 * only at execution time, record the label of each subplan so that the
+	 * executor can scan just the one the id belongs to.
+	 */
+	if (partpruneinfo == NULL && !best_path->path.parallel_aware &&
+		pathkeys == NIL && nasyncplans == 0)
+	{
+		List	   *clauses = rel->baserestrictinfo;
+		Expr	   *id_expr;
+
+		if (best_path->path.param_info)
+			clauses = list_concat_copy(clauses,
+									   best_path->path.param_info->ppi_clauses);
+
+		id_expr = find_graph_label_id_expr(root, rel, clauses);
+		if (id_expr != NULL)
+		{
+			List	   *labids = NIL;
+
+			foreach(subpaths, best_path->subpaths)
+			{
+				RelOptInfo *childrel = ((Path *) lfirst(subpaths))->parent;
+				uint16		labid = InvalidLabid;
+
+				if (childrel->reloptkind == RELOPT_OTHER_MEMBER_REL &&
+					childrel->rtekind == RTE_RELATION)
+					labid = get_relid_labid(planner_rt_fetch(childrel->relid,
+															 root)->relid);
+				if (labid == InvalidLabid)
+				{
+					labids = NIL;
+					break;
+				}
+
+				labids = lappend_int(labids, labid);
+			}
+
+			if (labids != NIL)
+			{
+				plan->graph_id_expr = (Expr *)
+					replace_nestloop_params(root, (Node *) copyObject(id_expr));
+				plan->graph_labids = labids;
+				plan->graph_id_exec =
+					contain_exec_param_walker((Node *) plan->graph_id_expr,
+											  NULL);
+			}
+		}
+	}
+
 	plan->appendplans = subplans;
 	plan->nasyncplans = nasyncplans;
 	plan->first_partial_plan = best_path->first_partial_path;
@@ -1410,6 +1463,22 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path, int flags)
 		return (Plan *) plan;
 }
 
+/*
+ * contain_exec_param_walker
+ *	  Does the graph id expression of an Append reference any PARAM_EXEC
+ *	  Param?  Only those change between rescans; a PARAM_EXTERN is fixed for
+ *	  the whole execution and can be used to prune at executor startup.
+ */
+static bool
+contain_exec_param_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+		return ((Param *) node)->paramkind == PARAM_EXEC;
+	return expression_tree_walker(node, contain_exec_param_walker, context);
+}
+
 /*
  * create_merge_append_plan
  *	  Create a MergeAppend plan for 'best_path' and (recursively) plans
@@ -4900,7 +4969,7 @@ create_graph_vle_plan(PlannerInfo *root, GraphVLEPath *best_path)
 
 	apply_tlist_labeling(subplan->targetlist, root->processed_tlist);
 
-	plan = make_graph_vle(root, subplan, best_path->vle_rel);
+	plan = make_graph_vle(root, subplan, best_path->vle_rel, best_path->bfs);
 
 	copy_generic_path_info(&plan->plan, &best_path->path);
 
@@ -4928,7 +4997,8 @@ create_dijkstra_plan(PlannerInfo *root, DijkstraPath *best_path)
 	plan = make_dijkstra(root, build_path_tlist(root, &best_path->path),
 						 subplan, best_path->weight, best_path->weight_out,
 						 end_id, edge_id, best_path->source,
-						 best_path->target, best_path->limit);
+						 best_path->target, best_path->limit,
+						 best_path->heuristic, best_path->topk);
 
 	copy_generic_path_info(&plan->plan, &best_path->path);
 
@@ -7496,12 +7566,14 @@ make_modifygraph(PlannerInfo *root, GraphWriteOp operation, bool last,
 }
 
 GraphVLE *
-make_graph_vle(PlannerInfo *root, Plan *subplan, CypherRel *vle_rel)
+make_graph_vle(PlannerInfo *root, Plan *subplan, CypherRel *vle_rel,
+			   bool bfs)
 {
 	GraphVLE   *node = makeNode(GraphVLE);
 
 	node->subplan = subplan;
 	node->vle_rel = (Node *) vle_rel;
+	node->bfs = bfs;
 
 	return node;
 }
@@ -7581,7 +7653,8 @@ make_hash2side(Plan *lefttree,
 Dijkstra *
 make_dijkstra(PlannerInfo *root, List *tlist, Plan *lefttree,
 			  AttrNumber weight, bool weight_out, AttrNumber end_id,
-			  AttrNumber edge_id, Node *source, Node *target, Node *limit)
+			  AttrNumber edge_id, Node *source, Node *target, Node *limit,
+			  Node *heuristic, bool topk)
 {
 	Dijkstra   *node = makeNode(Dijkstra);
 	Plan	   *plan = &node->plan;
@@ -7593,6 +7666,8 @@ make_dijkstra(PlannerInfo *root, List *tlist, Plan *lefttree,
 	node->source = source;
 	node->target = target;
 	node->limit = limit;
+	node->heuristic = heuristic;
+	node->topk = topk;
 
 	plan->qual = NIL;
 	plan->targetlist = tlist;
@@ -15,6 +15,7 @@
 #include "postgres.h"
 
 #include "catalog/pg_class.h"
+#include "catalog/pg_operator.h"
 #include "catalog/pg_type.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
@@ -31,8 +32,11 @@
 #include "optimizer/prep.h"
 #include "optimizer/restrictinfo.h"
 #include "parser/analyze.h"
+#include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
+#include "utils/graph.h"
 #include "utils/lsyscache.h"
+#include "utils/syscache.h"
 #include "utils/typcache.h"
 
 /* These parameters are set by GUC */
@@ -77,6 +81,7 @@ static bool check_outerjoin_delay(PlannerInfo *root, Relids *relids_p,
 static bool check_equivalence_delay(PlannerInfo *root,
 									RestrictInfo *restrictinfo);
 static bool check_redundant_nullability_qual(PlannerInfo *root, Node *clause);
+static bool is_undirected_edge_qual(PlannerInfo *root, Node *clause);
 static void check_mergejoinable(RestrictInfo *restrictinfo);
 static void check_hashjoinable(RestrictInfo *restrictinfo);
 static void check_memoizable(RestrictInfo *restrictinfo);
@@ -205,6 +210,8 @@ build_base_rel_tlists(PlannerInfo *root, List *final_tlist)
 		add_extra_vars_to_targetlist(root, root->parse->dijkstraEndId);
 	if (root->parse->dijkstraEdgeId)
 		add_extra_vars_to_targetlist(root, root->parse->dijkstraEdgeId);
+	if (root->parse->dijkstraHeuristic)
+		add_extra_vars_to_targetlist(root, root->parse->dijkstraHeuristic);
 
 	if (root->parse->shortestpathEndIdLeft)
 		add_extra_vars_to_targetlist(root, root->parse->shortestpathEndIdLeft);
@@ -1876,6 +1883,13 @@ distribute_qual_to_rels(PlannerInfo *root, Node *clause,
 									 outerjoin_nonnullable,
 									 nullable_relids);
 
+	/*
+	 * The join quals of an undirected relationship imply this one, so it
+	 * must not lower join size estimates once more.  It still counts for the
+	 * size of a parameterized scan of the edge label.
+	 */
+	restrictinfo->join_redundant = is_undirected_edge_qual(root, clause);
+
 	/*
 	 * If it's a join clause (either naturally, or because delayed by
 	 * outer-join rules), add vars used in the clause to targetlists of their
@@ -2192,6 +2206,54 @@ check_redundant_nullability_qual(PlannerInfo *root, Node *clause)
 	return false;
 }
 
+/*
+ * is_undirected_edge_qual
+ *	  Check to see if the qual is `vid = start OR vid = "end"` on an edge
+ *	  label.
+ *
+ * The parser adds such a qual next to `vid = _start` (or _end) of an
+ * undirected relationship, only so that the edges of a vertex can be looked
+ * up through the indexes on start and "end" of the edge label.
+ */
+static bool
+is_undirected_edge_qual(PlannerInfo *root, Node *clause)
+{
+	BoolExpr   *orclause;
+	OpExpr	   *startop;
+	OpExpr	   *endop;
+	Var		   *startvar;
+	Var		   *endvar;
+	RangeTblEntry *rte;
+
+	if (!is_orclause(clause))
+		return false;
+	orclause = (BoolExpr *) clause;
+	if (list_length(orclause->args) != 2)
+		return false;
+
+	startop = linitial(orclause->args);
+	endop = lsecond(orclause->args);
+	if (!IsA(startop, OpExpr) || startop->opno != OID_GRAPHID_EQ_OP ||
+		!IsA(endop, OpExpr) || endop->opno != OID_GRAPHID_EQ_OP)
+		return false;
+	if (!equal(linitial(startop->args), linitial(endop->args)))
+		return false;
+
+	startvar = lsecond(startop->args);
+	endvar = lsecond(endop->args);
+	if (!IsA(startvar, Var) || !IsA(endvar, Var) ||
+		startvar->varlevelsup != 0 || endvar->varlevelsup != 0 ||
+		startvar->varno != endvar->varno ||
+		startvar->varattno != Anum_table_edge_start ||
+		endvar->varattno != Anum_table_edge_end)
+		return false;
+
+	rte = planner_rt_fetch(startvar->varno, root);
+
+	return (rte->rtekind == RTE_RELATION &&
+			SearchSysCacheExists1(LABELRELID, ObjectIdGetDatum(rte->relid)));
+}
+
 /*
  * distribute_restrictinfo_to_rels
  *	  Push a completed RestrictInfo into the proper restriction or join
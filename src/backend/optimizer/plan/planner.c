@@ -255,8 +255,9 @@ static RelOptInfo *create_dijkstra_paths(PlannerInfo *root,
 										 PathTarget *path_target,
 										 int weight, bool weight_out,
 										 Node *end_id, Node *egde_id,
+										 Node *heuristic,
 										 Node *source, Node *target,
-										 Node *limit);
+										 Node *limit, bool topk);
 static PathTarget *make_dijkstra_input_target(PlannerInfo *root,
 											  PathTarget *final_target);
 
@@ -325,6 +326,8 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	glob->lastPlanNodeId = 0;
 	glob->transientPlan = false;
 	glob->dependsOnRole = false;
+	glob->graphmetaGraph = InvalidOid;
+	glob->graphmetaList = NIL;
 
 	/*
 	 * Assess whether it's feasible to use parallel mode for this query. We
@@ -1037,6 +1040,9 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
 		parse->dijkstraEdgeId = preprocess_expression(root,
 													  parse->dijkstraEdgeId,
 													  EXPRKIND_TARGET);
+		parse->dijkstraHeuristic = preprocess_expression(root,
+														 parse->dijkstraHeuristic,
+														 EXPRKIND_TARGET);
 		parse->dijkstraLimit = preprocess_expression(root,
 													 parse->dijkstraLimit,
 													 EXPRKIND_TARGET);
@@ -1368,6 +1374,7 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 	RelOptInfo *current_rel;
 	RelOptInfo *final_rel;
 	FinalPathExtraData extra;
+	double		vle_fanout = 0;
 	ListCell   *lc;
 
 	/* Tweak caller-supplied tuple_fraction if have LIMIT/OFFSET */
@@ -1792,9 +1799,11 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 											parse->dijkstraWeightOut,
 											parse->dijkstraEndId,
 											parse->dijkstraEdgeId,
+											parse->dijkstraHeuristic,
 											parse->shortestpathSource,
 											parse->shortestpathTarget,
-											parse->dijkstraLimit);
+											parse->dijkstraLimit,
+											parse->dijkstraTopK);
 	}
 
 	/*
@@ -1822,6 +1831,14 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 	final_rel->useridiscurrent = current_rel->useridiscurrent;
 	final_rel->fdwroutine = current_rel->fdwroutine;
 
+	/*
+	 * The fan-out of a VLE hop depends only on its edge labels, so estimate
+	 * it once here instead of for each of the paths below.
+	 */
+	if (parse->graph.vle_rel)
+		vle_fanout = estimate_graph_vle_fanout(root,
+											   (CypherRel *) parse->graph.vle_rel);
+
 	/*
 	 * Generate paths for the final_rel.  Insert all surviving paths, with
 	 * LockRows, Limit, and/or ModifyTable steps added if needed.
@@ -1866,7 +1883,8 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 			path = (Path *) create_graph_vle_path(root,
 												  final_rel,
 												  path,
-												  (CypherRel *) parse->graph.vle_rel);
+												  (CypherRel *) parse->graph.vle_rel,
+												  vle_fanout);
 		}
 		else if (parse->commandType == CMD_GRAPHWRITE)
 		{
@@ -4855,8 +4873,8 @@ create_ordered_paths(PlannerInfo *root,
 static RelOptInfo *
 create_dijkstra_paths(PlannerInfo *root, RelOptInfo *input_rel,
 					  PathTarget *path_target, int weight, bool weight_out,
-					  Node *end_id, Node *edge_id, Node *source,
-					  Node *target, Node *limit)
+					  Node *end_id, Node *edge_id, Node *heuristic,
+					  Node *source, Node *target, Node *limit, bool topk)
 {
 	RelOptInfo *dijkstra_rel;
 	ListCell   *lc;
@@ -4879,8 +4897,8 @@ create_dijkstra_paths(PlannerInfo *root, RelOptInfo *input_rel,
 
 		path = (Path *) create_dijkstra_path(root, dijkstra_rel, path,
 											 path_target, weight, weight_out,
-											 end_id, edge_id, source, target,
-											 limit);
+											 end_id, edge_id, heuristic,
+											 source, target, limit, topk);
 		add_path(dijkstra_rel, path);
 	}
 
@@ -5029,6 +5047,16 @@ make_dijkstra_input_target(PlannerInfo *root, PathTarget *final_target)
 		add_new_column_to_pathtarget(input_target, (Expr *) parse->shortestpathEndIdLeft);
 	if (parse->dijkstraEdgeId != NULL)
 		add_new_column_to_pathtarget(input_target, (Expr *) parse->dijkstraEdgeId);
+	if (parse->dijkstraHeuristic != NULL)
+	{
+		List	   *heuristic_vars;
+
+		/* Dijkstra evaluates the heuristic itself, once for each vertex */
+		heuristic_vars = pull_var_clause(parse->dijkstraHeuristic,
+										 PVC_INCLUDE_PLACEHOLDERS);
+		add_new_columns_to_pathtarget(input_target, heuristic_vars);
+		list_free(heuristic_vars);
+	}
 	if (parse->shortestpathEndIdRight != NULL)
 		add_new_column_to_pathtarget(input_target, (Expr *) parse->shortestpathEndIdRight);
 	if (parse->shortestpathTableOidLeft != NULL)
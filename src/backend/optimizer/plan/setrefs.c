@@ -1577,6 +1577,10 @@ set_append_references(PlannerInfo *root,
 
 	aplan->apprelids = offset_relid_set(aplan->apprelids, rtoffset);
 
+	if (aplan->graph_id_expr)
+		aplan->graph_id_expr = (Expr *)
+			fix_scan_expr(root, (Node *) aplan->graph_id_expr, rtoffset, 1);
+
 	if (aplan->part_prune_info)
 	{
 		foreach(l, aplan->part_prune_info->prune_infos)
@@ -3241,4 +3245,7 @@ set_dijkstra_references(PlannerInfo *root, Plan *plan, int rtoffset)
 	dijkstra->limit = fix_upper_expr(root, dijkstra->limit, subplan_itlist,
 									 OUTER_VAR, rtoffset,
 									 NUM_EXEC_QUAL(plan));
+	dijkstra->heuristic = fix_upper_expr(root, dijkstra->heuristic,
+										 subplan_itlist, OUTER_VAR, rtoffset,
+										 NUM_EXEC_QUAL(plan));
 }
@@ -2557,6 +2557,9 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			{
 				ListCell   *l;
 
+				finalize_primnode((Node *) ((Append *) plan)->graph_id_expr,
+								  &context);
+
 				foreach(l, ((Append *) plan)->appendplans)
 				{
 					context.paramids =
@@ -2826,6 +2829,7 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			finalize_primnode(((Dijkstra *) plan)->source, &context);
 			finalize_primnode(((Dijkstra *) plan)->target, &context);
 			finalize_primnode(((Dijkstra *) plan)->limit, &context);
+			finalize_primnode(((Dijkstra *) plan)->heuristic, &context);
 			break;
 
 		case T_GraphVLE:
@@ -1106,6 +1106,8 @@ pull_up_simple_subquery(PlannerInfo *root, Node *jtnode, RangeTblEntry *rte,
 												   &rvcontext);
 		parse->dijkstraEdgeId = pullup_replace_vars(parse->dijkstraEdgeId,
 													&rvcontext);
+		parse->dijkstraHeuristic = pullup_replace_vars(parse->dijkstraHeuristic,
+													   &rvcontext);
 		parse->dijkstraLimit = pullup_replace_vars(parse->dijkstraLimit,
 												   &rvcontext);
 		parse->shortestpathEndIdLeft = pullup_replace_vars(parse->shortestpathEndIdLeft,
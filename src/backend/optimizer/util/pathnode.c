@@ -27,6 +27,7 @@
 #include "optimizer/optimizer.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/plancat.h"
 #include "optimizer/planmain.h"
 #include "optimizer/prep.h"
 #include "optimizer/restrictinfo.h"
@@ -1265,9 +1266,11 @@ create_append_path(PlannerInfo *root,
 	 * such quals will be available for make_partition_pruneinfo().  (This
 	 * would not work right for a non-baserel, ie a scan on a non-leaf child
 	 * partition, and it's not necessary anyway in that case.  Must skip it if
-	 * we don't have "root", too.)
+	 * we don't have "root", too.)  The same goes for a graph label and its
+	 * children, whose quals on the id choose the child to scan.
 	 */
-	if (root && rel->reloptkind == RELOPT_BASEREL && IS_PARTITIONED_REL(rel))
+	if (root && rel->reloptkind == RELOPT_BASEREL &&
+		(IS_PARTITIONED_REL(rel) || is_graph_label_appendrel(root, rel)))
 		pathnode->path.param_info = get_baserel_parampathinfo(root,
 															  rel,
 															  required_outer);
@@ -1343,8 +1346,36 @@ create_append_path(PlannerInfo *root,
 		pathnode->path.pathkeys = child->pathkeys;
 	}
 	else
+	{
 		cost_append(pathnode);
 
+		/*
+		 * Each child of a graph label estimates the quals on the id as if the
+		 * outer row could be in it.  Take the rows from the param info, which
+		 * estimates them against the whole label tree, so that every path of
+		 * the same parameterization has the same rows.
+		 */
+		if (root != NULL && pathnode->path.param_info != NULL &&
+			is_graph_label_appendrel(root, rel))
+		{
+			ParamPathInfo *ppi = pathnode->path.param_info;
+			int			nchildren = list_length(pathnode->subpaths);
+
+			pathnode->path.rows = ppi->ppi_rows;
+
+			/*
+			 * A scan by the id of an outer row reads only the child that the
+			 * id belongs to (see create_append_plan()), so charge for an
+			 * average child rather than for all of them.
+			 */
+			if (!parallel_aware && pathkeys == NIL &&
+				find_graph_label_id_expr(root, rel, ppi->ppi_clauses) != NULL)
+				pathnode->path.total_cost = pathnode->path.startup_cost +
+					(pathnode->path.total_cost - pathnode->path.startup_cost) /
+					nchildren;
+		}
+	}
+
 	/* If the caller provided a row estimate, override the computed value. */
 	if (rows >= 0)
 		pathnode->path.rows = rows;
@@ -3863,7 +3894,7 @@ create_modifygraph_path(PlannerInfo *root, RelOptInfo *rel,
 GraphVLEPath *
 create_graph_vle_path(PlannerInfo *root,
 					  RelOptInfo *rel, Path *subpath,
-					  CypherRel *vle_rel)
+					  CypherRel *vle_rel, double fanout)
 {
 	GraphVLEPath *pathnode = makeNode(GraphVLEPath);
 
@@ -3874,13 +3905,13 @@ create_graph_vle_path(PlannerInfo *root,
 	pathnode->path.parallel_aware = false;
 	pathnode->path.parallel_safe = false;
 	pathnode->path.parallel_workers = 0;
-	pathnode->path.rows = subpath->rows;
-	pathnode->path.startup_cost = subpath->startup_cost;
-	pathnode->path.total_cost = subpath->total_cost;
 	pathnode->path.pathkeys = NIL;
 
 	pathnode->subpath = subpath;
 	pathnode->vle_rel = vle_rel;
+	pathnode->bfs = graph_vle_prefers_bfs(vle_rel, fanout);
+
+	cost_graph_vle(pathnode, fanout);
 
 	return pathnode;
 }
@@ -4427,8 +4458,8 @@ create_dijkstra_path(PlannerInfo *root,
 					 Path *subpath,
 					 PathTarget *path_target,
 					 int weight, bool weight_out,
-					 Node *end_id, Node *edge_id,
-					 Node *source, Node *target, Node *limit)
+					 Node *end_id, Node *edge_id, Node *heuristic,
+					 Node *source, Node *target, Node *limit, bool topk)
 {
 	DijkstraPath *pathnode = makeNode(DijkstraPath);
 
@@ -4448,9 +4479,11 @@ create_dijkstra_path(PlannerInfo *root,
 	pathnode->weight_out = weight_out;
 	pathnode->end_id = end_id;
 	pathnode->edge_id = edge_id;
+	pathnode->heuristic = heuristic;
 	pathnode->source = source;
 	pathnode->target = target;
 	pathnode->limit = limit;
+	pathnode->topk = topk;
 
 	cost_dijkstra(&pathnode->path, subpath->startup_cost,
 				  subpath->total_cost, subpath->rows,
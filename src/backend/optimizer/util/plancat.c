@@ -25,9 +25,11 @@
 #include "access/tableam.h"
 #include "access/transam.h"
 #include "access/xlog.h"
+#include "catalog/ag_graphmeta.h"
 #include "catalog/catalog.h"
 #include "catalog/heap.h"
 #include "catalog/pg_am.h"
+#include "catalog/pg_operator.h"
 #include "catalog/pg_proc.h"
 #include "catalog/pg_statistic_ext.h"
 #include "foreign/fdwapi.h"
@@ -47,7 +49,10 @@
 #include "statistics/statistics.h"
 #include "storage/bufmgr.h"
 #include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/graph.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/partcache.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
@@ -1632,6 +1637,147 @@ relation_excluded_by_constraints(PlannerInfo *root,
 	return false;
 }
 
+/*
+ * get_graph_id_clause_arg
+ *
+ * If `rinfo` is `id = expr`, where `id` is the id column of `rel` and `expr`
+ * does not reference `rel`, returns `expr`.
+ */
+static Expr *
+get_graph_id_clause_arg(RelOptInfo *rel, RestrictInfo *rinfo)
+{
+	OpExpr	   *opexpr = (OpExpr *) rinfo->clause;
+	Node	   *leftop;
+	Node	   *rightop;
+	Var		   *var;
+	Expr	   *arg;
+
+	if (!is_opclause(opexpr) || opexpr->opno != OID_GRAPHID_EQ_OP ||
+		list_length(opexpr->args) != 2)
+		return NULL;
+
+	leftop = linitial(opexpr->args);
+	rightop = lsecond(opexpr->args);
+
+	if (bms_equal(rinfo->left_relids, rel->relids) &&
+		!bms_overlap(rinfo->right_relids, rel->relids))
+	{
+		var = (Var *) leftop;
+		arg = (Expr *) rightop;
+	}
+	else if (bms_equal(rinfo->right_relids, rel->relids) &&
+			 !bms_overlap(rinfo->left_relids, rel->relids))
+	{
+		var = (Var *) rightop;
+		arg = (Expr *) leftop;
+	}
+	else
+	{
+		return NULL;
+	}
+
+	/* vertex and edge labels alike have the id as their first column */
+	StaticAssertStmt(Anum_table_vertex_id == Anum_table_edge_id,
+					 "id columns of vertices and edges differ");
+	if (!IsA(var, Var) || var->varno != rel->relid ||
+		var->varattno != Anum_table_vertex_id)
+		return NULL;
+
+	return arg;
+}
+
+/*
+ * graph_label_excluded_by_id
+ *
+ * Detect whether a child of a graph label cannot hold the rows the
+ * restriction clauses ask for, because one of them is `id = constant` and the
+ * label of the constant is not the label of the child. Every graphid carries
+ * the label of the vertex or edge it identifies.
+ */
+bool
+graph_label_excluded_by_id(PlannerInfo *root, RelOptInfo *rel,
+						   RangeTblEntry *rte)
+{
+	uint16		labid;
+	ListCell   *lc;
+
+	if (!enable_partition_pruning ||
+		rel->reloptkind != RELOPT_OTHER_MEMBER_REL ||
+		rte->rtekind != RTE_RELATION || rel->baserestrictinfo == NIL)
+		return false;
+
+	labid = get_relid_labid(rte->relid);
+	if (labid == InvalidLabid)
+		return false;
+
+	foreach(lc, rel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		Const	   *arg;
+
+		arg = (Const *) get_graph_id_clause_arg(rel, rinfo);
+		if (arg == NULL || !IsA(arg, Const) || arg->constisnull)
+			continue;
+
+		if (GraphidGetLabid(DatumGetGraphid(arg->constvalue)) != labid)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * is_graph_label_appendrel
+ *
+ * Is `rel` a graph label scanned along with its child labels?
+ */
+bool
+is_graph_label_appendrel(PlannerInfo *root, RelOptInfo *rel)
+{
+	RangeTblEntry *rte;
+
+	if (rel->reloptkind != RELOPT_BASEREL || rel->rtekind != RTE_RELATION)
+		return false;
+
+	rte = planner_rt_fetch(rel->relid, root);
+	return rte->inh && get_relid_labid(rte->relid) != InvalidLabid;
+}
+
+/*
+ * find_graph_label_id_expr
+ *
+ * If `rel` is a graph label scanned along with its child labels and
+ * `clauses` include `id = expr`, where `expr` is neither a constant nor
+ * volatile and does not reference `rel`, returns `expr`. The label of the
+ * value of `expr` then tells the only child that has to be scanned; see
+ * create_append_plan().
+ */
+Expr *
+find_graph_label_id_expr(PlannerInfo *root, RelOptInfo *rel, List *clauses)
+{
+	ListCell   *lc;
+
+	if (!enable_partition_pruning || clauses == NIL ||
+		!is_graph_label_appendrel(root, rel))
+		return NULL;
+
+	foreach(lc, clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		Expr	   *arg;
+
+		arg = get_graph_id_clause_arg(rel, rinfo);
+		if (arg == NULL || IsA(arg, Const) ||
+			contain_volatile_functions((Node *) arg) ||
+			contain_subplans((Node *) arg))
+			continue;
+
+		return arg;
+	}
+
+	return NULL;
+}
+
 
 /*
  * build_physical_tlist
@@ -2424,3 +2570,104 @@ set_baserel_partition_constraint(Relation relation, RelOptInfo *rel)
 		rel->partition_qual = partconstr;
 	}
 }
+
+/*
+ * get_graphmeta_list
+ *
+ * Returns the ag_graphmeta entries of the given graph, i.e. the number of
+ * edges per (edge label, start label, end label), as a list of palloc'd
+ * FormData_ag_graphmeta.  The list is empty unless the graph metadata has
+ * been gathered (see auto_gather_graphmeta and regather_graphmeta()).  The
+ * edge counts that are not folded into ag_graphmeta yet are included.
+ */
+List *
+get_graphmeta_list(Oid graphoid)
+{
+	List	   *result = NIL;
+	Relation	rel;
+	ScanKeyData key;
+	SysScanDesc scan;
+	HeapTuple	tuple;
+	ListCell   *lc;
+
+	ScanKeyInit(&key,
+				Anum_ag_graphmeta_graph,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(graphoid));
+
+	rel = table_open(GraphMetaRelationId, AccessShareLock);
+	scan = systable_beginscan(rel, GraphMetaFullIndexId, true, NULL, 1, &key);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		Form_ag_graphmeta meta = palloc(sizeof(FormData_ag_graphmeta));
+
+		memcpy(meta, GETSTRUCT(tuple), sizeof(FormData_ag_graphmeta));
+		result = lappend(result, meta);
+	}
+
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	foreach(lc, agstat_get_pending_graphmeta(graphoid))
+	{
+		AgStat_GraphMeta *pending = (AgStat_GraphMeta *) lfirst(lc);
+		Form_ag_graphmeta meta = NULL;
+		ListCell   *mlc;
+
+		foreach(mlc, result)
+		{
+			meta = (Form_ag_graphmeta) lfirst(mlc);
+			if (meta->edge == pending->key.edge &&
+				meta->start == pending->key.start &&
+				meta->end == pending->key.end)
+				break;
+		}
+		if (mlc == NULL)
+		{
+			meta = palloc0(sizeof(FormData_ag_graphmeta));
+			meta->graph = graphoid;
+			meta->edge = pending->key.edge;
+			meta->start = pending->key.start;
+			meta->end = pending->key.end;
+			result = lappend(result, meta);
+		}
+		meta->edgecount += pending->edges_inserted - pending->edges_deleted;
+	}
+
+	foreach(lc, result)
+	{
+		Form_ag_graphmeta meta = (Form_ag_graphmeta) lfirst(lc);
+
+		if (meta->edgecount <= 0)
+			result = foreach_delete_current(result, lc);
+	}
+
+	return result;
+}
+
+/*
+ * get_planner_graphmeta_list
+ *
+ * Like get_graphmeta_list(), but ag_graphmeta is read only once per planner
+ * invocation, since the join selectivity of every vertex-edge join clause
+ * looks it up.  The entries are kept in PlannerGlobal, in its own memory
+ * context so that they survive GEQO's per-join temporary contexts.
+ */
+List *
+get_planner_graphmeta_list(PlannerInfo *root, Oid graphoid)
+{
+	PlannerGlobal *glob = root->glob;
+
+	if (glob->graphmetaGraph != graphoid)
+	{
+		MemoryContext oldcxt;
+
+		oldcxt = MemoryContextSwitchTo(GetMemoryChunkContext(glob));
+		glob->graphmetaList = get_graphmeta_list(graphoid);
+		glob->graphmetaGraph = graphoid;
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	return glob->graphmetaList;
+}
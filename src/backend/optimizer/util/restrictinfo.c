@@ -137,6 +137,8 @@ make_restrictinfo_internal(PlannerInfo *root,
 	else
 		restrictinfo->leakproof = false;	/* really, "don't know" */
 
+	restrictinfo->join_redundant = false;	/* may get set by caller */
+
 	/*
 	 * Mark volatility as unknown.  The contain_volatile_functions function
 	 * will determine if there are any volatile functions when called for the
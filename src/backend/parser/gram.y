@@ -662,6 +662,7 @@ static Node *wrapCypherWithSelect(Node *stmt);
 %type <list>	cypher_pattern cypher_anon_pattern
 				cypher_path cypher_path_chain
 				cypher_types cypher_types_opt
+				cypher_dijkstra_heuristic_opt
 %type <node>	cypher_pattern_part cypher_pattern_var cypher_anon_pattern_part
 				cypher_shortestpath cypher_dijkstra
 				cypher_node cypher_rel
@@ -669,7 +670,7 @@ static Node *wrapCypherWithSelect(Node *stmt);
 				cypher_varlen_opt cypher_range_opt cypher_range_idx
 				cypher_range_idx_opt cypher_prop_map_opt
 %type <str>		cypher_pattern_varname cypher_labelname
-%type <boolean>	cypher_rel_left cypher_rel_right
+%type <boolean>	cypher_rel_left cypher_rel_right cypher_dijkstra_topk_opt
 
 %type <node>	cypher_return cypher_with
 				cypher_skip_opt cypher_limit_opt cypher_where cypher_where_opt
@@ -18546,7 +18547,8 @@ cypher_shortestpath:
 		;
 
 cypher_dijkstra:
-			DIJKSTRA '(' cypher_path_chain ',' cypher_expr ')'
+			DIJKSTRA '(' cypher_path_chain ',' cypher_expr
+			cypher_dijkstra_heuristic_opt ')'
 				{
 					CypherPath *n;
 
@@ -18561,10 +18563,15 @@ cypher_dijkstra:
 					n->chain = $3;
 					n->weight = $5;
 					n->limit = makeIntConst(1, -1);
+					if ($6 != NIL)
+					{
+						n->heuristic_var = linitial($6);
+						n->heuristic = lsecond($6);
+					}
 					$$ = (Node *) n;
 				}
 			| DIJKSTRA '(' cypher_path_chain ','
-			cypher_expr ',' cypher_expr ')'
+			cypher_expr ',' cypher_expr cypher_dijkstra_heuristic_opt ')'
 				{
 					CypherPath *n;
 
@@ -18580,10 +18587,16 @@ cypher_dijkstra:
 					n->weight = $5;
 					n->qual = $7;
 					n->limit = makeIntConst(1, -1);
+					if ($8 != NIL)
+					{
+						n->heuristic_var = linitial($8);
+						n->heuristic = lsecond($8);
+					}
 					$$ = (Node *) n;
 				}
 			| DIJKSTRA '(' cypher_path_chain ','
-			cypher_expr ',' LIMIT cypher_expr ')'
+			cypher_expr ',' cypher_dijkstra_topk_opt LIMIT cypher_expr
+			cypher_dijkstra_heuristic_opt ')'
 				{
 					CypherPath *n;
 
@@ -18597,11 +18610,18 @@ cypher_dijkstra:
 					n->kind = CPATH_DIJKSTRA;
 					n->chain = $3;
 					n->weight = $5;
-					n->limit = $8;
+					n->limit = $9;
+					n->topk = $7;
+					if ($10 != NIL)
+					{
+						n->heuristic_var = linitial($10);
+						n->heuristic = lsecond($10);
+					}
 					$$ = (Node *) n;
 				}
 			| DIJKSTRA '(' cypher_path_chain ','
-			cypher_expr ',' cypher_expr ',' LIMIT cypher_expr ')'
+			cypher_expr ',' cypher_expr ',' cypher_dijkstra_topk_opt
+			LIMIT cypher_expr cypher_dijkstra_heuristic_opt ')'
 				{
 					CypherPath *n;
 
@@ -18616,11 +18636,29 @@ cypher_dijkstra:
 					n->chain = $3;
 					n->weight = $5;
 					n->qual = $7;
-					n->limit = $10;
+					n->limit = $11;
+					n->topk = $9;
+					if ($12 != NIL)
+					{
+						n->heuristic_var = linitial($12);
+						n->heuristic = lsecond($12);
+					}
 					$$ = (Node *) n;
 				}
 		;
 
+cypher_dijkstra_heuristic_opt:
+			',' USING cypher_var EQUALS_GREATER cypher_expr
+				{ $$ = list_make2($3, $5); }
+			| /* EMPTY */
+				{ $$ = NIL; }
+		;
+
+cypher_dijkstra_topk_opt:
+			ALL								{ $$ = true; }
+			| /* EMPTY */					{ $$ = false; }
+		;
+
 cypher_path_chain:
 			cypher_node
 					{ $$ = list_make1($1); }
@@ -149,6 +149,11 @@ static ParseNamespaceItem *transformMatchOptional(ParseState *pstate,
 
 /* MATCH - preprocessing */
 static bool hasPropConstr(List *pattern);
+static void pushdownVLEPropConds(List *pattern, Node *where);
+static CypherListComp *getAllListComp(Node *expr);
+static CypherRel *findVLERel(List *pattern, Node *list);
+static void addVLEPropConds(CypherRel *crel, char *varname, Node *cond);
+static char *getPropRefKey(Node *expr, char *varname);
 static List *getFindPaths(List *pattern);
 static void appendFindPathsResult(ParseState *pstate, List *fplist,
 								  List **targetList);
@@ -204,6 +209,8 @@ static Node *addQualNodeIn(ParseState *pstate, Node *qual, Node *vertex,
 						   bool vertexIsNSItem, CypherRel *crel,
 						   ParseNamespaceItem *edge,
 						   bool prev);
+static Node *addQualUndirectedEdge(ParseState *pstate, Node *qual, Node *vid,
+								   CypherRel *crel, ParseNamespaceItem *edge);
 static char *getEdgeColname(CypherRel *crel, bool prev);
 static bool isFutureVertexExpr(Node *vertex);
 static void setFutureVertexExprId(ParseState *pstate, Node *vertex,
@@ -259,9 +266,19 @@ static Relation openTargetLabel(ParseState *pstate, char *labname);
 /* SET/REMOVE */
 static List *transformSetPropList(ParseState *pstate, bool is_remove,
 								  CSetKind kind, List *items);
-static GraphSetProp *transformSetProp(ParseState *pstate, CypherSetProp *sp,
-									  bool is_remove,
-									  CSetKind kind);
+static Node *transformSetPropExpr(ParseState *pstate, CypherSetProp *sp,
+								  Node **elem, List **pathelems,
+								  char **varname);
+static GraphSetProp *makeSetProp(ParseState *pstate, CypherSetProp *sp,
+								 bool is_remove, CSetKind kind, Node *elem,
+								 List *pathelems, char *varname, Node *expr);
+static GraphSetProp *makeSetKeysProp(ParseState *pstate, CSetKind kind,
+									 Node *elem, char *varname, List *keys,
+									 List *vals);
+static GraphSetProp *makeGraphSetProp(ParseState *pstate, CSetKind kind,
+									  Node *elem, char *varname,
+									  Node *prop_map);
+static bool refers_to_elem_walker(Node *node, Var *elem);
 static bool resolve_var_from_targetlist_walker(Node *node,
 											   resolve_var_from_targetlist_context *ctx);
 static void substitute_set_props_as_targetentry(ParseState *pstate,
@@ -671,6 +688,8 @@ transformCypherMatchClause(ParseState *pstate, CypherClause *clause)
 		{
 			int			flags = (pstate->p_is_optional_match ? FVR_IGNORE_NULLABLE : 0);
 
+			pushdownVLEPropConds(detail->pattern, detail->where);
+
 			pstate->p_is_match_quals = true;
 			nsitem = transformClause(pstate, (Node *) clause);
 
@@ -1283,6 +1302,243 @@ hasPropConstr(List *pattern)
 	return false;
 }
 
+/*
+ * Copies `x.key = <constant>` conditions of `all(x IN r WHERE ...)` at the top
+ * level of `where` into the property map of `r`, if `r` is a variable length
+ * relationship of `pattern`. GraphVLE then follows only the edges that satisfy
+ * them, and can use a GIN index on the properties of the edges to skip the
+ * others. `where` is kept as it is; the property map only prunes the paths
+ * that `where` would reject anyway.
+ */
+static void
+pushdownVLEPropConds(List *pattern, Node *where)
+{
+	List	   *conds;
+	ListCell   *lc;
+
+	if (where == NULL)
+		return;
+
+	if (IsA(where, BoolExpr) && ((BoolExpr *) where)->boolop == AND_EXPR)
+		conds = ((BoolExpr *) where)->args;
+	else
+		conds = list_make1(where);
+
+	foreach(lc, conds)
+	{
+		CypherListComp *clc;
+		CypherRel  *crel;
+
+		clc = getAllListComp(lfirst(lc));
+		if (clc == NULL)
+			continue;
+
+		crel = findVLERel(pattern, clc->list);
+		if (crel == NULL)
+			continue;
+
+		addVLEPropConds(crel, clc->varname, clc->cond);
+	}
+}
+
+/*
+ * Returns the list comprehension of `expr` if it is `all(x IN list WHERE
+ * cond)`, which is `length([x IN list WHERE cond]) = length(list)`.
+ */
+static CypherListComp *
+getAllListComp(Node *expr)
+{
+	A_Expr	   *a;
+	FuncCall   *lfunc;
+	FuncCall   *rfunc;
+	CypherListComp *clc;
+
+	if (!IsA(expr, A_Expr))
+		return NULL;
+	a = (A_Expr *) expr;
+	if (a->kind != AEXPR_OP || list_length(a->name) != 1 ||
+		strcmp(strVal(linitial(a->name)), "=") != 0)
+		return NULL;
+
+	if (!IsA(a->lexpr, FuncCall) || !IsA(a->rexpr, FuncCall))
+		return NULL;
+	lfunc = (FuncCall *) a->lexpr;
+	rfunc = (FuncCall *) a->rexpr;
+	if (!equal(lfunc->funcname, SystemFuncName("length")) ||
+		!equal(rfunc->funcname, SystemFuncName("length")) ||
+		list_length(lfunc->args) != 1 || list_length(rfunc->args) != 1)
+		return NULL;
+
+	if (!IsA(linitial(lfunc->args), CypherListComp))
+		return NULL;
+	clc = linitial(lfunc->args);
+	if (clc->elem != NULL || clc->cond == NULL ||
+		!equal(clc->list, linitial(rfunc->args)))
+		return NULL;
+
+	return clc;
+}
+
+/*
+ * Returns the variable length relationship of `pattern` whose variable is
+ * `list`, if its property map can take more properties.
+ */
+static CypherRel *
+findVLERel(List *pattern, Node *list)
+{
+	char	   *varname;
+	ListCell   *lp;
+
+	if (!IsA(list, ColumnRef) || list_length(((ColumnRef *) list)->fields) != 1)
+		return NULL;
+	if (!IsA(linitial(((ColumnRef *) list)->fields), String))
+		return NULL;
+	varname = strVal(linitial(((ColumnRef *) list)->fields));
+
+	foreach(lp, pattern)
+	{
+		CypherPath *p = lfirst(lp);
+		ListCell   *le;
+
+		if (p->kind != CPATH_NORMAL)
+			continue;
+
+		foreach(le, p->chain)
+		{
+			CypherRel  *crel = lfirst(le);
+			char	   *relname;
+
+			if (!IsA(crel, CypherRel) || crel->varlen == NULL)
+				continue;
+
+			relname = getCypherName(crel->variable);
+			if (relname == NULL || strcmp(relname, varname) != 0)
+				continue;
+
+			if (crel->prop_map != NULL && !IsA(crel->prop_map, CypherMapExpr))
+				return NULL;
+
+			return crel;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Adds `key: <constant>` to the property map of `crel` for each `varname.key
+ * = <constant>` at the top level of `cond`, unless the map already has `key`.
+ */
+static void
+addVLEPropConds(CypherRel *crel, char *varname, Node *cond)
+{
+	List	   *conds;
+	ListCell   *lc;
+
+	if (IsA(cond, BoolExpr) && ((BoolExpr *) cond)->boolop == AND_EXPR)
+		conds = ((BoolExpr *) cond)->args;
+	else
+		conds = list_make1(cond);
+
+	foreach(lc, conds)
+	{
+		A_Expr	   *a = lfirst(lc);
+		char	   *key;
+		Node	   *val;
+		CypherMapExpr *map;
+		ListCell   *lk;
+		bool		found = false;
+
+		if (!IsA(a, A_Expr) || a->kind != AEXPR_OP ||
+			list_length(a->name) != 1 ||
+			strcmp(strVal(linitial(a->name)), "=") != 0)
+			continue;
+
+		key = getPropRefKey(a->lexpr, varname);
+		val = a->rexpr;
+		if (key == NULL)
+		{
+			key = getPropRefKey(a->rexpr, varname);
+			val = a->lexpr;
+		}
+		if (key == NULL)
+			continue;
+
+		/* only scalars, for which containment is equality */
+		if (!IsA(val, A_Const))
+			continue;
+		if (!IsA(&((A_Const *) val)->val, Integer) &&
+			!IsA(&((A_Const *) val)->val, Float) &&
+			!IsA(&((A_Const *) val)->val, String))
+			continue;
+
+		map = (CypherMapExpr *) crel->prop_map;
+		if (map == NULL)
+		{
+			map = makeNode(CypherMapExpr);
+			map->keyvals = NIL;
+			map->location = -1;
+			crel->prop_map = (Node *) map;
+		}
+
+		for (lk = list_head(map->keyvals); lk != NULL;
+			 lk = lnext(map->keyvals, lnext(map->keyvals, lk)))
+		{
+			if (strcmp(strVal(lfirst(lk)), key) == 0)
+			{
+				found = true;
+				break;
+			}
+		}
+		if (found)
+			continue;
+
+		map->keyvals = lappend(map->keyvals, makeString(pstrdup(key)));
+		map->keyvals = lappend(map->keyvals, copyObject(val));
+	}
+}
+
+/*
+ * Returns `key` if `expr` is `varname.key`.
+ */
+static char *
+getPropRefKey(Node *expr, char *varname)
+{
+	Node	   *var;
+	Node	   *key;
+
+	if (IsA(expr, ColumnRef))
+	{
+		ColumnRef  *cref = (ColumnRef *) expr;
+
+		if (list_length(cref->fields) != 2)
+			return NULL;
+		var = linitial(cref->fields);
+		key = lsecond(cref->fields);
+	}
+	else if (IsA(expr, A_Indirection))
+	{
+		A_Indirection *indir = (A_Indirection *) expr;
+		ColumnRef  *cref = (ColumnRef *) indir->arg;
+
+		if (!IsA(cref, ColumnRef) || list_length(cref->fields) != 1 ||
+			list_length(indir->indirection) != 1)
+			return NULL;
+		var = linitial(cref->fields);
+		key = linitial(indir->indirection);
+	}
+	else
+	{
+		return NULL;
+	}
+
+	if (!IsA(var, String) || !IsA(key, String) ||
+		strcmp(strVal(var), varname) != 0)
+		return NULL;
+
+	return strVal(key);
+}
+
 static List *
 getFindPaths(List *pattern)
 {
@@ -2090,11 +2346,12 @@ addEdgeUnion(ParseState *pstate, char *edge_label, bool only, int location,
 }
 
 /*
- * SELECT id, start, "end", properties, ctid, start AS _start, "end" AS _end
- * FROM `get_graph_path()`.`edge_label`
- * UNION ALL
- * SELECT id, start, "end", properties, ctid, "end" AS _start, start AS _end
- * FROM `get_graph_path()`.`edge_label`
+ * SELECT id, start, "end", properties, ctid, _start, _end
+ * FROM `get_graph_path()`.`edge_label`,
+ *      LATERAL (VALUES (start, "end"), ("end", start)) AS _d(_start, _end)
+ *
+ * Both orientations of each edge are emitted from a single scan of the edge
+ * label instead of a UNION ALL of two scans of it.
  */
 static Node *
 genEdgeUnion(char *edge_label, bool only, int location)
@@ -2105,9 +2362,9 @@ genEdgeUnion(char *edge_label, bool only, int location)
 	ResTarget  *prop_map;
 	ResTarget  *tid;
 	RangeVar   *r;
-	SelectStmt *lsel;
-	SelectStmt *rsel;
-	SelectStmt *u;
+	SelectStmt *values;
+	RangeSubselect *dir;
+	SelectStmt *sel;
 
 	id = makeSimpleResTarget(AG_ELEM_LOCAL_ID, NULL);
 	start = makeSimpleResTarget(AG_START_ID, NULL);
@@ -2118,33 +2375,29 @@ genEdgeUnion(char *edge_label, bool only, int location)
 	r = makeRangeVar(get_graph_path(true), edge_label, location);
 	r->inh = !only;
 
-	lsel = makeNode(SelectStmt);
-	lsel->targetList = list_make5(id, start, end, prop_map, tid);
-	lsel->fromClause = list_make1(r);
-
-	rsel = copyObject(lsel);
-
-	lsel->targetList = lappend(lsel->targetList,
-							   makeSimpleResTarget(AG_START_ID,
-												   EDGE_UNION_START_ID));
-	lsel->targetList = lappend(lsel->targetList,
-							   makeSimpleResTarget(AG_END_ID,
-												   EDGE_UNION_END_ID));
+	values = makeNode(SelectStmt);
+	values->valuesLists =
+		list_make2(list_make2(makeColumnRef(genQualifiedName(NULL, AG_START_ID)),
+							  makeColumnRef(genQualifiedName(NULL, AG_END_ID))),
+				   list_make2(makeColumnRef(genQualifiedName(NULL, AG_END_ID)),
+							  makeColumnRef(genQualifiedName(NULL, AG_START_ID))));
 
-	rsel->targetList = lappend(rsel->targetList,
-							   makeSimpleResTarget(AG_END_ID,
-												   EDGE_UNION_START_ID));
-	rsel->targetList = lappend(rsel->targetList,
-							   makeSimpleResTarget(AG_START_ID,
-												   EDGE_UNION_END_ID));
+	dir = makeNode(RangeSubselect);
+	dir->lateral = true;
+	dir->subquery = (Node *) values;
+	dir->alias = makeAliasOptUnique(NULL);
+	dir->alias->colnames = list_make2(makeString(EDGE_UNION_START_ID),
+									  makeString(EDGE_UNION_END_ID));
 
-	u = makeNode(SelectStmt);
-	u->op = SETOP_UNION;
-	u->all = true;
-	u->larg = lsel;
-	u->rarg = rsel;
+	sel = makeNode(SelectStmt);
+	sel->targetList = list_make5(id, start, end, prop_map, tid);
+	sel->targetList = lappend(sel->targetList,
+							  makeSimpleResTarget(EDGE_UNION_START_ID, NULL));
+	sel->targetList = lappend(sel->targetList,
+							  makeSimpleResTarget(EDGE_UNION_END_ID, NULL));
+	sel->fromClause = list_make2(r, dir);
 
-	return (Node *) u;
+	return (Node *) sel;
 }
 
 static void
@@ -2803,6 +3056,7 @@ addQualRelPath(ParseState *pstate, Node *qual, CypherRel *prev_crel,
 	qual = qualAndExpr(qual,
 					   (Node *) make_op(pstate, list_make1(makeString("=")),
 										prev_vid, vid, pstate->p_last_srf, -1));
+	qual = addQualUndirectedEdge(pstate, qual, prev_vid, crel, edge);
 
 	return qual;
 }
@@ -2850,10 +3104,62 @@ addQualNodeIn(ParseState *pstate, Node *qual, Node *vertex,
 	qual = qualAndExpr(qual,
 					   (Node *) make_op(pstate, list_make1(makeString("=")),
 										id, vid, pstate->p_last_srf, -1));
+	qual = addQualUndirectedEdge(pstate, qual, id, crel, edge);
 
 	return qual;
 }
 
+/*
+ * `vid` = `edge`._start (or _end) implies `vid` = start OR `vid` = "end" on
+ * the edge label itself. Adding it lets the planner look up the edges of a
+ * vertex through the indexes on start and "end" of the edge label. Join size
+ * estimates ignore it (see is_undirected_edge_qual()).
+ */
+static Node *
+addQualUndirectedEdge(ParseState *pstate, Node *qual, Node *vid,
+					  CypherRel *crel, ParseNamespaceItem *edge)
+{
+	Node	   *start;
+	Node	   *end;
+	List	   *args;
+	Node	   *expr;
+	ListCell   *lc;
+
+	if (crel->direction != CYPHER_REL_DIR_NONE || crel->varlen != NULL)
+		return qual;
+
+	start = getColumnVar(pstate, edge, AG_START_ID);
+	end = getColumnVar(pstate, edge, AG_END_ID);
+
+	args = list_make2(make_op(pstate, list_make1(makeString("=")),
+							  copyObject(vid), start, pstate->p_last_srf, -1),
+					  make_op(pstate, list_make1(makeString("=")),
+							  copyObject(vid), end, pstate->p_last_srf, -1));
+	expr = (Node *) makeBoolExpr(OR_EXPR, args, -1);
+
+	/*
+	 * (a)-[]-(a) has it already. Both ends of the edge are `vid` then, so
+	 * replace it with `vid` = start AND `vid` = "end". The planner derives
+	 * start = "end" from them and checks it while scanning the edge label.
+	 */
+	if (IsA(qual, BoolExpr) && ((BoolExpr *) qual)->boolop == AND_EXPR)
+	{
+		BoolExpr   *andexpr = (BoolExpr *) qual;
+
+		foreach(lc, andexpr->args)
+		{
+			if (equal(lfirst(lc), expr))
+			{
+				andexpr->args = foreach_delete_current(andexpr->args, lc);
+				andexpr->args = list_concat(andexpr->args, args);
+				return qual;
+			}
+		}
+	}
+
+	return qualAndExpr(qual, expr);
+}
+
 static char *
 getEdgeColname(CypherRel *crel, bool prev)
 {
@@ -4099,49 +4405,96 @@ openTargetLabel(ParseState *pstate, char *labname)
 	return relation;
 }
 
+/*
+ * SET items that assign top-level keys of the same element one after another
+ * are turned into a single jsonb_set_keys() call so that the property map is
+ * rebuilt once for all of them, instead of once for each item.  An item can
+ * join the preceding ones only if its value does not refer to the element,
+ * since it must see the property map modified by them.
+ */
 static List *
 transformSetPropList(ParseState *pstate, bool is_remove, CSetKind kind,
 					 List *items)
 {
 	List	   *gsplist = NIL;
+	Node	   *keyelem = NULL;
+	char	   *keyvarname = NULL;
+	List	   *keys = NIL;
+	List	   *vals = NIL;
 	ListCell   *li;
 
 	foreach(li, items)
 	{
 		CypherSetProp *sp = lfirst(li);
+		Node	   *elem;
+		List	   *pathelems;
+		char	   *varname;
+		Node	   *expr;
+		bool		setkey;
+
+		expr = transformSetPropExpr(pstate, sp, &elem, &pathelems, &varname);
+		setkey = (!sp->add && list_length(pathelems) == 1 && IsA(elem, Var));
+
+		if (keys != NIL &&
+			(!setkey || strcmp(varname, keyvarname) != 0 ||
+			 refers_to_elem_walker(expr, (Var *) keyelem)))
+		{
+			gsplist = lappend(gsplist,
+							  makeSetKeysProp(pstate, kind, keyelem,
+											  keyvarname, keys, vals));
+			keys = NIL;
+			vals = NIL;
+		}
 
-		gsplist = lappend(gsplist, transformSetProp(pstate, sp, is_remove,
-													kind));
+		if (setkey)
+		{
+			if (IsNullAConst(sp->expr))
+			{
+				if (!allow_null_properties || is_remove)
+					expr = (Node *) makeNullConst(JSONBOID, -1, InvalidOid);
+				else
+					expr = (Node *) makeConst(JSONBOID, -1, InvalidOid, -1,
+											  DirectFunctionCall1(jsonb_in,
+																  CStringGetDatum("null")),
+											  false, false);
+			}
+
+			if (keys == NIL)
+			{
+				keyelem = elem;
+				keyvarname = varname;
+			}
+			keys = lappend(keys, linitial(pathelems));
+			vals = lappend(vals, expr);
+		}
+		else
+		{
+			gsplist = lappend(gsplist,
+							  makeSetProp(pstate, sp, is_remove, kind, elem,
+										  pathelems, varname, expr));
+		}
 	}
 
+	if (keys != NIL)
+		gsplist = lappend(gsplist,
+						  makeSetKeysProp(pstate, kind, keyelem, keyvarname,
+										  keys, vals));
+
 	return gsplist;
 }
 
-static GraphSetProp *
-transformSetProp(ParseState *pstate, CypherSetProp *sp, bool is_remove,
-				 CSetKind kind)
+/*
+ * Transform the element and the assigned value (RHS of the SET clause item)
+ * of a SET clause item.
+ */
+static Node *
+transformSetPropExpr(ParseState *pstate, CypherSetProp *sp, Node **elem,
+					 List **pathelems, char **varname)
 {
-	Node	   *elem;
-	List	   *pathelems;
-	Node	   *path = NULL;
-	char	   *varname;
-	GraphSetProp *gsp;
-	Node	   *prop_map;
 	Node	   *expr;
 	Oid			exprtype;
-	GSPKind		gspkind;
 
-	elem = transformCypherMapForSet(pstate, sp->prop, &pathelems, &varname);
-	if (pathelems != NIL)
-		path = makeArrayExpr(TEXTARRAYOID, TEXTOID, pathelems);
-
-	/*
-	 * Get the original property map of the element.
-	 */
-	prop_map = ParseFuncOrColumn(pstate,
-								 list_make1(makeString(AG_ELEM_PROP_MAP)),
-								 list_make1(elem), pstate->p_last_srf,
-								 NULL, false, -1);
+	*elem = transformCypherMapForSet(pstate, sp->prop, pathelems, varname);
 
 	/*
 	 * Transform the assigned property to get `expr` (RHS of the SET clause
@@ -4185,6 +4538,28 @@ transformSetProp(ParseState *pstate, CypherSetProp *sp, bool is_remove,
 						format_type_be(exprtype)),
 				 parser_errposition(pstate, exprLocation(expr))));
 
+	return expr;
+}
+
+static GraphSetProp *
+makeSetProp(ParseState *pstate, CypherSetProp *sp, bool is_remove,
+			CSetKind kind, Node *elem, List *pathelems, char *varname,
+			Node *expr)
+{
+	Node	   *path = NULL;
+	Node	   *prop_map;
+
+	if (pathelems != NIL)
+		path = makeArrayExpr(TEXTARRAYOID, TEXTOID, pathelems);
+
+	/*
+	 * Get the original property map of the element.
+	 */
+	prop_map = ParseFuncOrColumn(pstate,
+								 list_make1(makeString(AG_ELEM_PROP_MAP)),
+								 list_make1(elem), pstate->p_last_srf,
+								 NULL, false, -1);
+
 	/*
 	 * make the modified property map
 	 */
@@ -4269,6 +4644,41 @@ transformSetProp(ParseState *pstate, CypherSetProp *sp, bool is_remove,
 		}
 	}
 
+	return makeGraphSetProp(pstate, kind, elem, varname, prop_map);
+}
+
+static GraphSetProp *
+makeSetKeysProp(ParseState *pstate, CSetKind kind, Node *elem, char *varname,
+				List *keys, List *vals)
+{
+	Node	   *prop_map;
+	FuncCall   *setkeys;
+
+	prop_map = ParseFuncOrColumn(pstate,
+								 list_make1(makeString(AG_ELEM_PROP_MAP)),
+								 list_make1(elem), pstate->p_last_srf,
+								 NULL, false, -1);
+
+	setkeys = makeFuncCall(list_make1(makeString("jsonb_set_keys")), NIL,
+						   COERCE_EXPLICIT_CALL, -1);
+	prop_map = ParseFuncOrColumn(pstate, setkeys->funcname,
+								 list_make3(prop_map,
+											makeArrayExpr(TEXTARRAYOID,
+														  TEXTOID, keys),
+											makeArrayExpr(JSONBARRAYOID,
+														  JSONBOID, vals)),
+								 pstate->p_last_srf, setkeys, false, -1);
+
+	return makeGraphSetProp(pstate, kind, elem, varname, prop_map);
+}
+
+static GraphSetProp *
+makeGraphSetProp(ParseState *pstate, CSetKind kind, Node *elem, char *varname,
+				 Node *prop_map)
+{
+	GraphSetProp *gsp;
+	GSPKind		gspkind;
+
 	/*
 	 * set the modified property map
 	 */
@@ -4300,6 +4710,29 @@ transformSetProp(ParseState *pstate, CypherSetProp *sp, bool is_remove,
 	return gsp;
 }
 
+/* Does the expression refer to the given element variable? */
+static bool
+refers_to_elem_walker(Node *node, Var *elem)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Var))
+	{
+		Var		   *var = (Var *) node;
+
+		return (var->varlevelsup == 0 &&
+				var->varno == elem->varno &&
+				var->varattno == elem->varattno);
+	}
+
+	/* be conservative about subqueries */
+	if (IsA(node, Query))
+		return true;
+
+	return expression_tree_walker(node, refers_to_elem_walker, elem);
+}
+
 /*
  * resolve_var_from_targetlist_walker
  *
@@ -15,6 +15,7 @@
 #include "catalog/pg_type.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/optimizer.h"
 #include "parser/analyze.h"
 #include "parser/parse_agg.h"
 #include "parser/parse_collate.h"
@@ -75,6 +76,7 @@ static ParseNamespaceItem *makeDijkstraEdgeQuery(ParseState *pstate,
 												 CypherPath *cpath);
 static Node *makeDijkstraEdgeUnion(char *elabel_name, char *row_name);
 static Node *makeDijkstraEdge(char *elabel_name, char *row_name);
+static Node *makeDijkstraHeuristicSubLink(CypherPath *cpath, char *neighbor);
 
 /* parse node */
 static Node *makeColumnRef1(char *colname);
@@ -1085,7 +1087,8 @@ checkRelFormatForDijkstra(ParseState *pstate, CypherRel *crel)
 }
 
 /*
- * path = DIJKSTRA((source)-[:edge_label]->(target), weight, qual, LIMIT n)
+ * path = DIJKSTRA((source)-[:edge_label]->(target), weight, qual, LIMIT n,
+ *                 USING vertex => heuristic)
  *
  * |
  * v
@@ -1121,7 +1124,7 @@ checkRelFormatForDijkstra(ParseState *pstate, CypherRel *crel)
  *   FROM `graph_path`.edge_label
  *   WHERE start = id(source) AND `qual`
  *
- *   DIJKSTRA (id(source), id(target), LIMIT n, "end", id)
+ *   DIJKSTRA (id(source), id(target), LIMIT n, "end", id, heuristic)
  * )
  */
 static Query *
@@ -1200,7 +1203,7 @@ makeDijkstraQuery(ParseState *pstate, CypherPath *cpath, bool is_expr)
  * FROM `graph_path`.edge_label
  * WHERE start = id(source) AND `qual`
  *
- * DIJKSTRA (id(source), id(target), LIMIT n, "end", id)
+ * DIJKSTRA (id(source), id(target), LIMIT n, "end", id, heuristic)
  */
 static ParseNamespaceItem *
 makeDijkstraFrom(ParseState *parentParseState, CypherPath *cpath)
@@ -1304,6 +1307,61 @@ makeDijkstraFrom(ParseState *parentParseState, CypherPath *cpath)
 						   EXPR_KIND_SELECT_TARGET);
 	qry->dijkstraEdgeId = target;
 
+	/*
+	 * heuristic (A*)
+	 *
+	 * It estimates the remaining weight from the vertex at the other side of
+	 * the edge to the target. It can reference that vertex but not the edge,
+	 * so Dijkstra evaluates it for the first edge to each vertex only and
+	 * uses that estimate for the other edges to it.
+	 */
+	if (cpath->heuristic != NULL)
+	{
+		int			location = exprLocation(cpath->heuristic);
+		SubLink    *sublink;
+		TargetEntry *heuristic_te;
+
+		if (crel->direction == CYPHER_REL_DIR_LEFT)
+			target = makeDijkstraHeuristicSubLink(cpath, AG_START_ID);
+		else
+			target = makeDijkstraHeuristicSubLink(cpath, AG_END_ID);
+		target = transformExpr(pstate, target, EXPR_KIND_SELECT_TARGET);
+
+		sublink = castNode(SubLink, target);
+		heuristic_te = linitial(castNode(Query, sublink->subselect)->targetList);
+		if (contain_vars_of_level((Node *) heuristic_te->expr, 1))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_COLUMN_REFERENCE),
+					 errmsg("heuristic can only reference the vertex it estimates"),
+					 parser_errposition(pstate, location)));
+		if (expression_returns_set((Node *) heuristic_te->expr))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("heuristic must not return a set"),
+					 parser_errposition(pstate, location)));
+
+		wtype = exprType(target);
+		if (wtype != FLOAT8OID)
+		{
+			Node	   *heuristic;
+
+			heuristic = coerce_expr(pstate, target, wtype, FLOAT8OID, -1,
+									COERCION_EXPLICIT, COERCE_EXPLICIT_CAST,
+									-1);
+			if (heuristic == NULL)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATATYPE_MISMATCH),
+						 errmsg("heuristic must be type %s, not type %s",
+								format_type_be(FLOAT8OID),
+								format_type_be(wtype)),
+						 parser_errposition(pstate, location)));
+
+			target = heuristic;
+		}
+
+		qry->dijkstraHeuristic = target;
+	}
+
 	markTargetListOrigins(pstate, qry->targetList);
 
 	/* WHERE */
@@ -1342,6 +1400,7 @@ makeDijkstraFrom(ParseState *parentParseState, CypherPath *cpath)
 	/* Dijkstra LIMIT */
 	qry->dijkstraLimit = transformCypherLimit(pstate, cpath->limit,
 											  EXPR_KIND_LIMIT, "LIMIT");
+	qry->dijkstraTopK = cpath->topk;
 
 	qry->rtable = pstate->p_rtable;
 	qry->jointree = makeFromExpr(pstate->p_joinlist, qual);
@@ -1359,6 +1418,63 @@ makeDijkstraFrom(ParseState *parentParseState, CypherPath *cpath)
 										 true);
 }
 
+/*
+ * (
+ *   SELECT `heuristic`
+ *   FROM (
+ *     SELECT (id, properties, ctid)::vertex AS `heuristic_var`
+ *     FROM `get_graph_path()`.ag_vertex
+ *     WHERE id = `neighbor`
+ *   )
+ * )
+ */
+static Node *
+makeDijkstraHeuristicSubLink(CypherPath *cpath, char *neighbor)
+{
+	Node	   *id;
+	SelectStmt *selsub;
+	Node	   *vertex;
+	RangeVar   *ag_vertex;
+	A_Expr	   *qual;
+	RangeSubselect *sub;
+	CypherGenericExpr *cexpr;
+	SelectStmt *sel;
+
+	id = makeColumnRef1(AG_ELEM_LOCAL_ID);
+
+	selsub = makeNode(SelectStmt);
+
+	vertex = makeRowExprWithTypeCast(list_make3(id,
+												makeColumnRef1(AG_ELEM_PROP_MAP),
+												makeColumnRef1("ctid")),
+									 VERTEXOID, -1);
+	selsub->targetList =
+		list_make1(makeResTarget(vertex,
+								 getCypherName(cpath->heuristic_var)));
+
+	ag_vertex = makeRangeVar(get_graph_path(true), AG_VERTEX, -1);
+	ag_vertex->inh = true;
+	selsub->fromClause = list_make1(ag_vertex);
+
+	qual = makeSimpleA_Expr(AEXPR_OP, "=", copyObject(id),
+							makeColumnRef1(neighbor), -1);
+	selsub->whereClause = (Node *) qual;
+
+	sub = makeNode(RangeSubselect);
+	sub->subquery = (Node *) selsub;
+	sub->alias = makeAliasOptUnique(NULL);
+
+	/* the heuristic is a Cypher expression */
+	cexpr = makeNode(CypherGenericExpr);
+	cexpr->expr = cpath->heuristic;
+
+	sel = makeNode(SelectStmt);
+	sel->targetList = list_make1(makeResTarget((Node *) cexpr, NULL));
+	sel->fromClause = list_make1(sub);
+
+	return makeSubLink(sel);
+}
+
 static ParseNamespaceItem *
 makeDijkstraEdgeQuery(ParseState *pstate, CypherPath *cpath)
 {
@@ -74,6 +74,9 @@
 #include "utils/typcache.h"
 #include "parser/parse_cypher_utils.h"
 
+/* GUC parameter */
+int			graph_element_id_cache = AG_ELEM_LOCAL_ID_CACHE;
+
 
 /* State shared by transformCreateStmt and its subroutines */
 typedef struct
@@ -152,7 +155,8 @@ static Const *transformPartitionBoundValue(ParseState *pstate, Node *con,
 /* for agensgraph */
 static List *makeVertexElements(void);
 static List *makeEdgeElements(void);
-static List *makeEdgeIndex(RangeVar *label);
+static char *getLabelIdIndexMethod(CreateStmt *stmt, char labelKind);
+static List *makeEdgeIndex(RangeVar *label, char *id_index_method);
 static bool isLabelKind(RangeVar *label, char labkind);
 static void transformLabelIdDefinition(CreateStmtContext *cxt, ColumnDef *col);
 static CommentStmt *makeComment(ObjectType type, RangeVar *name, char *desc);
@@ -4459,6 +4463,7 @@ transformCreateLabelStmt(CreateLabelStmt *labelStmt, const char *queryString)
 	ParseCallbackState pcbstate;
 	Oid			existing_relid;
 	CreateStmt *stmt;
+	char	   *id_index_method;
 	List	   *indexlist;
 	CreateStmtContext cxt;
 	ListCell   *elements;
@@ -4518,6 +4523,8 @@ transformCreateLabelStmt(CreateLabelStmt *labelStmt, const char *queryString)
 	stmt->tablespacename = labelStmt->tablespacename;
 	stmt->if_not_exists = labelStmt->if_not_exists;
 
+	id_index_method = getLabelIdIndexMethod(stmt, labelStmt->labelKind);
+
 	/* set appropriate table elements and indexes */
 	if (labelStmt->labelKind == LABEL_VERTEX)
 	{
@@ -4529,7 +4536,7 @@ transformCreateLabelStmt(CreateLabelStmt *labelStmt, const char *queryString)
 	{
 		stmt->tableElts = makeEdgeElements();
 
-		indexlist = makeEdgeIndex(stmt->relation);
+		indexlist = makeEdgeIndex(stmt->relation, id_index_method);
 	}
 	else
 	{
@@ -4819,8 +4826,48 @@ makeEdgeElements(void)
 	return list_make4(id, start, end, prop_map);
 }
 
+/*
+ * Take "id_index" out of the reloptions of the label and return the access
+ * method of the index on the id column of an edge label. Vertex labels always
+ * have a primary key on it.
+ */
+static char *
+getLabelIdIndexMethod(CreateStmt *stmt, char labelKind)
+{
+	char	   *method = "btree";
+	ListCell   *lc;
+
+	foreach(lc, stmt->options)
+	{
+		DefElem    *def = (DefElem *) lfirst(lc);
+
+		if (def->defnamespace != NULL ||
+			strcmp(def->defname, "id_index") != 0)
+			continue;
+
+		if (labelKind != LABEL_EDGE)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("\"id_index\" option is only supported for edge labels")));
+
+		method = defGetString(def);
+		if (strcmp(method, "btree") != 0 &&
+			strcmp(method, "hash") != 0 &&
+			strcmp(method, "brin") != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("invalid value for \"id_index\" option: \"%s\"",
+							method),
+					 errhint("Valid values are \"btree\", \"hash\", and \"brin\".")));
+
+		stmt->options = foreach_delete_current(stmt->options, lc);
+	}
+
+	return method;
+}
+
 static List *
-makeEdgeIndex(RangeVar *label)
+makeEdgeIndex(RangeVar *label, char *id_index_method)
 {
 	char	   *labname;
 	Oid			graphid;
@@ -4851,7 +4898,7 @@ makeEdgeIndex(RangeVar *label)
 	edge_id_idx->idxname = ChooseRelationName(labname, AG_ELEM_LOCAL_ID,
 											  "idx", graphid, false);
 	edge_id_idx->relation = copyObject(label);
-	edge_id_idx->accessMethod = "brin";
+	edge_id_idx->accessMethod = id_index_method;
 	edge_id_idx->indexParams = list_make1(id_col);
 
 	start_idx = makeNode(IndexStmt);
@@ -4909,6 +4956,7 @@ transformLabelIdDefinition(CreateStmtContext *cxt, ColumnDef *col)
 	char	   *sname;
 	CreateSeqStmt *seqstmt;
 	DefElem    *maxval;
+	DefElem    *cache;
 	List	   *attnamelist;
 	DefElem    *ownedby;
 	AlterSeqStmt *altseqstmt;
@@ -4935,7 +4983,9 @@ transformLabelIdDefinition(CreateStmtContext *cxt, ColumnDef *col)
 
 	seqstmt = makeNode(CreateSeqStmt);
 	seqstmt->sequence = makeRangeVar(snamespace, sname, -1);
-	seqstmt->options = NIL;
+	cache = makeDefElem("cache", (Node *) makeInteger(graph_element_id_cache),
+						-1);
+	seqstmt->options = list_make1(cache);
 	seqstmt->ownerId = InvalidOid;
 
 	cxt->blist = lappend(cxt->blist, seqstmt);
@@ -1716,6 +1716,9 @@ AutoVacWorkerMain(int argc, char *argv[])
 		recentXid = ReadNextTransactionId();
 		recentMulti = ReadNextMultiXactId();
 		do_autovacuum();
+
+		/* fold the pending edge counts of this database into ag_graphmeta */
+		agstat_flush_graphmeta();
 	}
 
 	/*
@@ -116,12 +116,16 @@
 
 #define AGSTAT_EDGE_HASH_SIZE	16
 
+/* the number of edge labels whose last regather is remembered */
+#define AGSTAT_GATHERED_HASH_SIZE	1024
+
 /* ----------
  * GUC parameters
  * ----------
  */
 bool		pgstat_track_counts = false;
 int			pgstat_track_functions = TRACK_FUNC_OFF;
+int			max_pending_graphmeta = 4096;
 
 /* ----------
  * Built from GUC parameter
@@ -266,6 +270,86 @@ typedef struct AgStat_SubXactStatus
 
 static AgStat_SubXactStatus *agStatXactStack = NULL;
 
+/*
+ * Edge counts of committed transactions that are not in ag_graphmeta yet.
+ * Committing transactions add their counts here instead of updating the
+ * catalog, so concurrent edge writers do not serialize on the same
+ * ag_graphmeta rows nor write catalog WAL at every commit. Autovacuum workers
+ * fold the counts of their database into ag_graphmeta (see
+ * agstat_flush_graphmeta()), and the readers of ag_graphmeta add the counts
+ * that are still here (see agstat_get_pending_graphmeta()). A clean shutdown
+ * saves the counts that are not folded yet and the next startup restores
+ * them. They are lost on a crash; regather_graphmeta() rebuilds ag_graphmeta
+ * then. There is room for the counts of max_pending_graphmeta edge label
+ * triples.
+ *
+ * A committing transaction makes sure before it commits that there is an
+ * entry for each of its counts, and reserves it so that a flush does not
+ * remove it. It adds its counts only after it has committed, so that they
+ * are never seen before its edges are.
+ *
+ * Entries are added and removed while holding AgStatGraphMetaLock in
+ * exclusive mode. The counters and the reservations of an existing entry are
+ * updated atomically while holding it in shared mode.
+ */
+typedef struct AgStat_SharedKey
+{
+	Oid			dbid;
+	AgStat_key	key;
+} AgStat_SharedKey;
+
+typedef struct AgStat_SharedGraphMeta
+{
+	AgStat_SharedKey key;		/* hash key */
+	pg_atomic_uint64 edges_inserted;
+	pg_atomic_uint64 edges_deleted;
+	pg_atomic_uint32 nreserved; /* # of committing transactions */
+} AgStat_SharedGraphMeta;
+
+static HTAB *agStatSharedHash = NULL;
+
+/*
+ * Whether the current transaction has reserved the entries of its edge counts
+ * (see PreCommit_AgStat()).
+ */
+static bool agStatReserved = false;
+
+/*
+ * The pending edge counts that label and graph drops of the current
+ * transaction make obsolete. They are discarded only when the transaction
+ * commits, because they are still valid if it aborts.
+ */
+typedef struct AgStat_Discard
+{
+	Oid			graph;
+	Labid		vlabel;
+	Labid		elabel;
+	int			nest_level;		/* subtransaction nest level */
+} AgStat_Discard;
+
+static List *agStatDiscards = NIL;	/* in TopTransactionContext */
+
+/*
+ * The change counters of edge labels when regather_graphmeta() last counted
+ * their edges. An incremental regather skips the labels whose counters are
+ * still the same. Entries are read and written while holding
+ * AgStatGraphMetaLock.
+ */
+typedef struct AgStat_GatheredKey
+{
+	Oid			dbid;
+	Oid			relid;
+} AgStat_GatheredKey;
+
+typedef struct AgStat_GatheredLabel
+{
+	AgStat_GatheredKey key;		/* hash key */
+	PgStat_Counter changes;
+	Oid			relfilenode;
+} AgStat_GatheredLabel;
+
+static HTAB *agStatGatheredHash = NULL;
+
 static int	pgStatXactCommit = 0;
 static int	pgStatXactRollback = 0;
 PgStat_Counter pgStatBlockReadTime = 0;
@@ -742,6 +826,7 @@ pgstat_reset_all(void)
 {
 	pgstat_reset_remove_files(pgstat_stat_directory);
 	pgstat_reset_remove_files(PGSTAT_STAT_PERMANENT_DIRECTORY);
+	unlink(AGSTAT_GRAPHMETA_FILENAME);
 }
 
 #ifdef EXEC_BACKEND
@@ -5880,6 +5965,591 @@ pgstat_count_slru_truncate(int slru_idx)
 }
 
 
+/*
+ * AgStatShmemSize - report the shared memory space needed by AgStatShmemInit
+ */
+Size
+AgStatShmemSize(void)
+{
+	return add_size(hash_estimate_size(max_pending_graphmeta,
+									   sizeof(AgStat_SharedGraphMeta)),
+					hash_estimate_size(AGSTAT_GATHERED_HASH_SIZE,
+									   sizeof(AgStat_GatheredLabel)));
+}
+
+/*
+ * AgStatShmemInit - allocate and initialize the pending edge counts
+ */
+void
+AgStatShmemInit(void)
+{
+	HASHCTL		info;
+
+	info.keysize = sizeof(AgStat_SharedKey);
+	info.entrysize = sizeof(AgStat_SharedGraphMeta);
+
+	agStatSharedHash = ShmemInitHash("AgStat graphmeta",
+									 max_pending_graphmeta,
+									 max_pending_graphmeta,
+									 &info,
+									 HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+
+	info.keysize = sizeof(AgStat_GatheredKey);
+	info.entrysize = sizeof(AgStat_GatheredLabel);
+
+	agStatGatheredHash = ShmemInitHash("AgStat gathered labels",
+									   AGSTAT_GATHERED_HASH_SIZE,
+									   AGSTAT_GATHERED_HASH_SIZE,
+									   &info,
+									   HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+}
+
+static void
+agstat_shared_key(AgStat_SharedKey *skey, const AgStat_key *key)
+{
+	/* the padding bytes are hashed too */
+	memset(skey, 0, sizeof(*skey));
+	skey->dbid = MyDatabaseId;
+	skey->key.graph = key->graph;
+	skey->key.edge = key->edge;
+	skey->key.start = key->start;
+	skey->key.end = key->end;
+}
+
+/*
+ * agstat_reserve_pending - reserve the pending counts of an edge label triple
+ *
+ * Returns false if there is no room for the edge label triple.
+ */
+static bool
+agstat_reserve_pending(const AgStat_key *key)
+{
+	AgStat_SharedKey skey;
+	AgStat_SharedGraphMeta *entry;
+
+	agstat_shared_key(&skey, key);
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_SHARED);
+	entry = hash_search(agStatSharedHash, &skey, HASH_FIND, NULL);
+	if (entry == NULL)
+	{
+		bool		found;
+
+		LWLockRelease(AgStatGraphMetaLock);
+		LWLockAcquire(AgStatGraphMetaLock, LW_EXCLUSIVE);
+
+		entry = hash_search(agStatSharedHash, &skey, HASH_ENTER_NULL, &found);
+		if (entry == NULL)
+		{
+			LWLockRelease(AgStatGraphMetaLock);
+			return false;
+		}
+		if (!found)
+		{
+			pg_atomic_init_u64(&entry->edges_inserted, 0);
+			pg_atomic_init_u64(&entry->edges_deleted, 0);
+			pg_atomic_init_u32(&entry->nreserved, 0);
+		}
+	}
+	pg_atomic_fetch_add_u32(&entry->nreserved, 1);
+	LWLockRelease(AgStatGraphMetaLock);
+
+	return true;
+}
+
+/*
+ * agstat_release_pending - add edge counts to reserved pending counts
+ *
+ * The counts are simply dropped if the entry has been discarded since it was
+ * reserved, because the edges have been counted again or their labels
+ * dropped. This must not fail, because it is called after commit.
+ */
+static void
+agstat_release_pending(const AgStat_key *key, PgStat_Counter inserted,
+					   PgStat_Counter deleted)
+{
+	AgStat_SharedKey skey;
+	AgStat_SharedGraphMeta *entry;
+
+	agstat_shared_key(&skey, key);
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_SHARED);
+	entry = hash_search(agStatSharedHash, &skey, HASH_FIND, NULL);
+	if (entry != NULL)
+	{
+		pg_atomic_fetch_add_u64(&entry->edges_inserted, inserted);
+		pg_atomic_fetch_add_u64(&entry->edges_deleted, deleted);
+		pg_atomic_fetch_sub_u32(&entry->nreserved, 1);
+	}
+	LWLockRelease(AgStatGraphMetaLock);
+}
+
+/*
+ * agstat_get_pending_graphmeta - get the edge counts not in ag_graphmeta yet
+ *
+ * Returns a list of palloc'd AgStat_GraphMeta of the given graph, or of all
+ * graphs if graph is InvalidOid, in the current database.
+ */
+List *
+agstat_get_pending_graphmeta(Oid graph)
+{
+	List	   *result = NIL;
+	HASH_SEQ_STATUS seq;
+	AgStat_SharedGraphMeta *entry;
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_SHARED);
+
+	hash_seq_init(&seq, agStatSharedHash);
+	while ((entry = hash_seq_search(&seq)) != NULL)
+	{
+		AgStat_GraphMeta *graphmeta;
+
+		if (entry->key.dbid != MyDatabaseId)
+			continue;
+		if (OidIsValid(graph) && entry->key.key.graph != graph)
+			continue;
+
+		graphmeta = palloc(sizeof(AgStat_GraphMeta));
+		memcpy(&graphmeta->key, &entry->key.key, sizeof(AgStat_key));
+		graphmeta->edges_inserted =
+			(PgStat_Counter) pg_atomic_read_u64(&entry->edges_inserted);
+		graphmeta->edges_deleted =
+			(PgStat_Counter) pg_atomic_read_u64(&entry->edges_deleted);
+		result = lappend(result, graphmeta);
+	}
+
+	LWLockRelease(AgStatGraphMetaLock);
+
+	return result;
+}
+
+/*
+ * agstat_remove_pending - remove pending edge counts from shared memory
+ */
+static void
+agstat_remove_pending(Oid graph, Labid vlabel, Labid elabel)
+{
+	HASH_SEQ_STATUS seq;
+	AgStat_SharedGraphMeta *entry;
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_EXCLUSIVE);
+
+	hash_seq_init(&seq, agStatSharedHash);
+	while ((entry = hash_seq_search(&seq)) != NULL)
+	{
+		AgStat_key *key = &entry->key.key;
+
+		if (entry->key.dbid != MyDatabaseId)
+			continue;
+		if (OidIsValid(graph) && key->graph != graph)
+			continue;
+		if (vlabel != InvalidLabid &&
+			key->start != vlabel && key->end != vlabel)
+			continue;
+		if (elabel != InvalidLabid && key->edge != elabel)
+			continue;
+
+		hash_search(agStatSharedHash, &entry->key, HASH_REMOVE, NULL);
+	}
+
+	LWLockRelease(AgStatGraphMetaLock);
+}
+
+/*
+ * agstat_discard_pending_graphmeta - forget pending edge counts when the
+ *		current transaction commits
+ *
+ * Forgets the counts of the current database that are of the given graph
+ * and have the given vertex label at either side and the given edge label.
+ * InvalidOid and InvalidLabid match anything. Label and graph drops and
+ * regather_graphmeta() make the counts obsolete only if they commit; the
+ * counts are still valid if they abort. The lock taken here waits for a
+ * flush in progress, so that it does not put back the rows the caller
+ * deletes, and keeps flushes away until the transaction ends.
+ */
+void
+agstat_discard_pending_graphmeta(Oid graph, Labid vlabel, Labid elabel)
+{
+	MemoryContext oldcxt;
+	AgStat_Discard *discard;
+
+	LockRelationOid(GraphMetaRelationId, ShareUpdateExclusiveLock);
+
+	oldcxt = MemoryContextSwitchTo(TopTransactionContext);
+	discard = palloc(sizeof(AgStat_Discard));
+	discard->graph = graph;
+	discard->vlabel = vlabel;
+	discard->elabel = elabel;
+	discard->nest_level = GetCurrentTransactionNestLevel();
+	agStatDiscards = lappend(agStatDiscards, discard);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * agstat_label_gathered - has the edge label not changed since last gathered?
+ *
+ * changes is the pgstat change counter of the label, or -1 if it is not
+ * tracked, in which case the label is always considered changed.
+ */
+bool
+agstat_label_gathered(Oid relid, PgStat_Counter changes, Oid relfilenode)
+{
+	AgStat_GatheredKey key;
+	AgStat_GatheredLabel *entry;
+	bool		result = false;
+
+	if (changes < 0)
+		return false;
+
+	key.dbid = MyDatabaseId;
+	key.relid = relid;
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_SHARED);
+	entry = hash_search(agStatGatheredHash, &key, HASH_FIND, NULL);
+	if (entry != NULL)
+		result = (entry->changes == changes &&
+				  entry->relfilenode == relfilenode);
+	LWLockRelease(AgStatGraphMetaLock);
+
+	return result;
+}
+
+/*
+ * agstat_remember_gathered_label - remember the edge label as gathered
+ *
+ * The label is simply not remembered if there is no room for it.
+ */
+void
+agstat_remember_gathered_label(Oid relid, PgStat_Counter changes,
+							   Oid relfilenode)
+{
+	AgStat_GatheredKey key;
+	AgStat_GatheredLabel *entry;
+
+	key.dbid = MyDatabaseId;
+	key.relid = relid;
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_EXCLUSIVE);
+	if (changes < 0)
+	{
+		hash_search(agStatGatheredHash, &key, HASH_REMOVE, NULL);
+	}
+	else
+	{
+		entry = hash_search(agStatGatheredHash, &key, HASH_ENTER_NULL, NULL);
+		if (entry != NULL)
+		{
+			entry->changes = changes;
+			entry->relfilenode = relfilenode;
+		}
+	}
+	LWLockRelease(AgStatGraphMetaLock);
+}
+
+/*
+ * agstat_update_graphmeta - add edge counts to an ag_graphmeta row
+ *
+ * The row is inserted if it does not exist, and deleted if no edges are left.
+ */
+static void
+agstat_update_graphmeta(Relation ag_graphmeta, const AgStat_key *key,
+						int64 delta)
+{
+	HeapTuple	tup;
+
+	tup = SearchSysCache4(GRAPHMETAFULL,
+						  ObjectIdGetDatum(key->graph),
+						  Int16GetDatum(key->edge),
+						  Int16GetDatum(key->start),
+						  Int16GetDatum(key->end));
+
+	if (HeapTupleIsValid(tup))
+	{
+		HeapTuple	newtup;
+		Form_ag_graphmeta metatup;
+
+		newtup = heap_copytuple(tup);
+		ReleaseSysCache(tup);
+
+		metatup = (Form_ag_graphmeta) GETSTRUCT(newtup);
+		metatup->edgecount += delta;
+
+		/*
+		 * The count can go below zero if edges created while the counts
+		 * were not gathered are deleted.
+		 */
+		if (metatup->edgecount <= 0)
+			CatalogTupleDelete(ag_graphmeta, &newtup->t_self);
+		else
+			CatalogTupleUpdate(ag_graphmeta, &newtup->t_self, newtup);
+
+		heap_freetuple(newtup);
+	}
+	else if (delta > 0)
+	{
+		Datum		values[Natts_ag_graphmeta];
+		bool		isnull[Natts_ag_graphmeta];
+		int			i;
+
+		for (i = 0; i < Natts_ag_graphmeta; i++)
+		{
+			values[i] = (Datum) NULL;
+			isnull[i] = false;
+		}
+
+		values[Anum_ag_graphmeta_graph - 1] = ObjectIdGetDatum(key->graph);
+		values[Anum_ag_graphmeta_edge - 1] = Int16GetDatum(key->edge);
+		values[Anum_ag_graphmeta_start - 1] = Int16GetDatum(key->start);
+		values[Anum_ag_graphmeta_end - 1] = Int16GetDatum(key->end);
+		values[Anum_ag_graphmeta_edgecount - 1] = Int64GetDatum(delta);
+
+		tup = heap_form_tuple(RelationGetDescr(ag_graphmeta), values, isnull);
+
+		CatalogTupleInsert(ag_graphmeta, tup);
+
+		heap_freetuple(tup);
+	}
+}
+
+/*
+ * agstat_flush_graphmeta - fold the pending edge counts into ag_graphmeta
+ *
+ * Folds the counts of the current database in a transaction of its own, so
+ * this must be called outside of a transaction. It is called by autovacuum
+ * workers. The counts are subtracted from the pending counts only after the
+ * transaction commits, so readers may count them twice for a moment but
+ * never miss them. A session lock on ag_graphmeta keeps other flushes,
+ * regather_graphmeta() and label drops away until then.
+ */
+void
+agstat_flush_graphmeta(void)
+{
+	MemoryContext cxt = CurrentMemoryContext;
+	MemoryContext oldcxt;
+	LockRelId	lockrelid;
+	List	   *pending;
+	ListCell   *lc;
+	Relation	ag_graphmeta;
+
+	Assert(!IsTransactionState());
+
+	pending = agstat_get_pending_graphmeta(InvalidOid);
+	if (pending == NIL)
+		return;
+	list_free_deep(pending);
+
+	StartTransactionCommand();
+
+	lockrelid.relId = GraphMetaRelationId;
+	lockrelid.dbId = MyDatabaseId;
+	LockRelationIdForSession(&lockrelid, ShareUpdateExclusiveLock);
+
+	/* the counts must outlive the transaction */
+	oldcxt = MemoryContextSwitchTo(cxt);
+	pending = agstat_get_pending_graphmeta(InvalidOid);
+	MemoryContextSwitchTo(oldcxt);
+
+	ag_graphmeta = table_open(GraphMetaRelationId, RowExclusiveLock);
+	foreach(lc, pending)
+	{
+		AgStat_GraphMeta *graphmeta = lfirst(lc);
+
+		agstat_update_graphmeta(ag_graphmeta, &graphmeta->key,
+								graphmeta->edges_inserted -
+								graphmeta->edges_deleted);
+	}
+	table_close(ag_graphmeta, RowExclusiveLock);
+
+	CommitTransactionCommand();
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_EXCLUSIVE);
+	foreach(lc, pending)
+	{
+		AgStat_GraphMeta *graphmeta = lfirst(lc);
+		AgStat_SharedKey skey;
+		AgStat_SharedGraphMeta *entry;
+		uint64		inserted;
+		uint64		deleted;
+
+		agstat_shared_key(&skey, &graphmeta->key);
+		entry = hash_search(agStatSharedHash, &skey, HASH_FIND, NULL);
+		if (entry == NULL)
+			continue;
+
+		inserted = pg_atomic_sub_fetch_u64(&entry->edges_inserted,
+										   graphmeta->edges_inserted);
+		deleted = pg_atomic_sub_fetch_u64(&entry->edges_deleted,
+										  graphmeta->edges_deleted);
+		if (inserted == 0 && deleted == 0 &&
+			pg_atomic_read_u32(&entry->nreserved) == 0)
+			hash_search(agStatSharedHash, &skey, HASH_REMOVE, NULL);
+	}
+	LWLockRelease(AgStatGraphMetaLock);
+
+	UnlockRelationIdForSession(&lockrelid, ShareUpdateExclusiveLock);
+
+	list_free_deep(pending);
+}
+
+/*
+ * agstat_save_pending_graphmeta - save the pending edge counts to a file
+ *
+ * Called after the shutdown checkpoint, when no backend can add counts any
+ * more, so that the next startup can restore the counts that autovacuum has
+ * not folded yet. Failures are only logged.
+ */
+void
+agstat_save_pending_graphmeta(void)
+{
+	HASH_SEQ_STATUS seq;
+	AgStat_SharedGraphMeta *entry;
+	FILE	   *fpout;
+	int32		format_id;
+	int			rc;
+
+	if (hash_get_num_entries(agStatSharedHash) == 0)
+		return;
+
+	fpout = AllocateFile(AGSTAT_GRAPHMETA_TMPFILE, PG_BINARY_W);
+	if (fpout == NULL)
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not open temporary statistics file \"%s\": %m",
+						AGSTAT_GRAPHMETA_TMPFILE)));
+		return;
+	}
+
+	format_id = PGSTAT_FILE_FORMAT_ID;
+	rc = fwrite(&format_id, sizeof(format_id), 1, fpout);
+	(void) rc;					/* we'll check for error with ferror */
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_SHARED);
+
+	hash_seq_init(&seq, agStatSharedHash);
+	while ((entry = hash_seq_search(&seq)) != NULL)
+	{
+		uint64		inserted = pg_atomic_read_u64(&entry->edges_inserted);
+		uint64		deleted = pg_atomic_read_u64(&entry->edges_deleted);
+
+		if (inserted == deleted)
+			continue;
+
+		fputc('G', fpout);
+		rc = fwrite(&entry->key, sizeof(entry->key), 1, fpout);
+		rc = fwrite(&inserted, sizeof(inserted), 1, fpout);
+		rc = fwrite(&deleted, sizeof(deleted), 1, fpout);
+		(void) rc;				/* we'll check for error with ferror */
+	}
+
+	LWLockRelease(AgStatGraphMetaLock);
+
+	fputc('E', fpout);
+
+	if (ferror(fpout))
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not write temporary statistics file \"%s\": %m",
+						AGSTAT_GRAPHMETA_TMPFILE)));
+		FreeFile(fpout);
+		unlink(AGSTAT_GRAPHMETA_TMPFILE);
+	}
+	else if (FreeFile(fpout) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not close temporary statistics file \"%s\": %m",
+						AGSTAT_GRAPHMETA_TMPFILE)));
+		unlink(AGSTAT_GRAPHMETA_TMPFILE);
+	}
+	else if (durable_rename(AGSTAT_GRAPHMETA_TMPFILE,
+							AGSTAT_GRAPHMETA_FILENAME, LOG) < 0)
+		unlink(AGSTAT_GRAPHMETA_TMPFILE);
+}
+
+/*
+ * agstat_restore_pending_graphmeta - restore the pending edge counts saved at
+ *		the last clean shutdown
+ *
+ * Called by the startup process. The file is removed once read, and recovery
+ * removes it before this is called because the counts may not match the
+ * recovered edges (see pgstat_reset_all()).
+ */
+void
+agstat_restore_pending_graphmeta(void)
+{
+	FILE	   *fpin;
+	int32		format_id;
+	AgStat_SharedKey skey;
+	uint64		inserted;
+	uint64		deleted;
+	AgStat_SharedGraphMeta *entry;
+	bool		found;
+
+	if ((fpin = AllocateFile(AGSTAT_GRAPHMETA_FILENAME, PG_BINARY_R)) == NULL)
+	{
+		if (errno != ENOENT)
+			ereport(LOG,
+					(errcode_for_file_access(),
+					 errmsg("could not open statistics file \"%s\": %m",
+							AGSTAT_GRAPHMETA_FILENAME)));
+		return;
+	}
+
+	if (fread(&format_id, 1, sizeof(format_id), fpin) != sizeof(format_id) ||
+		format_id != PGSTAT_FILE_FORMAT_ID)
+	{
+		ereport(LOG,
+				(errmsg("corrupted statistics file \"%s\"",
+						AGSTAT_GRAPHMETA_FILENAME)));
+		goto done;
+	}
+
+	LWLockAcquire(AgStatGraphMetaLock, LW_EXCLUSIVE);
+
+	for (;;)
+	{
+		int			c = fgetc(fpin);
+
+		if (c == 'E')
+			break;
+
+		if (c != 'G' ||
+			fread(&skey, 1, sizeof(skey), fpin) != sizeof(skey) ||
+			fread(&inserted, 1, sizeof(inserted), fpin) != sizeof(inserted) ||
+			fread(&deleted, 1, sizeof(deleted), fpin) != sizeof(deleted))
+		{
+			ereport(LOG,
+					(errmsg("corrupted statistics file \"%s\"",
+							AGSTAT_GRAPHMETA_FILENAME)));
+			break;
+		}
+
+		entry = hash_search(agStatSharedHash, &skey, HASH_ENTER_NULL, &found);
+		if (entry == NULL)
+		{
+			ereport(LOG,
+					(errmsg("could not restore all pending edge counts"),
+					 errhint("Consider increasing the configuration parameter \"max_pending_graphmeta\".")));
+			break;
+		}
+		if (!found)
+		{
+			pg_atomic_init_u64(&entry->edges_inserted, inserted);
+			pg_atomic_init_u64(&entry->edges_deleted, deleted);
+			pg_atomic_init_u32(&entry->nreserved, 0);
+		}
+	}
+
+	LWLockRelease(AgStatGraphMetaLock);
+
+done:
+	FreeFile(fpin);
+
+	unlink(AGSTAT_GRAPHMETA_FILENAME);
+}
+
 /*
  * get_agstat_stack_level - add a new (sub)transaction stack entry if needed
  */
@@ -6004,6 +6674,8 @@ agstat_drop_vlabel(const char *vlab)
 	if (vlid == InvalidLabid)
 		elog(ERROR, "Cannot find VLABEL %s", vlab);
 
+	agstat_discard_pending_graphmeta(graph, vlid, InvalidLabid);
+
 	ag_graphmeta = table_open(GraphMetaRelationId, RowExclusiveLock);
 
 	/* delete tuple which start = vid */
@@ -6062,6 +6734,8 @@ agstat_drop_elabel(const char *elab)
 	if (elid == InvalidLabid)
 		elog(ERROR, "Cannot find ELABEL %s", elab);
 
+	agstat_discard_pending_graphmeta(graph, InvalidLabid, elid);
+
 	ag_graphmeta = table_open(GraphMetaRelationId, RowExclusiveLock);
 
 	tuplist = SearchSysCacheList2(GRAPHMETAFULL, graph, elid);
@@ -6087,6 +6761,8 @@ agstat_drop_graph(const char *graphname)
 
 	graph = get_graphname_oid(graphname);
 
+	agstat_discard_pending_graphmeta(graph, InvalidLabid, InvalidLabid);
+
 	ag_graphmeta = table_open(GraphMetaRelationId, RowExclusiveLock);
 	tuplist = SearchSysCacheList1(GRAPHMETAFULL, graph);
 
@@ -6101,88 +6777,112 @@ agstat_drop_graph(const char *graphname)
 	table_close(ag_graphmeta, RowExclusiveLock);
 }
 
+/* ----------
+ * PreCommit_AgStat
+ *
+ *	Called from access/transam/xact.c before top-level transaction commit.
+ *	Reserves the pending counts that AtEOXact_AgStat() will add the edge
+ *	counts of the transaction to. The counts that do not fit in shared memory
+ *	are added to ag_graphmeta right away instead, which cannot be done once
+ *	the transaction has committed.
+ * ----------
+ */
+void
+PreCommit_AgStat(void)
+{
+	AgStat_SubXactStatus *xact_state;
+	AgStat_GraphMeta *graphmeta;
+	HASH_SEQ_STATUS seq;
+	Relation	ag_graphmeta = NULL;
+
+	xact_state = agStatXactStack;
+	if (xact_state == NULL)
+		return;
+
+	hash_seq_init(&seq, xact_state->htab);
+	while ((graphmeta = hash_seq_search(&seq)) != NULL)
+	{
+		if (graphmeta->edges_inserted == graphmeta->edges_deleted)
+			continue;
+
+		if (agstat_reserve_pending(&graphmeta->key))
+			continue;
+
+		/* no room in shared memory, update the catalog directly */
+		if (ag_graphmeta == NULL)
+			ag_graphmeta = table_open(GraphMetaRelationId, RowExclusiveLock);
+		agstat_update_graphmeta(ag_graphmeta, &graphmeta->key,
+								graphmeta->edges_inserted -
+								graphmeta->edges_deleted);
+
+		/* done with them */
+		graphmeta->edges_inserted = 0;
+		graphmeta->edges_deleted = 0;
+	}
+
+	if (ag_graphmeta != NULL)
+		table_close(ag_graphmeta, RowExclusiveLock);
+
+	agStatReserved = true;
+}
+
 /* ----------
  * AtEOXact_AgStat
  *
  *	Called from access/transam/xact.c at top-level transaction commit/abort.
+ *	At commit, this is called after the transaction has been recorded as
+ *	committed but before its locks are released.
  * ----------
  */
 void
 AtEOXact_AgStat(bool isCommit)
 {
 	AgStat_SubXactStatus *xact_state;
+	ListCell   *lc;
 
 	/*
-	 * Transfer transactional insert/update counts into the base tabstat
-	 * entries.  We don't bother to free any of the transactional state, since
-	 * it's all in TopTransactionContext and will go away anyway.
+	 * Transfer transactional edge counts into the pending counts in shared
+	 * memory, or just release the reservations if the transaction aborted
+	 * after PreCommit_AgStat().  We don't bother to free any of the
+	 * transactional state, since it's all in TopTransactionContext and will
+	 * go away anyway.
 	 */
 	xact_state = agStatXactStack;
-	if (xact_state != NULL && isCommit)
+	if (xact_state != NULL && agStatReserved)
 	{
 		AgStat_GraphMeta *graphmeta;
 		HASH_SEQ_STATUS seq;
-		Relation	ag_graphmeta;
-		HeapTuple	tup;
 
 		hash_seq_init(&seq, xact_state->htab);
-
-		ag_graphmeta = table_open(GraphMetaRelationId, RowExclusiveLock);
-
 		while ((graphmeta = hash_seq_search(&seq)) != NULL)
 		{
-			tup = SearchSysCache4(GRAPHMETAFULL,
-								  graphmeta->key.graph,
-								  graphmeta->key.edge,
-								  graphmeta->key.start,
-								  graphmeta->key.end);
-
-			if (HeapTupleIsValid(tup))
-			{
-				Form_ag_graphmeta metatup;
-
-				metatup = (Form_ag_graphmeta) GETSTRUCT(tup);
-
-				metatup->edgecount += graphmeta->edges_inserted;
-				metatup->edgecount -= graphmeta->edges_deleted;
-
-				if (metatup->edgecount < 0)
-					elog(ERROR, "The edge count can not be less than 0.");
+			if (graphmeta->edges_inserted == graphmeta->edges_deleted)
+				continue;
 
-				if (metatup->edgecount == 0)
-					CatalogTupleDelete(ag_graphmeta, &tup->t_self);
-				else
-					CatalogTupleUpdate(ag_graphmeta, &tup->t_self, tup);
-				ReleaseSysCache(tup);
-			}
+			if (isCommit)
+				agstat_release_pending(&graphmeta->key,
+									   graphmeta->edges_inserted,
+									   graphmeta->edges_deleted);
 			else
-			{
-				Datum		values[Natts_ag_graphmeta];
-				bool		isnull[Natts_ag_graphmeta];
-				int			i;
-
-				for (i = 0; i < Natts_ag_graphmeta; i++)
-				{
-					values[i] = (Datum) NULL;
-					isnull[i] = false;
-				}
-
-				values[Anum_ag_graphmeta_graph - 1] = ObjectIdGetDatum(graphmeta->key.graph);
-				values[Anum_ag_graphmeta_edge - 1] = Int16GetDatum(graphmeta->key.edge);
-				values[Anum_ag_graphmeta_start - 1] = Int16GetDatum(graphmeta->key.start);
-				values[Anum_ag_graphmeta_end - 1] = Int16GetDatum(graphmeta->key.end);
-				values[Anum_ag_graphmeta_edgecount - 1] = Int64GetDatum(graphmeta->edges_inserted - graphmeta->edges_deleted);
-
-				tup = heap_form_tuple(RelationGetDescr(ag_graphmeta), values, isnull);
+				agstat_release_pending(&graphmeta->key, 0, 0);
+		}
+	}
 
-				CatalogTupleInsert(ag_graphmeta, tup);
+	/* the counts of dropped or regathered labels are obsolete now */
+	if (isCommit)
+	{
+		foreach(lc, agStatDiscards)
+		{
+			AgStat_Discard *discard = lfirst(lc);
 
-				heap_freetuple(tup);
-			}
+			agstat_remove_pending(discard->graph, discard->vlabel,
+								  discard->elabel);
 		}
-		table_close(ag_graphmeta, RowExclusiveLock);
 	}
+
 	agStatXactStack = NULL;
+	agStatReserved = false;
+	agStatDiscards = NIL;
 }
 
 /* ----------
@@ -6201,6 +6901,24 @@ AtEOSubXact_AgStat(bool isCommit, int nestDepth)
 	 * Transfer transactional insert/update counts into the next higher
 	 * subtransaction state.
 	 */
+	if (agStatDiscards != NIL)
+	{
+		ListCell   *lc;
+
+		foreach(lc, agStatDiscards)
+		{
+			AgStat_Discard *discard = lfirst(lc);
+
+			if (discard->nest_level < nestDepth)
+				continue;
+
+			if (isCommit)
+				discard->nest_level = nestDepth - 1;
+			else
+				agStatDiscards = foreach_delete_current(agStatDiscards, lc);
+		}
+	}
+
 	xact_state = agStatXactStack;
 	if (xact_state != NULL &&
 		xact_state->nest_level >= nestDepth)
@@ -17,6 +17,7 @@
 #include "catalog/pg_collation.h"
 #include "catalog/pg_type.h"
 #include "funcapi.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/cypher_funcs.h"
 #include "utils/jsonb.h"
@@ -1174,6 +1175,123 @@ jsonb_string_regex(PG_FUNCTION_ARGS)
 	PG_RETURN_NULL();
 }
 
+/*
+ * jsonb_set_keys(map jsonb, keys text[], vals jsonb[])
+ *
+ * Sets the top-level keys of a property map to the given values in a single
+ * pass over the map, which is what SET of several properties of an element
+ * becomes.  A NULL value removes the key.  If a key is given more than once,
+ * the last value wins.
+ */
+Datum
+jsonb_set_keys(PG_FUNCTION_ARGS)
+{
+	Jsonb	   *map = PG_GETARG_JSONB_P(0);
+	ArrayType  *keyarr = PG_GETARG_ARRAYTYPE_P(1);
+	ArrayType  *valarr = PG_GETARG_ARRAYTYPE_P(2);
+	Datum	   *keys;
+	bool	   *keynulls;
+	int			nkeys;
+	Datum	   *vals;
+	bool	   *valnulls;
+	int			nvals;
+	bool	   *overridden;
+	JsonbParseState *jpstate = NULL;
+	JsonbIterator *it;
+	JsonbValue	jv;
+	JsonbIteratorToken tok;
+	JsonbValue *res;
+	int			i;
+	int			j;
+
+	if (!JB_ROOT_IS_OBJECT(map))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("jsonb object is expected for property map")));
+
+	deconstruct_array(keyarr, TEXTOID, -1, false, TYPALIGN_INT,
+					  &keys, &keynulls, &nkeys);
+	deconstruct_array(valarr, JSONBOID, -1, false, TYPALIGN_INT,
+					  &vals, &valnulls, &nvals);
+	if (nkeys != nvals)
+		ereport(ERROR,
+				(errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+				 errmsg("the number of keys and values must be the same")));
+
+	/* the earlier values of keys given more than once are ignored */
+	overridden = palloc0(sizeof(bool) * nkeys);
+	for (i = 0; i < nkeys; i++)
+	{
+		if (keynulls[i])
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("property key cannot be NULL")));
+
+		for (j = i + 1; j < nkeys; j++)
+		{
+			if (!keynulls[j] &&
+				VARSIZE_ANY_EXHDR(keys[i]) == VARSIZE_ANY_EXHDR(keys[j]) &&
+				memcmp(VARDATA_ANY(keys[i]), VARDATA_ANY(keys[j]),
+					   VARSIZE_ANY_EXHDR(keys[i])) == 0)
+			{
+				overridden[i] = true;
+				break;
+			}
+		}
+	}
+
+	/* copy the pairs of the other keys */
+	it = JsonbIteratorInit(&map->root);
+	tok = JsonbIteratorNext(&it, &jv, false);
+	Assert(tok == WJB_BEGIN_OBJECT);
+	pushJsonbValue(&jpstate, tok, NULL);
+
+	while ((tok = JsonbIteratorNext(&it, &jv, true)) == WJB_KEY)
+	{
+		bool		found = false;
+
+		for (i = 0; i < nkeys; i++)
+		{
+			if (jv.val.string.len == VARSIZE_ANY_EXHDR(keys[i]) &&
+				memcmp(jv.val.string.val, VARDATA_ANY(keys[i]),
+					   jv.val.string.len) == 0)
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+			pushJsonbValue(&jpstate, WJB_KEY, &jv);
+		tok = JsonbIteratorNext(&it, &jv, true);
+		Assert(tok == WJB_VALUE);
+		if (!found)
+			pushJsonbValue(&jpstate, WJB_VALUE, &jv);
+	}
+	Assert(tok == WJB_END_OBJECT);
+
+	/* then the given ones */
+	for (i = 0; i < nkeys; i++)
+	{
+		JsonbValue	key;
+
+		if (overridden[i] || valnulls[i])
+			continue;
+
+		key.type = jbvString;
+		key.val.string.len = VARSIZE_ANY_EXHDR(keys[i]);
+		key.val.string.val = VARDATA_ANY(keys[i]);
+		pushJsonbValue(&jpstate, WJB_KEY, &key);
+
+		JsonbToJsonbValue(DatumGetJsonbP(vals[i]), &jv);
+		pushJsonbValue(&jpstate, WJB_VALUE, &jv);
+	}
+
+	res = pushJsonbValue(&jpstate, WJB_END_OBJECT, NULL);
+
+	PG_RETURN_JSONB_P(JsonbValueToJsonb(res));
+}
+
 /*
  * Function to return a row containing the columns for the respective values
  * of insertVertex, insertEdge, deleteVertex, deleteEdge, and updateProperty.
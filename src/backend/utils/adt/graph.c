@@ -11,14 +11,17 @@
 #include "postgres.h"
 
 #include "ag_const.h"
+#include "access/genam.h"
 #include "access/hash.h"
 #include "access/htup_details.h"
 #include "access/tupdesc.h"
 #include "catalog/ag_graph_fn.h"
 #include "catalog/ag_label.h"
+#include "catalog/ag_label_fn.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_type.h"
 #include "executor/spi.h"
+#include "executor/tuptable.h"
 #include "funcapi.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
@@ -62,7 +65,41 @@ typedef struct LabelsOutData
 	Jsonb	   *labels;
 } LabelsOutData;
 
+/*
+ * A label opened to fetch vertices by id. The id index scan is kept open and
+ * rescanned for each fetch.
+ */
+typedef struct VertexLabelEntry
+{
+	Labid		labid;
+	Relation	rel;
+	Relation	index_rel;		/* btree on id, or NULL to scan the heap */
+	IndexScanDesc scan;
+	TupleTableSlot *slot;
+} VertexLabelEntry;
+
+struct GraphVertexCache
+{
+	MemoryContext mcxt;			/* for everything kept across fetches */
+	Oid			graphoid;
+	Snapshot	snapshot;
+	List	   *entries;		/* VertexLabelEntry's of the labels seen */
+	VertexLabelEntry *last_entry;
+};
+
 static void graphid_out_si(StringInfo si, Datum graphid);
+static void vertex_send_si(StringInfo buf, Datum vertex);
+static Datum vertex_recv_si(StringInfo buf);
+static void edge_send_si(StringInfo buf, Datum edge);
+static Datum edge_recv_si(StringInfo buf);
+static void prop_map_send_si(StringInfo buf, Datum prop_map);
+static Datum prop_map_recv_si(StringInfo buf);
+static void tid_send_si(StringInfo buf, Datum tid, bool isnull);
+static Datum tid_recv_si(StringInfo buf);
+static void elems_send_si(StringInfo buf, AnyArrayType *elems,
+						  void (*send_si) (StringInfo, Datum));
+static Datum *elems_recv_si(StringInfo buf, Datum (*recv_si) (StringInfo),
+							int *nelems);
 static int	graphid_cmp(FunctionCallInfo fcinfo);
 static Jsonb *int_to_jsonb(int i);
 static LabelOutData *cache_label(FmgrInfo *flinfo, uint16 labid);
@@ -77,6 +114,11 @@ static void deform_tuple(HeapTupleHeader tuphdr, Datum *values, bool *isnull);
 static Datum tuple_getattr(HeapTupleHeader tuphdr, int attnum);
 static LabelsOutData *cache_labels(FmgrInfo *flinfo, uint16 labid);
 static Datum makeArrayTypeDatum(Datum *elems, int nelem, Oid type);
+static VertexLabelEntry *get_vertex_label_entry(GraphVertexCache *cache,
+												Labid labid);
+static void begin_vertex_fetch(GraphVertexCache *cache,
+							   VertexLabelEntry *entry, ScanKey key);
+static int	graphid_ptr_cmp(const void *a, const void *b);
 static Datum graphid_minval(void);
 
 Datum
@@ -198,20 +240,47 @@ graphid_locid(PG_FUNCTION_ARGS)
 	PG_RETURN_INT64(GraphidGetLocid(id));
 }
 
+/*
+ * graph_labid() is called for every new vertex/edge by the DEFAULT expression
+ * of the id column with a constant label name. The label ID resolved first is
+ * kept in fn_extra not to parse the name and look up the catalog every time.
+ */
+typedef struct GraphLabidCache
+{
+	char	   *labname;
+	uint16		labid;
+} GraphLabidCache;
+
 Datum
 graph_labid(PG_FUNCTION_ARGS)
 {
 	char	   *labname = PG_GETARG_CSTRING(0);
+	GraphLabidCache *cache = (GraphLabidCache *) fcinfo->flinfo->fn_extra;
 	List	   *names;
 	RangeVar   *rv;
 	Oid			graphoid;
 	uint16		labid;
 
+	if (cache != NULL && strcmp(cache->labname, labname) == 0)
+		PG_RETURN_INT32((int32) cache->labid);
+
 	names = stringToQualifiedNameList(labname);
 	rv = makeRangeVarFromNameList(names);
 	graphoid = get_graphname_oid(rv->schemaname);
 	labid = get_labname_labid(rv->relname, graphoid);
 
+	if (cache == NULL)
+	{
+		cache = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt,
+								   sizeof(GraphLabidCache));
+		cache->labname = NULL;
+		fcinfo->flinfo->fn_extra = cache;
+	}
+	if (cache->labname != NULL)
+		pfree(cache->labname);
+	cache->labname = MemoryContextStrdup(fcinfo->flinfo->fn_mcxt, labname);
+	cache->labid = labid;
+
 	PG_RETURN_INT32((int32) labid);
 }
 
@@ -456,6 +525,81 @@ _vertex_out(PG_FUNCTION_ARGS)
 	PG_RETURN_CSTRING(si.data);
 }
 
+/*
+ * The binary format of vertex is
+ *
+ *	int64	id (label ID in the upper 16 bits and local ID in the rest)
+ *	int32	length of the property map, followed by it in jsonb_send() format
+ *	int32	block number of tid
+ *	int16	offset number of tid (0 if tid is NULL)
+ *
+ * There is no per-attribute type OID and length as in record_send().
+ */
+Datum
+vertex_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo	buf = (StringInfo) PG_GETARG_POINTER(0);
+
+	PG_RETURN_DATUM(vertex_recv_si(buf));
+}
+
+Datum
+vertex_send(PG_FUNCTION_ARGS)
+{
+	StringInfoData buf;
+
+	pq_begintypsend(&buf);
+	vertex_send_si(&buf, PG_GETARG_DATUM(0));
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+static void
+vertex_send_si(StringInfo buf, Datum vertex)
+{
+	Datum		values[Natts_ag_vertex];
+	bool		isnull[Natts_ag_vertex];
+
+	deform_tuple(DatumGetHeapTupleHeader(vertex), values, isnull);
+
+	if (isnull[Anum_ag_vertex_id - 1])
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("id in vertex cannot be NULL")));
+	if (isnull[Anum_ag_vertex_properties - 1])
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("properties in vertex cannot be NULL")));
+
+	pq_sendint64(buf, DatumGetGraphid(values[Anum_ag_vertex_id - 1]));
+	prop_map_send_si(buf, values[Anum_ag_vertex_properties - 1]);
+	tid_send_si(buf, values[Anum_ag_vertex_tid - 1],
+				isnull[Anum_ag_vertex_tid - 1]);
+}
+
+static Datum
+vertex_recv_si(StringInfo buf)
+{
+	Datum		values[Natts_ag_vertex];
+	bool		isnull[Natts_ag_vertex] = {false, false, false};
+	TupleDesc	tupDesc;
+	HeapTuple	vertex;
+
+	values[Anum_ag_vertex_id - 1] = GraphidGetDatum(pq_getmsgint64(buf));
+	values[Anum_ag_vertex_properties - 1] = prop_map_recv_si(buf);
+	values[Anum_ag_vertex_tid - 1] = tid_recv_si(buf);
+	isnull[Anum_ag_vertex_tid - 1] =
+		(values[Anum_ag_vertex_tid - 1] == (Datum) 0);
+
+	tupDesc = lookup_rowtype_tupdesc(VERTEXOID, -1);
+	Assert(tupDesc->natts == Natts_ag_vertex);
+
+	vertex = heap_form_tuple(tupDesc, values, isnull);
+
+	ReleaseTupleDesc(tupDesc);
+
+	return HeapTupleGetDatum(vertex);
+}
+
 Datum
 vertex_label(PG_FUNCTION_ARGS)
 {
@@ -624,6 +768,169 @@ _edge_out(PG_FUNCTION_ARGS)
 	PG_RETURN_CSTRING(si.data);
 }
 
+/*
+ * The binary format of edge is that of vertex with the IDs of the start and
+ * end vertices, as int64, after its own ID.
+ */
+Datum
+edge_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo	buf = (StringInfo) PG_GETARG_POINTER(0);
+
+	PG_RETURN_DATUM(edge_recv_si(buf));
+}
+
+Datum
+edge_send(PG_FUNCTION_ARGS)
+{
+	StringInfoData buf;
+
+	pq_begintypsend(&buf);
+	edge_send_si(&buf, PG_GETARG_DATUM(0));
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+static void
+edge_send_si(StringInfo buf, Datum edge)
+{
+	Datum		values[Natts_ag_edge];
+	bool		isnull[Natts_ag_edge];
+
+	deform_tuple(DatumGetHeapTupleHeader(edge), values, isnull);
+
+	if (isnull[Anum_ag_edge_id - 1])
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("id in edge cannot be NULL")));
+	if (isnull[Anum_ag_edge_start - 1])
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("start in edge cannot be NULL")));
+	if (isnull[Anum_ag_edge_end - 1])
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("end in edge cannot be NULL")));
+	if (isnull[Anum_ag_edge_properties - 1])
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("properties in edge cannot be NULL")));
+
+	pq_sendint64(buf, DatumGetGraphid(values[Anum_ag_edge_id - 1]));
+	pq_sendint64(buf, DatumGetGraphid(values[Anum_ag_edge_start - 1]));
+	pq_sendint64(buf, DatumGetGraphid(values[Anum_ag_edge_end - 1]));
+	prop_map_send_si(buf, values[Anum_ag_edge_properties - 1]);
+	tid_send_si(buf, values[Anum_ag_edge_tid - 1],
+				isnull[Anum_ag_edge_tid - 1]);
+}
+
+static Datum
+edge_recv_si(StringInfo buf)
+{
+	Datum		values[Natts_ag_edge];
+	bool		isnull[Natts_ag_edge] = {false, false, false, false, false};
+	TupleDesc	tupDesc;
+	HeapTuple	edge;
+
+	values[Anum_ag_edge_id - 1] = GraphidGetDatum(pq_getmsgint64(buf));
+	values[Anum_ag_edge_start - 1] = GraphidGetDatum(pq_getmsgint64(buf));
+	values[Anum_ag_edge_end - 1] = GraphidGetDatum(pq_getmsgint64(buf));
+	values[Anum_ag_edge_properties - 1] = prop_map_recv_si(buf);
+	values[Anum_ag_edge_tid - 1] = tid_recv_si(buf);
+	isnull[Anum_ag_edge_tid - 1] = (values[Anum_ag_edge_tid - 1] == (Datum) 0);
+
+	tupDesc = lookup_rowtype_tupdesc(EDGEOID, -1);
+	Assert(tupDesc->natts == Natts_ag_edge);
+
+	edge = heap_form_tuple(tupDesc, values, isnull);
+
+	ReleaseTupleDesc(tupDesc);
+
+	return HeapTupleGetDatum(edge);
+}
+
+static void
+prop_map_send_si(StringInfo buf, Datum prop_map)
+{
+	bytea	   *jb;
+
+	jb = DatumGetByteaPP(DirectFunctionCall1(jsonb_send, prop_map));
+	pq_sendint32(buf, VARSIZE_ANY_EXHDR(jb));
+	pq_sendbytes(buf, VARDATA_ANY(jb), VARSIZE_ANY_EXHDR(jb));
+}
+
+/* See record_recv() */
+static Datum
+prop_map_recv_si(StringInfo buf)
+{
+	int			len;
+	StringInfoData item_buf;
+	char		csave;
+	Datum		prop_map;
+
+	len = pq_getmsgint(buf, 4);
+	if (len < 0 || len > (buf->len - buf->cursor))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("insufficient data left in message")));
+
+	item_buf.data = &buf->data[buf->cursor];
+	item_buf.maxlen = len + 1;
+	item_buf.len = len;
+	item_buf.cursor = 0;
+
+	buf->cursor += len;
+
+	csave = buf->data[buf->cursor];
+	buf->data[buf->cursor] = '\0';
+
+	prop_map = DirectFunctionCall1(jsonb_recv, PointerGetDatum(&item_buf));
+
+	if (item_buf.cursor != item_buf.len)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("improper binary format in properties")));
+
+	buf->data[buf->cursor] = csave;
+
+	return prop_map;
+}
+
+static void
+tid_send_si(StringInfo buf, Datum tid, bool isnull)
+{
+	if (isnull)
+	{
+		pq_sendint32(buf, InvalidBlockNumber);
+		pq_sendint16(buf, InvalidOffsetNumber);
+	}
+	else
+	{
+		ItemPointer itemPtr = DatumGetItemPointer(tid);
+
+		pq_sendint32(buf, ItemPointerGetBlockNumberNoCheck(itemPtr));
+		pq_sendint16(buf, ItemPointerGetOffsetNumberNoCheck(itemPtr));
+	}
+}
+
+/* returns (Datum) 0 for NULL */
+static Datum
+tid_recv_si(StringInfo buf)
+{
+	BlockNumber blockNumber;
+	OffsetNumber offsetNumber;
+	ItemPointer tid;
+
+	blockNumber = pq_getmsgint(buf, sizeof(blockNumber));
+	offsetNumber = pq_getmsgint(buf, sizeof(offsetNumber));
+	if (offsetNumber == InvalidOffsetNumber)
+		return (Datum) 0;
+
+	tid = (ItemPointer) palloc(sizeof(ItemPointerData));
+	ItemPointerSet(tid, blockNumber, offsetNumber);
+
+	return ItemPointerGetDatum(tid);
+}
+
 Datum
 edge_label(PG_FUNCTION_ARGS)
 {
@@ -878,6 +1185,99 @@ graphpath_out(PG_FUNCTION_ARGS)
 	PG_RETURN_CSTRING(si.data);
 }
 
+/*
+ * The binary format of graphpath is
+ *
+ *	int32	number of vertices, followed by the vertices
+ *	int32	number of edges, followed by the edges
+ *
+ * Each vertex and edge is in the format of vertex_send() and edge_send()
+ * without a length word.
+ */
+Datum
+graphpath_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo	buf = (StringInfo) PG_GETARG_POINTER(0);
+	Datum	   *vertices;
+	Datum	   *edges;
+	int			nvertices;
+	int			nedges;
+
+	vertices = elems_recv_si(buf, vertex_recv_si, &nvertices);
+	edges = elems_recv_si(buf, edge_recv_si, &nedges);
+
+	/* a path has one more vertex than edges, unless it is empty */
+	if ((nvertices > 0 || nedges > 0) && nvertices != nedges + 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("the numbers of vertices and edges are mismatched")));
+
+	PG_RETURN_DATUM(makeGraphpathDatum(vertices, nvertices, edges, nedges));
+}
+
+Datum
+graphpath_send(PG_FUNCTION_ARGS)
+{
+	Datum		vertices_datum;
+	Datum		edges_datum;
+	StringInfoData buf;
+
+	getGraphpathArrays(PG_GETARG_DATUM(0), &vertices_datum, &edges_datum);
+
+	pq_begintypsend(&buf);
+	elems_send_si(&buf, DatumGetAnyArrayP(vertices_datum), vertex_send_si);
+	elems_send_si(&buf, DatumGetAnyArrayP(edges_datum), edge_send_si);
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+static void
+elems_send_si(StringInfo buf, AnyArrayType *elems,
+			  void (*send_si) (StringInfo, Datum))
+{
+	int			nelems;
+	array_iter	it;
+	int			i;
+
+	nelems = ArrayGetNItems(AARR_NDIM(elems), AARR_DIMS(elems));
+	pq_sendint32(buf, nelems);
+
+	array_iter_setup(&it, elems);
+	for (i = 0; i < nelems; i++)
+	{
+		bool		isnull;
+		Datum		value;
+
+		/* vertex and edge are both varlena and double-aligned */
+		value = array_iter_next(&it, &isnull, i, -1, false, TYPALIGN_DOUBLE);
+		if (isnull)
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("graphpath cannot have NULL elements")));
+
+		send_si(buf, value);
+	}
+}
+
+static Datum *
+elems_recv_si(StringInfo buf, Datum (*recv_si) (StringInfo), int *nelems)
+{
+	Datum	   *elems;
+	int			i;
+
+	*nelems = pq_getmsgint(buf, 4);
+	/* each element takes more than 8 bytes, don't allocate too much */
+	if (*nelems < 0 || *nelems > (buf->len - buf->cursor) / 8)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("invalid number of graphpath elements: %d", *nelems)));
+
+	elems = palloc(sizeof(Datum) * Max(*nelems, 1));
+	for (i = 0; i < *nelems; i++)
+		elems[i] = recv_si(buf);
+
+	return elems;
+}
+
 static void
 get_elem_type_output(ArrayMetaState *state, Oid elem_type, MemoryContext mctx)
 {
@@ -1014,42 +1414,266 @@ edge_end_vertex(PG_FUNCTION_ARGS)
 	return ret;
 }
 
+/*
+ * Creates a cache for fetching vertices by graphid, which keeps the vertex
+ * labels and their id indexes open until free_graph_vertex_cache() is called.
+ * It must be freed before the end of the current query. The cache lives in
+ * the current memory context, so the vertices can be fetched in a shorter
+ * lived one.
+ */
+GraphVertexCache *
+create_graph_vertex_cache(Snapshot snapshot)
+{
+	GraphVertexCache *cache = palloc(sizeof(GraphVertexCache));
+
+	cache->mcxt = CurrentMemoryContext;
+	cache->graphoid = get_graph_path_oid();
+	cache->snapshot = snapshot;
+	cache->entries = NIL;
+	cache->last_entry = NULL;
+
+	return cache;
+}
+
+void
+free_graph_vertex_cache(GraphVertexCache *cache)
+{
+	ListCell   *lc;
+
+	foreach(lc, cache->entries)
+	{
+		VertexLabelEntry *entry = lfirst(lc);
+
+		if (entry->scan != NULL)
+			index_endscan(entry->scan);
+		if (entry->index_rel != NULL)
+			index_close(entry->index_rel, AccessShareLock);
+		ExecDropSingleTupleTableSlot(entry->slot);
+		table_close(entry->rel, AccessShareLock);
+		pfree(entry);
+	}
+	list_free(cache->entries);
+	pfree(cache);
+}
+
+static VertexLabelEntry *
+get_vertex_label_entry(GraphVertexCache *cache, Labid labid)
+{
+	VertexLabelEntry *entry;
+	ListCell   *lc;
+	Oid			index_oid;
+	MemoryContext oldcxt;
+
+	if (cache->last_entry != NULL && cache->last_entry->labid == labid)
+		return cache->last_entry;
+
+	foreach(lc, cache->entries)
+	{
+		entry = lfirst(lc);
+
+		if (entry->labid == labid)
+		{
+			cache->last_entry = entry;
+			return entry;
+		}
+	}
+
+	oldcxt = MemoryContextSwitchTo(cache->mcxt);
+
+	entry = palloc(sizeof(VertexLabelEntry));
+	entry->labid = labid;
+	entry->rel = table_open(get_labid_relid(cache->graphoid, labid),
+							AccessShareLock);
+	entry->slot = table_slot_create(entry->rel, NULL);
+	entry->scan = NULL;
+
+	index_oid = get_label_btree_index(entry->rel, Anum_table_vertex_id);
+	if (OidIsValid(index_oid))
+		entry->index_rel = index_open(index_oid, AccessShareLock);
+	else
+		entry->index_rel = NULL;
+
+	cache->entries = lappend(cache->entries, entry);
+	cache->last_entry = entry;
+
+	MemoryContextSwitchTo(oldcxt);
+
+	return entry;
+}
+
+/*
+ * Starts fetching the vertices of the label whose id matches `key`, which is
+ * a scan key on the leading column of the id index.
+ */
+static void
+begin_vertex_fetch(GraphVertexCache *cache, VertexLabelEntry *entry,
+				   ScanKey key)
+{
+	MemoryContext oldcxt = MemoryContextSwitchTo(cache->mcxt);
+
+	if (entry->scan == NULL)
+		entry->scan = index_beginscan(entry->rel, entry->index_rel,
+									  cache->snapshot, 1, 0);
+	index_rescan(entry->scan, key, 1, NULL, 0);
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
 Datum
-get_vertex_from_graphid(Graphid vertex_id)
+get_vertex_from_graphid_cached(GraphVertexCache *cache, Graphid vertex_id)
 {
-	Labid		vertex_label_id;
-	Oid			vertex_label_relid;
-	Oid			graph_path_oid = get_graph_path_oid();
-	Relation	vertex_rel;
-	TableScanDesc scan_desc;
+	VertexLabelEntry *entry;
 	ScanKeyData scan_key_data;
-	TupleTableSlot *slot;
 	Datum		ret = (Datum) 0;
 
-	vertex_label_id = GraphidGetLabid(vertex_id);
+	entry = get_vertex_label_entry(cache, GraphidGetLabid(vertex_id));
+
+	if (entry->index_rel != NULL)
+	{
+		ScanKeyInit(&scan_key_data,
+					1,
+					BTEqualStrategyNumber, F_GRAPHID_EQ,
+					GraphidGetDatum(vertex_id));
+		begin_vertex_fetch(cache, entry, &scan_key_data);
+
+		if (index_getnext_slot(entry->scan, ForwardScanDirection, entry->slot))
+		{
+			slot_getallattrs(entry->slot);
+			ret = make_vertex_from_tuple(entry->slot);
+		}
+	}
+	else
+	{
+		TableScanDesc scan_desc;
+
+		ScanKeyInit(&scan_key_data,
+					Anum_table_vertex_id,
+					BTEqualStrategyNumber, F_GRAPHID_EQ,
+					GraphidGetDatum(vertex_id));
+
+		scan_desc = table_beginscan(entry->rel, cache->snapshot,
+									1, &scan_key_data);
+
+		if (table_scan_getnextslot(scan_desc, ForwardScanDirection,
+								   entry->slot))
+		{
+			slot_getallattrs(entry->slot);
+			ret = make_vertex_from_tuple(entry->slot);
+		}
 
-	vertex_label_relid = get_labid_relid(graph_path_oid, vertex_label_id);
-	vertex_rel = table_open(vertex_label_relid, AccessShareLock);
-	slot = table_slot_create(vertex_rel, NULL);
+		table_endscan(scan_desc);
+	}
 
-	ScanKeyInit(&scan_key_data,
-				Anum_table_vertex_id,
-				BTEqualStrategyNumber, F_GRAPHID_EQ,
-				GraphidGetDatum(vertex_id));
+	ExecClearTuple(entry->slot);
 
-	scan_desc = table_beginscan(vertex_rel,
-								GetActiveSnapshot(),
-								1, &scan_key_data);
+	return ret;
+}
 
-	if (table_scan_getnextslot(scan_desc, ForwardScanDirection, slot))
+static int
+graphid_ptr_cmp(const void *a, const void *b)
+{
+	Graphid		id1 = **(Graphid *const *) a;
+	Graphid		id2 = **(Graphid *const *) b;
+
+	if (id1 < id2)
+		return -1;
+	if (id1 > id2)
+		return 1;
+	return 0;
+}
+
+/*
+ * Fetches the vertices of `nvertices` graphids into `vertices`. The ids are
+ * grouped by label and each label is probed with a single index scan for all
+ * of its ids, in index order. (Datum) 0 is set for ids that have no vertex.
+ */
+void
+get_vertices_from_graphids(GraphVertexCache *cache, Graphid *vertex_ids,
+						   int nvertices, Datum *vertices)
+{
+	Graphid   **sorted_ids;
+	Datum	   *elems;
+	int			i;
+
+	if (nvertices <= 0)
+		return;
+
+	sorted_ids = palloc(nvertices * sizeof(Graphid *));
+	for (i = 0; i < nvertices; i++)
 	{
-		slot_getallattrs(slot);
-		ret = make_vertex_from_tuple(slot);
+		sorted_ids[i] = &vertex_ids[i];
+		vertices[i] = (Datum) 0;
 	}
+	qsort(sorted_ids, nvertices, sizeof(Graphid *), graphid_ptr_cmp);
+
+	elems = palloc(nvertices * sizeof(Datum));
+
+	i = 0;
+	while (i < nvertices)
+	{
+		Labid		labid = GraphidGetLabid(*sorted_ids[i]);
+		VertexLabelEntry *entry = get_vertex_label_entry(cache, labid);
+		ScanKeyData scan_key_data;
+		int			nelems = 0;
+		int			j;
+
+		for (j = i; j < nvertices && GraphidGetLabid(*sorted_ids[j]) == labid; j++)
+		{
+			if (nelems == 0 || DatumGetGraphid(elems[nelems - 1]) != *sorted_ids[j])
+				elems[nelems++] = GraphidGetDatum(*sorted_ids[j]);
+		}
+
+		if (entry->index_rel == NULL)
+		{
+			for (; i < j; i++)
+				vertices[sorted_ids[i] - vertex_ids] =
+					get_vertex_from_graphid_cached(cache, *sorted_ids[i]);
+			continue;
+		}
+
+		ScanKeyEntryInitialize(&scan_key_data,
+							   SK_SEARCHARRAY,
+							   1,
+							   BTEqualStrategyNumber,
+							   GRAPHIDOID,
+							   InvalidOid,
+							   F_GRAPHID_EQ,
+							   makeArrayTypeDatum(elems, nelems, GRAPHIDOID));
+		begin_vertex_fetch(cache, entry, &scan_key_data);
+
+		/* the index returns the vertices in the order of the sorted ids */
+		while (index_getnext_slot(entry->scan, ForwardScanDirection,
+								  entry->slot))
+		{
+			Graphid		id;
+			Datum		vertex;
+
+			slot_getallattrs(entry->slot);
+			id = DatumGetGraphid(entry->slot->tts_values[Anum_table_vertex_id - 1]);
+			vertex = make_vertex_from_tuple(entry->slot);
+
+			while (i < j && *sorted_ids[i] < id)
+				i++;
+			for (; i < j && *sorted_ids[i] == id; i++)
+				vertices[sorted_ids[i] - vertex_ids] = vertex;
+		}
+
+		ExecClearTuple(entry->slot);
+		i = j;
+	}
+
+	pfree(elems);
+	pfree(sorted_ids);
+}
+
+Datum
+get_vertex_from_graphid(Graphid vertex_id)
+{
+	GraphVertexCache *cache = create_graph_vertex_cache(GetActiveSnapshot());
+	Datum		ret;
 
-	table_endscan(scan_desc);
-	table_close(vertex_rel, NoLock);
-	ExecDropSingleTupleTableSlot(slot);
+	ret = get_vertex_from_graphid_cached(cache, vertex_id);
+	free_graph_vertex_cache(cache);
 
 	return ret;
 }
@@ -10,23 +10,157 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
 #include "access/heapam.h"
 #include "access/htup_details.h"
 #include "catalog/ag_graphmeta.h"
 #include "catalog/ag_label.h"
-#include "catalog/ag_edge_d.h"
 #include "catalog/indexing.h"
+#include "catalog/pg_authid.h"
+#include "catalog/pg_class.h"
+#include "executor/spi.h"
+#include "funcapi.h"
+#include "lib/stringinfo.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "utils/builtins.h"
+#include "utils/catcache.h"
+#include "utils/graph.h"
+#include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
+#include "utils/syscache.h"
+#include "utils/tuplestore.h"
 
-static void merge_meta(Relation rel);
-static void scan_label(Oid relid, Oid graphid);
+/* an edge label to count the edges of */
+typedef struct GatherLabel
+{
+	Oid			relid;
+	Oid			graph;
+	Labid		labid;
+	PgStat_Counter changes;		/* pgstat change counter, -1 if unknown */
+	Oid			relfilenode;
+} GatherLabel;
+
+static bool regather(bool incremental);
+static PgStat_Counter label_changes(Oid relid);
+static void gather_labels(List *labels, HTAB *htab);
+static void merge_meta(Relation rel, HTAB *htab);
 
-HTAB	   *htab;
-HASHCTL		hash_ctl;
+/*
+ * label_changes
+ *
+ * Returns the number of edges ever inserted into or deleted from the label as
+ * counted by pgstat. Updates are not counted because they do not change the
+ * labels of the edge and its vertices.
+ */
+static PgStat_Counter
+label_changes(Oid relid)
+{
+	PgStat_StatTabEntry *tabentry;
 
-void
-merge_meta(Relation rel)
+	tabentry = pgstat_fetch_stat_tabentry(relid);
+	if (tabentry == NULL)
+		return -1;
+
+	return tabentry->tuples_inserted + tabentry->tuples_deleted;
+}
+
+/*
+ * gather_labels
+ *
+ * Counts the edges of the given labels per edge label triple into htab. The
+ * labels are counted by a single aggregate query over all of them so that
+ * the planner can spread the scan over parallel workers, across the labels
+ * and across the blocks of each label.
+ */
+static void
+gather_labels(List *labels, HTAB *htab)
+{
+	StringInfoData query;
+	bool		first = true;
+	ListCell   *lc;
+	Oid			save_userid;
+	int			save_sec_context;
+	int			ret;
+	uint64		i;
+
+	initStringInfo(&query);
+	appendStringInfoString(&query,
+						   "SELECT graph, edge, start, \"end\", pg_catalog.count(*) FROM (");
+	foreach(lc, labels)
+	{
+		GatherLabel *label = lfirst(lc);
+		char	   *relname;
+		char	   *nspname;
+
+		relname = get_rel_name(label->relid);
+		if (relname == NULL)
+			continue;
+		nspname = get_namespace_name(get_rel_namespace(label->relid));
+
+		if (!first)
+			appendStringInfoString(&query, " UNION ALL ");
+		first = false;
+
+		appendStringInfo(&query,
+						 "SELECT %u::pg_catalog.oid AS graph, "
+						 "pg_catalog.graphid_labid(id) AS edge, "
+						 "pg_catalog.graphid_labid(start) AS start, "
+						 "pg_catalog.graphid_labid(\"end\") AS \"end\" "
+						 "FROM ONLY %s",
+						 label->graph,
+						 quote_qualified_identifier(nspname, relname));
+	}
+	appendStringInfoString(&query, ") AS e GROUP BY 1, 2, 3, 4");
+
+	if (first)
+		return;
+
+	/* count every edge regardless of the privileges of the caller */
+	GetUserIdAndSecContext(&save_userid, &save_sec_context);
+	SetUserIdAndSecContext(BOOTSTRAP_SUPERUSERID,
+						   save_sec_context | SECURITY_LOCAL_USERID_CHANGE |
+						   SECURITY_RESTRICTED_OPERATION);
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "SPI_connect failed");
+
+	ret = SPI_execute(query.data, true, 0);
+	if (ret != SPI_OK_SELECT)
+		elog(ERROR, "SPI_execute failed: error code %d", ret);
+
+	for (i = 0; i < SPI_processed; i++)
+	{
+		HeapTuple	tup = SPI_tuptable->vals[i];
+		TupleDesc	tupdesc = SPI_tuptable->tupdesc;
+		AgStat_key	key;
+		AgStat_GraphMeta *meta_elem;
+		bool		isnull;
+
+		memset(&key, 0, sizeof(key));
+		key.graph = DatumGetObjectId(SPI_getbinval(tup, tupdesc, 1, &isnull));
+		key.edge = DatumGetInt32(SPI_getbinval(tup, tupdesc, 2, &isnull));
+		key.start = DatumGetInt32(SPI_getbinval(tup, tupdesc, 3, &isnull));
+		key.end = DatumGetInt32(SPI_getbinval(tup, tupdesc, 4, &isnull));
+
+		/* key is copied already */
+		meta_elem = (AgStat_GraphMeta *) hash_search(htab, (void *) &key,
+													 HASH_ENTER, NULL);
+		meta_elem->edges_inserted =
+			DatumGetInt64(SPI_getbinval(tup, tupdesc, 5, &isnull));
+		meta_elem->edges_deleted = 0;
+	}
+
+	SPI_finish();
+
+	SetUserIdAndSecContext(save_userid, save_sec_context);
+
+	pfree(query.data);
+}
+
+static void
+merge_meta(Relation rel, HTAB *htab)
 {
 	AgStat_GraphMeta *meta_elem;
 	HASH_SEQ_STATUS seq;
@@ -60,84 +194,92 @@ merge_meta(Relation rel)
 	}
 }
 
-void
-scan_label(Oid relid, Oid graphid)
+/*
+ * regather
+ *
+ * Rebuilds ag_graphmeta by counting the edges of every edge label, or, if
+ * incremental, of the edge labels that have changed since they were counted
+ * last time.
+ */
+static bool
+regather(bool incremental)
 {
+	List	   *labels = NIL;
 	Relation	rel;
 	HeapTuple	tup;
 	Snapshot	snapshot;
+	SysScanDesc sscan;
 	TableScanDesc scan;
+	HASHCTL		hash_ctl;
+	HTAB	   *htab;
+	ListCell   *lc;
 
-	AgStat_key	key;
-	AgStat_GraphMeta *meta_elem;
+	if (auto_gather_graphmeta)
+	{
+		ereport(NOTICE,
+				(errmsg("Set auto_gather_graphmeta to FALSE before regather_graphmeta()")));
+		return false;
+	}
 
-	rel = table_open(relid, AccessShareLock);
-	snapshot = RegisterSnapshot(GetLatestSnapshot());
-	scan = table_beginscan(rel, snapshot, 0, NULL);
+	/*
+	 * Collect the edge labels to count. Their change counters are read before
+	 * the edges are counted, so that the counters cannot include changes the
+	 * count does not.
+	 */
+	rel = table_open(LabelRelationId, AccessShareLock);
+	sscan = systable_beginscan(rel, InvalidOid, false, NULL, 0, NULL);
+	while (HeapTupleIsValid(tup = systable_getnext(sscan)))
+	{
+		Form_ag_label labtup = (Form_ag_label) GETSTRUCT(tup);
+		GatherLabel *label;
+		HeapTuple	reltup;
 
-	memset(&key, 0, sizeof(key));
+		/* Gather meta from only edges */
+		if (labtup->labkind != LABEL_KIND_EDGE)
+			continue;
 
-	while ((tup = heap_getnext(scan, ForwardScanDirection)) != NULL)
-	{
-		Datum		dat;
-		Labid		edge;
-		Labid		start;
-		Labid		end;
-		bool		found;
-		bool		isnull;
+		reltup = SearchSysCache1(RELOID, ObjectIdGetDatum(labtup->relid));
+		if (!HeapTupleIsValid(reltup))
+			continue;
 
-		dat = heap_getattr(tup, Anum_ag_edge_id,
-						   RelationGetDescr(rel), &isnull);
-		edge = GraphidGetLabid(DatumGetGraphid(dat));
-
-		dat = heap_getattr(tup, Anum_ag_edge_start,
-						   RelationGetDescr(rel), &isnull);
-		start = GraphidGetLabid(DatumGetGraphid(dat));
-
-		dat = heap_getattr(tup, Anum_ag_edge_end,
-						   RelationGetDescr(rel), &isnull);
-		end = GraphidGetLabid(DatumGetGraphid(dat));
-
-		key.graph = graphid;
-		key.edge = edge;
-		key.start = start;
-		key.end = end;
-		meta_elem = (AgStat_GraphMeta *) hash_search(htab,
-													 (void *) &key,
-													 HASH_ENTER, &found);
-		if (found)
-			meta_elem->edges_inserted++;
-		else
+		label = palloc(sizeof(*label));
+		label->relid = labtup->relid;
+		label->graph = labtup->graphid;
+		label->labid = labtup->labid;
+		label->changes = label_changes(labtup->relid);
+		label->relfilenode = ((Form_pg_class) GETSTRUCT(reltup))->relfilenode;
+		ReleaseSysCache(reltup);
+
+		if (incremental &&
+			agstat_label_gathered(label->relid, label->changes,
+								  label->relfilenode))
 		{
-			/* key is copied already */
-			meta_elem->edges_inserted = 1;
-			meta_elem->edges_deleted = 0;
+			pfree(label);
+			continue;
 		}
+
+		labels = lappend(labels, label);
 	}
-	table_endscan(scan);
-	UnregisterSnapshot(snapshot);
+	systable_endscan(sscan);
 	table_close(rel, AccessShareLock);
-}
 
-Datum
-regather_graphmeta(PG_FUNCTION_ARGS)
-{
-	Relation	rel;
-	HeapTuple	tup;
-	Snapshot	snapshot;
-	TableScanDesc scan;
+	/* the edges are counted again below */
+	if (incremental)
+	{
+		foreach(lc, labels)
+		{
+			GatherLabel *label = lfirst(lc);
 
-	if (auto_gather_graphmeta)
+			agstat_discard_pending_graphmeta(label->graph, InvalidLabid,
+											 label->labid);
+		}
+	}
+	else
 	{
-		ereport(NOTICE,
-				(errmsg("Set auto_gather_graphmeta to FALSE before regather_graphmeta()")));
-		PG_RETURN_BOOL(false);
+		agstat_discard_pending_graphmeta(InvalidOid, InvalidLabid,
+										 InvalidLabid);
 	}
 
-	rel = table_open(LabelRelationId, AccessShareLock);
-	snapshot = RegisterSnapshot(GetLatestSnapshot());
-	scan = table_beginscan(rel, snapshot, 0, NULL);
-
 	/* hash initialize */
 	memset(&hash_ctl, 0, sizeof(hash_ctl));
 	hash_ctl.keysize = sizeof(AgStat_key);
@@ -148,47 +290,186 @@ regather_graphmeta(PG_FUNCTION_ARGS)
 					   &hash_ctl,
 					   HASH_ELEM | HASH_BLOBS);
 
-	/* Scan all graph label */
-	while ((tup = heap_getnext(scan, ForwardScanDirection)) != NULL)
+	gather_labels(labels, htab);
+
+	/* delete meta */
+	rel = table_open(GraphMetaRelationId, RowExclusiveLock);
+	if (incremental)
 	{
-		Datum		relid;
-		Datum		graphid;
-		char		labkind;
-		bool		isnull;
+		foreach(lc, labels)
+		{
+			GatherLabel *label = lfirst(lc);
+			CatCList   *metalist;
+			int			i;
+
+			metalist = SearchSysCacheList2(GRAPHMETAFULL,
+										   ObjectIdGetDatum(label->graph),
+										   Int16GetDatum(label->labid));
+			for (i = 0; i < metalist->n_members; i++)
+				CatalogTupleDelete(rel, &metalist->members[i]->tuple.t_self);
+			ReleaseSysCacheList(metalist);
+		}
+	}
+	else
+	{
+		snapshot = RegisterSnapshot(GetLatestSnapshot());
+		scan = table_beginscan(rel, snapshot, 0, NULL);
 
-		labkind = heap_getattr(tup, Anum_ag_label_labkind,
-							   RelationGetDescr(rel), &isnull);
+		while ((tup = heap_getnext(scan, ForwardScanDirection)) != NULL)
+			simple_heap_delete(rel, &tup->t_self);
 
-		/* Gather meta from only edges */
-		if (labkind == LABEL_KIND_VERTEX)
-			continue;
+		table_endscan(scan);
+		UnregisterSnapshot(snapshot);
+	}
+
+	/* merge hash table data with meta catalog */
+	merge_meta(rel, htab);
+
+	table_close(rel, RowExclusiveLock);
+
+	hash_destroy(htab);
 
-		relid = heap_getattr(tup, Anum_ag_label_relid,
-							 RelationGetDescr(rel), &isnull);
+	foreach(lc, labels)
+	{
+		GatherLabel *label = lfirst(lc);
+
+		agstat_remember_gathered_label(label->relid, label->changes,
+									   label->relfilenode);
+	}
+	list_free_deep(labels);
+
+	return true;
+}
+
+Datum
+regather_graphmeta(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BOOL(regather(false));
+}
+
+/*
+ * regather_graphmeta_incremental
+ *
+ * Like regather_graphmeta(), but if incremental, recounts only the edge
+ * labels that have changed since they were counted last time.
+ */
+Datum
+regather_graphmeta_incremental(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_BOOL(regather(PG_GETARG_BOOL(0)));
+}
 
-		graphid = heap_getattr(tup, Anum_ag_label_graphid,
-							   RelationGetDescr(rel), &isnull);
+/*
+ * ag_graphmeta_current
+ *
+ * Returns the rows of ag_graphmeta with the edge counts that are not folded
+ * into it yet added.
+ */
+Datum
+ag_graphmeta_current(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	HTAB	   *counts;
+	HASHCTL		ctl;
+	Relation	rel;
+	SysScanDesc scan;
+	HeapTuple	tup;
+	ListCell   *lc;
+	AgStat_GraphMeta *meta_elem;
+	HASH_SEQ_STATUS seq;
 
-		scan_label(DatumGetObjectId(relid), DatumGetObjectId(graphid));
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	memset(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(AgStat_key);
+	ctl.entrysize = sizeof(AgStat_GraphMeta);
+	ctl.hcxt = CurrentMemoryContext;
+	counts = hash_create("current graphmeta", 1024, &ctl,
+						 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	rel = table_open(GraphMetaRelationId, AccessShareLock);
+	scan = systable_beginscan(rel, InvalidOid, false, NULL, 0, NULL);
+	while (HeapTupleIsValid(tup = systable_getnext(scan)))
+	{
+		Form_ag_graphmeta metatup = (Form_ag_graphmeta) GETSTRUCT(tup);
+		AgStat_key	key;
+
+		memset(&key, 0, sizeof(key));
+		key.graph = metatup->graph;
+		key.edge = metatup->edge;
+		key.start = metatup->start;
+		key.end = metatup->end;
+
+		meta_elem = hash_search(counts, &key, HASH_ENTER, NULL);
+		meta_elem->edges_inserted = metatup->edgecount;
+		meta_elem->edges_deleted = 0;
 	}
-	table_endscan(scan);
-	UnregisterSnapshot(snapshot);
+	systable_endscan(scan);
 	table_close(rel, AccessShareLock);
 
-	/* delete meta */
-	rel = table_open(GraphMetaRelationId, RowExclusiveLock);
-	snapshot = RegisterSnapshot(GetLatestSnapshot());
-	scan = table_beginscan(rel, snapshot, 0, NULL);
+	foreach(lc, agstat_get_pending_graphmeta(InvalidOid))
+	{
+		AgStat_GraphMeta *pending = lfirst(lc);
+		bool		found;
 
-	while ((tup = heap_getnext(scan, ForwardScanDirection)) != NULL)
-		simple_heap_delete(rel, &tup->t_self);
+		meta_elem = hash_search(counts, &pending->key, HASH_ENTER, &found);
+		if (!found)
+		{
+			meta_elem->edges_inserted = 0;
+			meta_elem->edges_deleted = 0;
+		}
+		meta_elem->edges_inserted += pending->edges_inserted;
+		meta_elem->edges_deleted += pending->edges_deleted;
+	}
 
-	/* merge hash table data with meta catalog */
-	merge_meta(rel);
+	hash_seq_init(&seq, counts);
+	while ((meta_elem = hash_seq_search(&seq)) != NULL)
+	{
+		Datum		values[Natts_ag_graphmeta];
+		bool		nulls[Natts_ag_graphmeta];
+		int64		edgecount;
 
-	table_endscan(scan);
-	UnregisterSnapshot(snapshot);
-	table_close(rel, RowExclusiveLock);
+		edgecount = meta_elem->edges_inserted - meta_elem->edges_deleted;
+		if (edgecount <= 0)
+			continue;
+
+		memset(nulls, false, sizeof(nulls));
+		values[Anum_ag_graphmeta_graph - 1] = ObjectIdGetDatum(meta_elem->key.graph);
+		values[Anum_ag_graphmeta_edge - 1] = Int16GetDatum(meta_elem->key.edge);
+		values[Anum_ag_graphmeta_start - 1] = Int16GetDatum(meta_elem->key.start);
+		values[Anum_ag_graphmeta_end - 1] = Int16GetDatum(meta_elem->key.end);
+		values[Anum_ag_graphmeta_edgecount - 1] = Int64GetDatum(edgecount);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	hash_destroy(counts);
 
-	PG_RETURN_BOOL(true);
+	return (Datum) 0;
 }
@@ -103,6 +103,9 @@
 #include "access/table.h"
 #include "access/tableam.h"
 #include "access/visibilitymap.h"
+#include "ag_const.h"
+#include "catalog/ag_graphmeta.h"
+#include "catalog/ag_label.h"
 #include "catalog/pg_am.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_operator.h"
@@ -160,6 +163,13 @@ static double eqjoinsel_semi(Oid opfuncoid, Oid collation,
 							 Form_pg_statistic stats1, Form_pg_statistic stats2,
 							 bool have_mcvs1, bool have_mcvs2,
 							 RelOptInfo *inner_rel);
+static const char *graph_label_column(PlannerInfo *root,
+									  VariableStatData *vardata,
+									  Oid *graphoid, char *labkind,
+									  List **labids, double *ntuples);
+static bool graphmeta_joinsel(PlannerInfo *root,
+							  VariableStatData *vardata1,
+							  VariableStatData *vardata2, double *selec);
 static bool estimate_multivariate_ndistinct(PlannerInfo *root,
 											RelOptInfo *rel, List **varinfos, double *ndistinct);
 static bool convert_to_scalar(Datum value, Oid valuetypid, Oid collid,
@@ -2303,6 +2313,10 @@ eqjoinsel(PG_FUNCTION_ARGS)
 								  stats1, stats2,
 								  have_mcvs1, have_mcvs2);
 
+	/* vertices joined with their edges are estimated by ag_graphmeta */
+	if (operator == OID_GRAPHID_EQ_OP)
+		(void) graphmeta_joinsel(root, &vardata1, &vardata2, &selec_inner);
+
 	switch (sjinfo->jointype)
 	{
 		case JOIN_INNER:
@@ -2378,6 +2392,172 @@ eqjoinsel(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8((float8) selec);
 }
 
+/*
+ * graph_label_column --- is the variable a column of a graph label?
+ *
+ * If so, returns the name of the column, and the graph and kind of the label.
+ * labids and ntuples are set to the labels scanned for the variable, i.e. the
+ * label itself and also its sublabels if they are scanned, and to their
+ * estimated number of tuples.  Returns NULL otherwise.
+ */
+static const char *
+graph_label_column(PlannerInfo *root, VariableStatData *vardata,
+				   Oid *graphoid, char *labkind, List **labids,
+				   double *ntuples)
+{
+	Var		   *var = (Var *) vardata->var;
+	RelOptInfo *rel = vardata->rel;
+	RangeTblEntry *rte;
+	HeapTuple	tuple;
+	Form_ag_label label;
+	int			i;
+
+	if (var == NULL || !IsA(var, Var) || rel == NULL ||
+		rel->reloptkind != RELOPT_BASEREL)
+		return NULL;
+
+	rte = planner_rt_fetch(rel->relid, root);
+	if (rte->rtekind != RTE_RELATION)
+		return NULL;
+
+	tuple = SearchSysCache1(LABELRELID, ObjectIdGetDatum(rte->relid));
+	if (!HeapTupleIsValid(tuple))
+		return NULL;
+	label = (Form_ag_label) GETSTRUCT(tuple);
+	*graphoid = label->graphid;
+	*labkind = label->labkind;
+	*labids = list_make1_int(label->labid);
+	ReleaseSysCache(tuple);
+
+	*ntuples = rel->tuples;
+
+	/*
+	 * The tuples of an appendrel are the rows left after its restrictions,
+	 * so add up the raw tuples of its children instead.
+	 */
+	if (rte->inh && root->append_rel_array != NULL)
+	{
+		*labids = NIL;
+		*ntuples = 0;
+
+		for (i = 1; i < root->simple_rel_array_size; i++)
+		{
+			AppendRelInfo *appinfo = root->append_rel_array[i];
+			RelOptInfo *childrel = root->simple_rel_array[i];
+
+			if (appinfo == NULL || appinfo->parent_relid != rel->relid ||
+				childrel == NULL)
+				continue;
+
+			tuple = SearchSysCache1(LABELRELID,
+									ObjectIdGetDatum(planner_rt_fetch(i, root)->relid));
+			if (!HeapTupleIsValid(tuple))
+				continue;
+			label = (Form_ag_label) GETSTRUCT(tuple);
+			*labids = lappend_int(*labids, label->labid);
+			ReleaseSysCache(tuple);
+
+			*ntuples += childrel->tuples;
+		}
+	}
+
+	return get_attname(rte->relid, var->varattno, true);
+}
+
+/*
+ * graphmeta_joinsel --- join selectivity of vertices and their edges
+ *
+ * A pattern like (a:l1)-[r:l2]->(b:l3) joins the id of the vertices of a
+ * label with the start or the end of the edges of a label.  The generic
+ * estimate on graphid columns does not know which vertex labels the edges
+ * actually connect, and overestimates the joins of labels that are rarely or
+ * never connected by orders of magnitude.  ag_graphmeta counts the edges per
+ * edge, start and end label, so the number of rows of the join is known.
+ *
+ * Returns false if the clause is not such a join, or if ag_graphmeta has not
+ * been gathered for the edge labels.
+ */
+static bool
+graphmeta_joinsel(PlannerInfo *root, VariableStatData *vardata1,
+				  VariableStatData *vardata2, double *selec)
+{
+	const char *colname1;
+	const char *colname2;
+	const char *vertex_colname;
+	const char *edge_colname;
+	Oid			graphoid1;
+	Oid			graphoid2;
+	char		labkind1;
+	char		labkind2;
+	List	   *labids1;
+	List	   *labids2;
+	List	   *vertex_labids;
+	List	   *edge_labids;
+	double		ntuples1;
+	double		ntuples2;
+	bool		start;
+	bool		found = false;
+	double		nedges = 0;
+	ListCell   *lc;
+
+	colname1 = graph_label_column(root, vardata1, &graphoid1, &labkind1,
+								  &labids1, &ntuples1);
+	if (colname1 == NULL)
+		return false;
+	colname2 = graph_label_column(root, vardata2, &graphoid2, &labkind2,
+								  &labids2, &ntuples2);
+	if (colname2 == NULL || graphoid1 != graphoid2)
+		return false;
+
+	if (labkind1 == LABEL_KIND_VERTEX && labkind2 == LABEL_KIND_EDGE)
+	{
+		vertex_colname = colname1;
+		vertex_labids = labids1;
+		edge_colname = colname2;
+		edge_labids = labids2;
+	}
+	else if (labkind1 == LABEL_KIND_EDGE && labkind2 == LABEL_KIND_VERTEX)
+	{
+		vertex_colname = colname2;
+		vertex_labids = labids2;
+		edge_colname = colname1;
+		edge_labids = labids1;
+	}
+	else
+		return false;
+
+	if (strcmp(vertex_colname, AG_ELEM_LOCAL_ID) != 0)
+		return false;
+	if (strcmp(edge_colname, AG_START_ID) == 0)
+		start = true;
+	else if (strcmp(edge_colname, AG_END_ID) == 0)
+		start = false;
+	else
+		return false;
+
+	if (ntuples1 <= 0 || ntuples2 <= 0)
+		return false;
+
+	foreach(lc, get_planner_graphmeta_list(root, graphoid1))
+	{
+		Form_ag_graphmeta meta = (Form_ag_graphmeta) lfirst(lc);
+
+		if (!list_member_int(edge_labids, meta->edge))
+			continue;
+		found = true;
+
+		if (list_member_int(vertex_labids, start ? meta->start : meta->end))
+			nedges += meta->edgecount;
+	}
+	if (!found)
+		return false;
+
+	*selec = nedges / (ntuples1 * ntuples2);
+	CLAMP_PROBABILITY(*selec);
+
+	return true;
+}
+
 /*
  * eqjoinsel_inner --- eqjoinsel for normal inner join
  *
@@ -0,0 +1,727 @@
+/*
+ * adjcache.c
+ *	  shared-memory adjacency cache of edge labels
+ *
+ * For each cached edge label, the cache keeps two compressed sparse row
+ * (CSR) arrays, one grouping the edges by their start vertex and the other by
+ * their end vertex. For each vertex, the ids of its edges, the ids of the
+ * vertices at the other side, and the TIDs of the edge tuples are stored in
+ * the order of the edge ids. Traversals look up the edges of a vertex here
+ * instead of descending the (start, end) and (end, start) indexes, and then
+ * fetch the edge tuples by TID, which also checks their visibility.
+ *
+ * A label is cached by scanning it with the snapshot of the query that
+ * requests it for the ADJCACHE_BUILD_REQUESTS'th time since it was changed.
+ * The cache is shared by all sessions, so it must never miss an edge that the
+ * snapshot of a session using it can see:
+ *
+ * - Every statement that writes to an edge label calls
+ *	 AdjCacheRelationModified() before writing, and the writing transaction
+ *	 invalidates the label again when it ends. Each invalidation records the
+ *	 next transaction ID as `inval_xmax` of the label.
+ * - A label is cached only with a snapshot whose xmin is not before
+ *	 `inval_xmax`, so that all the writers invalidated so far are complete for
+ *	 it, and only if the label has not been invalidated during the scan.
+ * - A cached label is used only with a snapshot whose xmin is not before the
+ *	 xmax of the snapshot that built it.
+ * - A transaction that has written to a label neither builds nor uses it.
+ *
+ * Relcache invalidations (TRUNCATE, CLUSTER, DDL, ...) invalidate the label,
+ * too, since they may change the TIDs of the edges.
+ *
+ * Copyright (c) 2022 by Bitnine Global, Inc.
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/adjcache.c
+ */
+
+#include "postgres.h"
+
+#include "access/tableam.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_type.h"
+#include "miscadmin.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/adjcache.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
+/* # of edge labels the cache can track */
+#define ADJCACHE_MAX_LABELS			64
+
+/* # of requests for a label after which it is cached */
+#define ADJCACHE_BUILD_REQUESTS		3
+
+typedef struct AdjCacheSlot
+{
+	Oid			dbid;
+	Oid			relid;			/* InvalidOid if the slot is free */
+	uint64		generation;		/* changed whenever the label is invalidated */
+	bool		valid;			/* the CSR arrays of the label are cached */
+	bool		building;		/* a session is scanning the label */
+	uint32		nrequests;		/* since the label is invalidated */
+	TransactionId inval_xmax;	/* next XID at the last invalidation */
+	TransactionId build_xmax;	/* xmax of the snapshot that built this */
+	Size		out_offset;		/* CSR by start vertex, in the arena */
+	Size		in_offset;		/* CSR by end vertex, in the arena */
+} AdjCacheSlot;
+
+typedef struct AdjCacheShared
+{
+	uint64		generation_counter;
+
+	/* inval_xmax of the labels that are not tracked by any slot */
+	TransactionId untracked_inval_xmax;
+
+	Size		arena_size;
+	Size		arena_used;
+	AdjCacheSlot slots[ADJCACHE_MAX_LABELS];
+	char		arena[FLEXIBLE_ARRAY_MEMBER];
+} AdjCacheShared;
+
+/*
+ * A CSR array in the arena. `nvertices` sorted vertex ids are followed by
+ * `nvertices + 1` offsets into the `nedges` edges that follow them.
+ */
+typedef struct AdjCacheCSR
+{
+	uint32		nvertices;
+	uint32		nedges;
+} AdjCacheCSR;
+
+#define CSRVertexIds(csr) \
+	((Graphid *) ((char *) (csr) + MAXALIGN(sizeof(AdjCacheCSR))))
+#define CSROffsets(csr) \
+	((uint32 *) (CSRVertexIds(csr) + (csr)->nvertices))
+#define CSREdges(csr) \
+	((AdjCacheEdge *) ((char *) CSROffsets(csr) + \
+					   MAXALIGN(sizeof(uint32) * ((csr)->nvertices + 1))))
+
+/* an edge collected while building the cache */
+typedef struct AdjBuildEdge
+{
+	Graphid		id;
+	Graphid		start;
+	Graphid		end;
+	ItemPointerData tid;
+} AdjBuildEdge;
+
+/* GUC parameter */
+int			graph_adjacency_cache_size = 0;
+
+static AdjCacheShared *adjCache = NULL;
+
+/* edge labels written by the current transaction */
+static List *modified_relids = NIL;
+
+static bool is_edge_label(Relation rel);
+static bool relation_modified_locally(Oid relid);
+static AdjCacheSlot *find_slot(Oid relid, bool create);
+static void invalidate_slot(AdjCacheSlot *slot);
+static void invalidate_relation(Oid relid);
+static bool build_slot(Relation rel, Snapshot snapshot, int slotno,
+					   uint64 generation);
+static Size csr_size(AdjBuildEdge *edges, int nedges, bool by_start,
+					 uint32 *nvertices);
+static void csr_write(AdjCacheCSR *csr, AdjBuildEdge *edges, int nedges,
+					  uint32 nvertices, bool by_start);
+static int	build_edge_cmp_start(const void *a, const void *b);
+static int	build_edge_cmp_end(const void *a, const void *b);
+static void adjcache_relcache_callback(Datum arg, Oid relid);
+static void adjcache_xact_callback(XactEvent event, void *arg);
+
+Size
+AdjCacheShmemSize(void)
+{
+	if (graph_adjacency_cache_size <= 0)
+		return 0;
+
+	return add_size(offsetof(AdjCacheShared, arena),
+					mul_size(graph_adjacency_cache_size, 1024));
+}
+
+void
+AdjCacheShmemInit(void)
+{
+	bool		found;
+
+	if (graph_adjacency_cache_size <= 0)
+		return;
+
+	adjCache = (AdjCacheShared *)
+		ShmemInitStruct("Graph Adjacency Cache", AdjCacheShmemSize(), &found);
+
+	if (!IsUnderPostmaster)
+	{
+		Assert(!found);
+
+		memset(adjCache, 0, offsetof(AdjCacheShared, arena));
+		adjCache->untracked_inval_xmax = InvalidTransactionId;
+		adjCache->arena_size = mul_size(graph_adjacency_cache_size, 1024);
+		adjCache->arena_used = 0;
+	}
+	else
+	{
+		Assert(found);
+	}
+}
+
+/*
+ * InitAdjCache: initialize module during InitPostgres.
+ *
+ * Every backend must see the relcache invalidations of the cached labels,
+ * whether it uses the cache or not.
+ */
+void
+InitAdjCache(void)
+{
+	if (graph_adjacency_cache_size <= 0)
+		return;
+
+	CacheRegisterRelcacheCallback(adjcache_relcache_callback, (Datum) 0);
+	RegisterXactCallback(adjcache_xact_callback, NULL);
+}
+
+/*
+ * AdjCacheAcquire
+ *		Set `ref` to the cached edge label `rel`, caching it if it has been
+ *		requested enough. Returns false if the cache cannot be used for the
+ *		label with `snapshot`.
+ */
+bool
+AdjCacheAcquire(Relation rel, Snapshot snapshot, AdjCacheRef *ref)
+{
+	Oid			relid = RelationGetRelid(rel);
+	AdjCacheSlot *slot;
+	int			slotno;
+	uint64		generation;
+	bool		built;
+
+	ref->relid = InvalidOid;
+
+	if (adjCache == NULL || !IsMVCCSnapshot(snapshot) ||
+		relation_modified_locally(relid))
+		return false;
+
+	LWLockAcquire(AdjacencyCacheLock, LW_EXCLUSIVE);
+
+	slot = find_slot(relid, true);
+	if (slot == NULL)
+	{
+		LWLockRelease(AdjacencyCacheLock);
+		return false;
+	}
+	slotno = slot - adjCache->slots;
+
+	if (slot->valid)
+	{
+		if (TransactionIdFollowsOrEquals(snapshot->xmin, slot->build_xmax))
+		{
+			ref->relid = relid;
+			ref->slotno = slotno;
+			ref->generation = slot->generation;
+		}
+		LWLockRelease(AdjacencyCacheLock);
+		return OidIsValid(ref->relid);
+	}
+
+	slot->nrequests++;
+	if (slot->building ||
+		slot->nrequests < ADJCACHE_BUILD_REQUESTS ||
+		!TransactionIdFollowsOrEquals(snapshot->xmin, slot->inval_xmax))
+	{
+		LWLockRelease(AdjacencyCacheLock);
+		return false;
+	}
+
+	slot->building = true;
+	generation = slot->generation;
+
+	LWLockRelease(AdjacencyCacheLock);
+
+	PG_TRY();
+	{
+		built = build_slot(rel, snapshot, slotno, generation);
+	}
+	PG_FINALLY();
+	{
+		LWLockAcquire(AdjacencyCacheLock, LW_EXCLUSIVE);
+		adjCache->slots[slotno].building = false;
+		LWLockRelease(AdjacencyCacheLock);
+	}
+	PG_END_TRY();
+
+	if (!built)
+		return false;
+
+	ref->relid = relid;
+	ref->slotno = slotno;
+	ref->generation = generation;
+
+	return true;
+}
+
+/*
+ * AdjCacheLookup
+ *		Return the number of edges of `vertex_id` going out of it (or coming
+ *		into it if `outgoing` is false) and a palloc'd copy of them. Returns -1
+ *		if the label has been invalidated since `ref` was acquired.
+ */
+int
+AdjCacheLookup(AdjCacheRef *ref, Graphid vertex_id, bool outgoing,
+			   AdjCacheEdge **edges)
+{
+	AdjCacheSlot *slot;
+	AdjCacheCSR *csr;
+	Graphid    *vertex_ids;
+	uint32	   *offsets;
+	int			lo;
+	int			hi;
+	int			nedges = 0;
+
+	Assert(OidIsValid(ref->relid));
+
+	*edges = NULL;
+
+	if (relation_modified_locally(ref->relid))
+		return -1;
+
+	LWLockAcquire(AdjacencyCacheLock, LW_SHARED);
+
+	slot = &adjCache->slots[ref->slotno];
+	if (!slot->valid || slot->generation != ref->generation)
+	{
+		LWLockRelease(AdjacencyCacheLock);
+		return -1;
+	}
+
+	csr = (AdjCacheCSR *) (adjCache->arena +
+						   (outgoing ? slot->out_offset : slot->in_offset));
+	vertex_ids = CSRVertexIds(csr);
+	offsets = CSROffsets(csr);
+
+	lo = 0;
+	hi = (int) csr->nvertices - 1;
+	while (lo <= hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (vertex_ids[mid] < vertex_id)
+		{
+			lo = mid + 1;
+		}
+		else if (vertex_ids[mid] > vertex_id)
+		{
+			hi = mid - 1;
+		}
+		else
+		{
+			nedges = offsets[mid + 1] - offsets[mid];
+			*edges = palloc(nedges * sizeof(AdjCacheEdge));
+			memcpy(*edges, CSREdges(csr) + offsets[mid],
+				   nedges * sizeof(AdjCacheEdge));
+			break;
+		}
+	}
+
+	LWLockRelease(AdjacencyCacheLock);
+
+	return nedges;
+}
+
+/*
+ * AdjCacheRelationModified
+ *		Invalidate the cache of `rel`, which the current statement is about to
+ *		write to.
+ */
+void
+AdjCacheRelationModified(Relation rel)
+{
+	Oid			relid = RelationGetRelid(rel);
+	MemoryContext oldcxt;
+
+	if (adjCache == NULL || !is_edge_label(rel))
+		return;
+
+	/*
+	 * The other sessions cannot see the writes until the transaction ends,
+	 * and then the label is invalidated again.
+	 */
+	if (relation_modified_locally(relid))
+		return;
+
+	oldcxt = MemoryContextSwitchTo(TopTransactionContext);
+	modified_relids = lappend_oid(modified_relids, relid);
+	MemoryContextSwitchTo(oldcxt);
+
+	invalidate_relation(relid);
+}
+
+static bool
+is_edge_label(Relation rel)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+
+	return (rel->rd_rel->relkind == RELKIND_RELATION &&
+			tupdesc->natts == Anum_table_edge_prop_map &&
+			TupleDescAttr(tupdesc, Anum_table_edge_id - 1)->atttypid == GRAPHIDOID &&
+			TupleDescAttr(tupdesc, Anum_table_edge_start - 1)->atttypid == GRAPHIDOID &&
+			TupleDescAttr(tupdesc, Anum_table_edge_end - 1)->atttypid == GRAPHIDOID);
+}
+
+static bool
+relation_modified_locally(Oid relid)
+{
+	return list_member_oid(modified_relids, relid);
+}
+
+/*
+ * Return the slot of `relid` in the current database. If there is none and
+ * `create` is true, take a free slot or one of a label that is not cached.
+ * AdjacencyCacheLock must be held, exclusively if `create` is true.
+ */
+static AdjCacheSlot *
+find_slot(Oid relid, bool create)
+{
+	AdjCacheSlot *victim = NULL;
+	int			i;
+
+	for (i = 0; i < ADJCACHE_MAX_LABELS; i++)
+	{
+		AdjCacheSlot *slot = &adjCache->slots[i];
+
+		if (slot->relid == relid && slot->dbid == MyDatabaseId)
+			return slot;
+
+		if (!OidIsValid(slot->relid))
+		{
+			if (victim == NULL || OidIsValid(victim->relid))
+				victim = slot;
+		}
+		else if (victim == NULL && !slot->valid && !slot->building)
+		{
+			victim = slot;
+		}
+	}
+
+	if (!create || victim == NULL)
+		return NULL;
+
+	/* the label of the victim is not tracked anymore */
+	if (OidIsValid(victim->relid) &&
+		TransactionIdFollows(victim->inval_xmax,
+							 adjCache->untracked_inval_xmax))
+		adjCache->untracked_inval_xmax = victim->inval_xmax;
+
+	victim->dbid = MyDatabaseId;
+	victim->relid = relid;
+	victim->generation = ++adjCache->generation_counter;
+	victim->valid = false;
+	victim->building = false;
+	victim->nrequests = 0;
+	victim->inval_xmax = adjCache->untracked_inval_xmax;
+	victim->build_xmax = InvalidTransactionId;
+
+	return victim;
+}
+
+/* AdjacencyCacheLock must be held exclusively */
+static void
+invalidate_slot(AdjCacheSlot *slot)
+{
+	slot->generation = ++adjCache->generation_counter;
+	slot->valid = false;
+	slot->nrequests = 0;
+	slot->inval_xmax = ReadNextTransactionId();
+}
+
+static void
+invalidate_relation(Oid relid)
+{
+	AdjCacheSlot *slot;
+
+	LWLockAcquire(AdjacencyCacheLock, LW_EXCLUSIVE);
+
+	slot = find_slot(relid, true);
+	if (slot != NULL)
+		invalidate_slot(slot);
+	else
+		adjCache->untracked_inval_xmax = ReadNextTransactionId();
+
+	LWLockRelease(AdjacencyCacheLock);
+}
+
+/*
+ * Scan `rel` with `snapshot` and store its CSR arrays to the slot, unless the
+ * label is invalidated in the meantime or the arrays do not fit in the cache.
+ */
+static bool
+build_slot(Relation rel, Snapshot snapshot, int slotno, uint64 generation)
+{
+	Size		max_size = adjCache->arena_size;
+	TableScanDesc scan;
+	TupleTableSlot *tupslot;
+	AdjBuildEdge *edges;
+	int			nedges = 0;
+	int			max_edges = 1024;
+	uint32		out_nvertices;
+	uint32		in_nvertices;
+	Size		out_size;
+	Size		in_size;
+	AdjCacheSlot *slot;
+	bool		fits = true;
+
+	edges = palloc(max_edges * sizeof(AdjBuildEdge));
+
+	tupslot = table_slot_create(rel, NULL);
+	scan = table_beginscan(rel, snapshot, 0, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, tupslot))
+	{
+		AdjBuildEdge *edge;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* each edge takes an AdjCacheEdge in both of the CSR arrays */
+		if ((nedges + 1) * 2 * sizeof(AdjCacheEdge) > max_size)
+		{
+			fits = false;
+			break;
+		}
+
+		if (nedges == max_edges)
+		{
+			max_edges *= 2;
+			edges = repalloc_huge(edges, max_edges * sizeof(AdjBuildEdge));
+		}
+
+		slot_getsomeattrs(tupslot, Anum_table_edge_end);
+
+		edge = &edges[nedges++];
+		edge->id = DatumGetGraphid(tupslot->tts_values[Anum_table_edge_id - 1]);
+		edge->start = DatumGetGraphid(tupslot->tts_values[Anum_table_edge_start - 1]);
+		edge->end = DatumGetGraphid(tupslot->tts_values[Anum_table_edge_end - 1]);
+		edge->tid = tupslot->tts_tid;
+	}
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(tupslot);
+
+	if (!fits)
+	{
+		pfree(edges);
+		return false;
+	}
+
+	qsort(edges, nedges, sizeof(AdjBuildEdge), build_edge_cmp_start);
+	out_size = csr_size(edges, nedges, true, &out_nvertices);
+	qsort(edges, nedges, sizeof(AdjBuildEdge), build_edge_cmp_end);
+	in_size = csr_size(edges, nedges, false, &in_nvertices);
+
+	if (add_size(out_size, in_size) > max_size)
+	{
+		pfree(edges);
+		return false;
+	}
+
+	LWLockAcquire(AdjacencyCacheLock, LW_EXCLUSIVE);
+
+	slot = &adjCache->slots[slotno];
+	if (slot->generation != generation)
+	{
+		LWLockRelease(AdjacencyCacheLock);
+		pfree(edges);
+		return false;
+	}
+
+	/* make room by dropping all the cached labels */
+	if (adjCache->arena_used + out_size + in_size > adjCache->arena_size)
+	{
+		int			i;
+
+		for (i = 0; i < ADJCACHE_MAX_LABELS; i++)
+		{
+			if (adjCache->slots[i].valid)
+			{
+				adjCache->slots[i].generation = ++adjCache->generation_counter;
+				adjCache->slots[i].valid = false;
+			}
+		}
+		adjCache->arena_used = 0;
+	}
+
+	slot->in_offset = adjCache->arena_used;
+	csr_write((AdjCacheCSR *) (adjCache->arena + slot->in_offset),
+			  edges, nedges, in_nvertices, false);
+	adjCache->arena_used += in_size;
+
+	qsort(edges, nedges, sizeof(AdjBuildEdge), build_edge_cmp_start);
+	slot->out_offset = adjCache->arena_used;
+	csr_write((AdjCacheCSR *) (adjCache->arena + slot->out_offset),
+			  edges, nedges, out_nvertices, true);
+	adjCache->arena_used += out_size;
+
+	slot->valid = true;
+	slot->build_xmax = snapshot->xmax;
+
+	LWLockRelease(AdjacencyCacheLock);
+
+	pfree(edges);
+
+	return true;
+}
+
+/* `edges` must be sorted by the vertex the CSR array groups them by */
+static Size
+csr_size(AdjBuildEdge *edges, int nedges, bool by_start, uint32 *nvertices)
+{
+	uint32		n = 0;
+	int			i;
+
+	for (i = 0; i < nedges; i++)
+	{
+		Graphid		vid = by_start ? edges[i].start : edges[i].end;
+
+		if (i == 0 || vid != (by_start ? edges[i - 1].start : edges[i - 1].end))
+			n++;
+	}
+
+	*nvertices = n;
+
+	return MAXALIGN(sizeof(AdjCacheCSR)) +
+		MAXALIGN(sizeof(Graphid) * n) +
+		MAXALIGN(sizeof(uint32) * (n + 1)) +
+		MAXALIGN(sizeof(AdjCacheEdge) * nedges);
+}
+
+static void
+csr_write(AdjCacheCSR *csr, AdjBuildEdge *edges, int nedges,
+		  uint32 nvertices, bool by_start)
+{
+	Graphid    *vertex_ids;
+	uint32	   *offsets;
+	AdjCacheEdge *csr_edges;
+	uint32		v = 0;
+	int			i;
+
+	csr->nvertices = nvertices;
+	csr->nedges = nedges;
+	vertex_ids = CSRVertexIds(csr);
+	offsets = CSROffsets(csr);
+	csr_edges = CSREdges(csr);
+
+	for (i = 0; i < nedges; i++)
+	{
+		Graphid		vid = by_start ? edges[i].start : edges[i].end;
+
+		if (v == 0 || vertex_ids[v - 1] != vid)
+		{
+			vertex_ids[v] = vid;
+			offsets[v] = i;
+			v++;
+		}
+
+		csr_edges[i].edge_id = edges[i].id;
+		csr_edges[i].neighbor_id = by_start ? edges[i].end : edges[i].start;
+		csr_edges[i].tid = edges[i].tid;
+	}
+	offsets[v] = nedges;
+
+	Assert(v == nvertices);
+}
+
+static int
+build_edge_cmp_start(const void *a, const void *b)
+{
+	const AdjBuildEdge *e1 = (const AdjBuildEdge *) a;
+	const AdjBuildEdge *e2 = (const AdjBuildEdge *) b;
+
+	if (e1->start != e2->start)
+		return (e1->start < e2->start) ? -1 : 1;
+	if (e1->id != e2->id)
+		return (e1->id < e2->id) ? -1 : 1;
+	return 0;
+}
+
+static int
+build_edge_cmp_end(const void *a, const void *b)
+{
+	const AdjBuildEdge *e1 = (const AdjBuildEdge *) a;
+	const AdjBuildEdge *e2 = (const AdjBuildEdge *) b;
+
+	if (e1->end != e2->end)
+		return (e1->end < e2->end) ? -1 : 1;
+	if (e1->id != e2->id)
+		return (e1->id < e2->id) ? -1 : 1;
+	return 0;
+}
+
+static void
+adjcache_relcache_callback(Datum arg, Oid relid)
+{
+	int			i;
+
+	/* most invalidations are of relations that are not tracked */
+	if (OidIsValid(relid))
+	{
+		AdjCacheSlot *slot;
+
+		LWLockAcquire(AdjacencyCacheLock, LW_SHARED);
+		slot = find_slot(relid, false);
+		LWLockRelease(AdjacencyCacheLock);
+
+		if (slot == NULL)
+			return;
+	}
+
+	LWLockAcquire(AdjacencyCacheLock, LW_EXCLUSIVE);
+
+	for (i = 0; i < ADJCACHE_MAX_LABELS; i++)
+	{
+		AdjCacheSlot *slot = &adjCache->slots[i];
+
+		if (!OidIsValid(slot->relid) || slot->dbid != MyDatabaseId)
+			continue;
+
+		/* InvalidOid means all relations */
+		if (!OidIsValid(relid) || slot->relid == relid)
+			invalidate_slot(slot);
+	}
+
+	LWLockRelease(AdjacencyCacheLock);
+}
+
+/*
+ * The edges written by the transaction become visible (or not) to the other
+ * sessions when it ends. The labels are invalidated before the commit as
+ * well, since the commit callbacks run only after the transaction has become
+ * visible, and a session could build or use the cache in between.
+ */
+static void
+adjcache_xact_callback(XactEvent event, void *arg)
+{
+	ListCell   *lc;
+
+	switch (event)
+	{
+		case XACT_EVENT_PRE_COMMIT:
+		case XACT_EVENT_PARALLEL_PRE_COMMIT:
+		case XACT_EVENT_PRE_PREPARE:
+			foreach(lc, modified_relids)
+				invalidate_relation(lfirst_oid(lc));
+			break;
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PREPARE:
+			foreach(lc, modified_relids)
+				invalidate_relation(lfirst_oid(lc));
+			/* the list is in TopTransactionContext */
+			modified_relids = NIL;
+			break;
+		default:
+			break;
+	}
+}
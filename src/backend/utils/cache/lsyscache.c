@@ -3747,6 +3747,34 @@ get_relid_laboid(Oid relid)
 	return GetSysCacheOid1(LABELRELID, Anum_ag_label_oid, ObjectIdGetDatum(relid));
 }
 
+/*
+ * get_relid_labid
+ *		Returns the label ID for a given relation.
+ *
+ * Returns 0 if there is no such a label.
+ */
+uint16
+get_relid_labid(Oid relid)
+{
+	HeapTuple	tp;
+
+	tp = SearchSysCache1(LABELRELID, ObjectIdGetDatum(relid));
+
+	if (HeapTupleIsValid(tp))
+	{
+		Form_ag_label labtup = (Form_ag_label) GETSTRUCT(tp);
+		uint16		labid;
+
+		labid = (uint16) labtup->labid;
+		ReleaseSysCache(tp);
+		return labid;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
 Oid
 get_labid_typeoid(Oid graphid, uint16 labid)
 {
@@ -32,6 +32,7 @@
 #endif
 #include <unistd.h>
 
+#include "ag_const.h"
 #include "access/commit_ts.h"
 #include "access/gin.h"
 #include "access/rmgr.h"
@@ -69,6 +70,7 @@
 #include "parser/parse_expr.h"
 #include "parser/parse_graph.h"
 #include "parser/parse_type.h"
+#include "parser/parse_utilcmd.h"
 #include "parser/parser.h"
 #include "parser/scansup.h"
 #include "pgstat.h"
@@ -95,6 +97,7 @@
 #include "tcop/tcopprot.h"
 #include "tsearch/ts_cache.h"
 #include "utils/acl.h"
+#include "utils/adjcache.h"
 #include "utils/backend_status.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
@@ -3550,6 +3553,37 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"graph_adjacency_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the shared memory to cache the adjacency of edge labels."),
+			gettext_noop("Zero disables the cache."),
+			GUC_UNIT_KB
+		},
+		&graph_adjacency_cache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"graph_element_id_cache", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Sets the number of vertex and edge IDs a session preallocates from the sequence of a new label."),
+			gettext_noop("Applies to the labels created afterwards. 1 makes the IDs consecutive across sessions.")
+		},
+		&graph_element_id_cache,
+		AG_ELEM_LOCAL_ID_CACHE, 1, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"max_pending_graphmeta", PGC_POSTMASTER, STATS_COLLECTOR,
+			gettext_noop("Sets the maximum number of edge label triples whose edge counts can wait to be folded into ag_graphmeta."),
+			gettext_noop("Edge counts that do not fit update ag_graphmeta at commit.")
+		},
+		&max_pending_graphmeta,
+		4096, 16, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gin_pending_list_limit", PGC_USERSET, CLIENT_CONN_STATEMENT,
 			gettext_noop("Sets the maximum size of the pending list for GIN index."),
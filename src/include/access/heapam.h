@@ -161,6 +161,12 @@ extern TM_Result heap_update(Relation relation, ItemPointer otid,
 							 HeapTuple newtup,
 							 CommandId cid, Snapshot crosscheck, bool wait,
 							 struct TM_FailureData *tmfd, LockTupleMode *lockmode);
+extern TM_Result heap_update_hot_safe(Relation relation, ItemPointer otid,
+									  HeapTuple newtup,
+									  CommandId cid, Snapshot crosscheck,
+									  bool wait, Bitmapset *hot_safe_attrs,
+									  struct TM_FailureData *tmfd,
+									  LockTupleMode *lockmode);
 extern TM_Result heap_lock_tuple(Relation relation, HeapTuple tuple,
 								 CommandId cid, LockTupleMode mode, LockWaitPolicy wait_policy,
 								 bool follow_update,
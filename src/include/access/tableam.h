@@ -848,6 +848,30 @@ typedef struct TableAmRoutine
 										   struct SampleScanState *scanstate,
 										   TupleTableSlot *slot);
 
+
+	/* ------------------------------------------------------------------------
+	 * Optional callbacks, kept at the end so that the layout of the callbacks
+	 * above does not change.
+	 * ------------------------------------------------------------------------
+	 */
+
+	/*
+	 * see table_tuple_update_hot_safe() for reference about parameters
+	 *
+	 * Optional callback.  If NULL, tuple_update is used instead.
+	 */
+	TM_Result	(*tuple_update_hot_safe) (Relation rel,
+										  ItemPointer otid,
+										  TupleTableSlot *slot,
+										  CommandId cid,
+										  Snapshot snapshot,
+										  Snapshot crosscheck,
+										  bool wait,
+										  Bitmapset *hot_safe_attrs,
+										  TM_FailureData *tmfd,
+										  LockTupleMode *lockmode,
+										  bool *update_indexes);
+
 } TableAmRoutine;
 
 
@@ -1512,6 +1536,37 @@ table_tuple_update(Relation rel, ItemPointer otid, TupleTableSlot *slot,
 										 lockmode, update_indexes);
 }
 
+/*
+ * Update a tuple, like table_tuple_update(), when the caller knows that some
+ * of the changed columns do not change any index entry.
+ *
+ *	hot_safe_attrs - columns (offset by FirstLowInvalidHeapAttributeNumber)
+ *		that the caller has verified to leave every index entry of the
+ *		relation unchanged even though their values differ, e.g. because
+ *		only keys outside all index expressions changed.  The AM may then
+ *		treat the update as if they did not change, e.g. allow a HOT update.
+ *
+ * The other parameters and the result are as for table_tuple_update(), which
+ * is used if the AM does not provide tuple_update_hot_safe.  *update_indexes
+ * keeps its meaning, so the caller inserts index entries as usual.
+ */
+static inline TM_Result
+table_tuple_update_hot_safe(Relation rel, ItemPointer otid,
+							TupleTableSlot *slot, CommandId cid,
+							Snapshot snapshot, Snapshot crosscheck, bool wait,
+							Bitmapset *hot_safe_attrs, TM_FailureData *tmfd,
+							LockTupleMode *lockmode, bool *update_indexes)
+{
+	if (hot_safe_attrs == NULL || rel->rd_tableam->tuple_update_hot_safe == NULL)
+		return table_tuple_update(rel, otid, slot, cid, snapshot, crosscheck,
+								  wait, tmfd, lockmode, update_indexes);
+
+	return rel->rd_tableam->tuple_update_hot_safe(rel, otid, slot,
+												  cid, snapshot, crosscheck,
+												  wait, hot_safe_attrs, tmfd,
+												  lockmode, update_indexes);
+}
+
 /*
  * Lock a tuple in the specified mode.
  *
@@ -21,6 +21,13 @@
 #define AG_PATH_VERTICES	"vertices"
 #define AG_PATH_EDGES		"edges"
 
+/*
+ * default # of local IDs each session preallocates from the sequence of a
+ * label at a time, not to access the sequence for every new vertex/edge (see
+ * graph_element_id_cache)
+ */
+#define AG_ELEM_LOCAL_ID_CACHE	32
+
 #define AG_PACKAGE_NAME "AgensGraph"
 #define AG_PACKAGE_BUGREPORT "agens@bitnine.net"
 #define AG_PACKAGE_URL "https://bitnine.net/"
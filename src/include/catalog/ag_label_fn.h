@@ -11,11 +11,14 @@
 #define AG_LABEL_FN_H
 
 #include "nodes/parsenodes.h"
+#include "utils/relcache.h"
 
 extern Oid	label_create_with_catalog(RangeVar *label, Oid relid, char labkind,
 									  Oid labtablespace, bool is_fixed_id,
 									  int32 fixed_id);
 extern void label_drop_with_catalog(Oid laboid);
 extern List *get_all_edge_labels_per_graph(Snapshot snapshot, Oid graph_oid);
+extern Oid	get_label_btree_index(Relation rel, AttrNumber attnum);
+extern Oid	get_label_gin_index(Relation rel, AttrNumber attnum);
 
 #endif							/* AG_LABEL_FN_H */
@@ -53,6 +53,6 @@
  */
 
 /*							yyyymmddN */
-#define CATALOG_VERSION_NO	202107181
+#define CATALOG_VERSION_NO	202610176
 
 #endif
@@ -14,5 +14,8 @@
 
 extern TupleTableSlot *ExecCreateGraph(ModifyGraphState *mgstate,
 									   TupleTableSlot *slot);
+extern void ExecInitCreateGraph(ModifyGraphState *mgstate);
+extern void ExecFlushCreateGraph(ModifyGraphState *mgstate);
+extern void ExecEndCreateGraph(ModifyGraphState *mgstate);
 
 #endif							/* AGENSGRAPH_EXECCYPHERCREATE_H */
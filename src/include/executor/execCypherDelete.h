@@ -13,5 +13,6 @@
 
 extern TupleTableSlot *ExecDeleteGraph(ModifyGraphState *mgstate,
 									   TupleTableSlot *slot);
+extern void ExecFlushDeleteGraph(ModifyGraphState *mgstate);
 
 #endif							/* AGENSGRAPH_EXECCYPHERDELETE_H */
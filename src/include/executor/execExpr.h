@@ -24,6 +24,7 @@ struct ExprEvalStep;
 struct SubscriptingRefState;
 struct ScalarArrayOpExprHashTable;
 struct CypherAccessPathElem;
+struct CypherAccessArgCache;
 struct CypherListCompArrayIterator;
 
 /* Bits in ExprState->flags (see also execnodes.h for public flag bits): */
@@ -729,6 +730,7 @@ typedef struct ExprEvalStep
 		{
 			Datum	   *argvalue;
 			bool	   *argnull;
+			struct CypherAccessArgCache *argcache;
 			struct CypherAccessPathElem *path;
 			int			pathlen;
 		}			cypheraccessexpr;
@@ -798,6 +800,22 @@ typedef struct CypherAccessPathElem
 	CypherIndexResult uidx;
 } CypherAccessPathElem;
 
+/*
+ * The last toasted value of a property map and its detoasted form. Accesses
+ * on the same map expression share it, so that `n.a, n.b, ...` detoasts the
+ * map only once.  An on-disk value is recognized by its toast pointer, and a
+ * compressed one by its bytes, which are kept only if they are small.
+ */
+typedef struct CypherAccessArgCache
+{
+	Expr	   *arg;
+	MemoryContext mcxt;
+	bool		ondisk;			/* is toast_pointer that of value? */
+	struct varatt_external toast_pointer;
+	struct varlena *rawvalue;	/* copy of the compressed value, or NULL */
+	struct varlena *value;		/* detoasted value, or NULL */
+} CypherAccessArgCache;
+
 typedef struct CypherListCompArrayIterator
 {
 	array_iter array_iter;
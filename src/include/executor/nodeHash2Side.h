@@ -24,7 +24,7 @@ extern void ExecEndHash2Side(Hash2SideState *node);
 extern void ExecReScanHash2Side(Hash2SideState *node);
 
 extern HashJoinTable ExecHash2SideTableCreate(Hash2SideState *node, List *hashOperators,
-											  double ntuples, double npaths, long hops, Size spacePeak);
+											  double ntuples, double npaths, Size spacePeak);
 extern HashJoinTable ExecHash2SideTableClone(Hash2SideState *node, List *hashOperators,
 											 HashJoinTable sourcetable, Size spacePeak);
 extern void ExecHash2SideTableDestroy(HashJoinTable hashtable);
@@ -58,7 +58,6 @@ extern void ExecHash2SideTableReset(HashJoinTable hashtable);
 extern void ExecChooseHash2SideTableSize(double ntuples,
 										 double npaths,
 										 int tupwidth,
-										 long hops,
 										 int *numbuckets,
 										 int *numbatches);
 
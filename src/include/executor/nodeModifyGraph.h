@@ -31,12 +31,8 @@ typedef enum ModifyCid
 	MODIFY_CID_MAX
 } ModifyCid;
 
-/* hash entry */
-typedef struct ModifiedElemEntry
-{
-	Graphid		key;			/* key */
-	Datum		elem;			/* modified graph element ( For set operator ) */
-} ModifiedElemEntry;
+/* graph elements modified by a ModifyGraph, see nodeModifyGraph.c */
+typedef struct ModifiedElemTable ModifiedElemTable;
 
 extern ResultRelInfo *getResultRelInfo(ModifyGraphState *mgstate, Oid relid);
 extern Datum findVertex(TupleTableSlot *slot, GraphVertex *gvertex, Graphid *vid);
@@ -46,6 +42,14 @@ extern void setSlotValueByName(TupleTableSlot *slot, Datum value, char *name);
 extern void setSlotValueByAttnum(TupleTableSlot *slot, Datum value, int attnum);
 extern Datum *makeDatumArray(int len);
 
+extern ModifiedElemTable *createModifiedElemTable(void);
+extern void destroyModifiedElemTable(ModifiedElemTable *table);
+extern uint64 countModifiedElems(ModifiedElemTable *table);
+extern bool lookupModifiedElem(ModifiedElemTable *table, Graphid gid,
+							   Datum *elem);
+extern bool storeModifiedElem(ModifiedElemTable *table, Graphid gid,
+							  Datum elem);
+
 extern Datum getElementFromEleTable(ModifyGraphState *mgstate, Oid type_oid,
 									Datum orig_elem, Datum gid, bool *found);
 extern Datum getPathFinal(ModifyGraphState *mgstate, Datum origin);
@@ -118,6 +118,9 @@ typedef struct ExprState
 
 	Datum	   *innermost_cypherlistcomp_iterval;
 	bool	   *innermost_cypherlistcomp_iternull;
+
+	/* detoasted property maps shared by CypherAccessExpr steps */
+	List	   *cypheraccess_argcaches;
 } ExprState;
 
 
@@ -1288,6 +1291,7 @@ struct AppendState
 	struct PartitionPruneState *as_prune_state;
 	Bitmapset  *as_valid_subplans;
 	Bitmapset  *as_valid_asyncplans;	/* valid asynchronous plans indexes */
+	ExprState  *as_graph_id_expr;	/* chooses the children of a graph label */
 	bool		(*choose_next_subplan) (AppendState *);
 };
 
@@ -2009,6 +2013,8 @@ typedef struct MergeJoinState
  *		hj_JoinState			current state of ExecHashJoin state machine
  *		hj_MatchedOuter			true if found a join match for current outer
  *		hj_OuterNotEmpty		true if outer relation known not empty
+ *		hj_RebuildHashTable		true if the inner relation was modified by
+ *								Cypher MERGE since the hash table was built
  * ----------------
  */
 
@@ -2036,6 +2042,7 @@ typedef struct HashJoinState
 	int			hj_JoinState;
 	bool		hj_MatchedOuter;
 	bool		hj_OuterNotEmpty;
+	bool		hj_RebuildHashTable;
 } HashJoinState;
 
 
@@ -2554,6 +2561,7 @@ typedef struct HashState
 	PlanState	ps;				/* its first field is NodeTag */
 	HashJoinTable hashtable;	/* hash table for the hashjoin */
 	List	   *hashkeys;		/* list of ExprState nodes */
+	bool		single_batch;	/* never split the hash table into batches */
 
 	/*
 	 * In a parallelized hash join, the leader retains a pointer to the
@@ -2666,10 +2674,36 @@ typedef struct DeleteGraphState
 {
 	ResultRelInfo *edge_labels; /* Used to find connected edges. */
 	int			num_edge_labels;
+	Relation   *start_index_rels;	/* btree on (start, ...) per edge label */
+	Relation   *end_index_rels; /* btree on (end, ...) per edge label */
+	struct IndexScanDescData **start_index_scans;	/* opened lazily */
+	struct IndexScanDescData **end_index_scans;
+	TupleTableSlot *edge_slot;	/* for edges fetched through the indexes */
 	Datum	   *cached_values;
 	bool	   *cached_isnull;
+
+	/*
+	 * In bulk mode, the ids of deleted vertices are collected and their
+	 * connected edges are removed later by one pass per edge label.
+	 */
+	bool		bulk;
+	Graphid    *pending_vertex_ids;
+	int			num_pending_vertex_ids;
+	int			max_pending_vertex_ids;
 } DeleteGraphState;
 
+typedef struct CreateGraphState
+{
+	/*
+	 * If the created elements are not returned to the parent plan, they are
+	 * buffered per target label and inserted with table_multi_insert().
+	 */
+	bool		multi_insert;
+	struct CreateGraphBuffer **buffers; /* per result relation */
+	int			nbuffered;		/* # of tuples in all the buffers */
+	Size		nbuffered_bytes;	/* approximate size of them */
+} CreateGraphState;
+
 typedef struct ModifyGraphState
 {
 	PlanState	ps;
@@ -2686,9 +2720,15 @@ typedef struct ModifyGraphState
 								 * with `es_prop_map` */
 	List	   *exprs;			/* expression state list for DELETE */
 	DeleteGraphState *delete_graph_state;
+	CreateGraphState *create_graph_state;
 	List	   *sets;			/* list of GraphSetProp's for SET/REMOVE */
 	bool	   *update_cols;	/* array of columns to update */
-	HTAB	   *elemTable;
+	struct SetLabelState *setLabels;	/* per-label state for SET */
+	int			numSetLabels;
+	struct SetLabelState *lastSetLabel; /* label of the last SET element */
+	struct ModifiedElemTable *elemTable;
+	int			num_elem_cols;	/* # of output columns with graph elements */
+	AttrNumber *elem_cols;		/* and their numbers, or NULL if unknown */
 	Tuplestorestate *tuplestorestate;
 	TupleTableSlot *(*execProc) (struct ModifyGraphState *pstate,
 								 TupleTableSlot *slot);
@@ -2714,6 +2754,11 @@ typedef struct Hash2SideState
 	HeapTuple	vertexRow;		/* For reusing the vertexRow */
 	TupleDesc	tupleDesc;		/* Tuple descriptor for above vertexRow */
 
+	/* predecessors of the path tuples of this side, see nodeShortestpath.c */
+	char	   *preds;
+	int64		npreds;
+	int64		maxpreds;
+
 	/*
 	 * If we are collecting hash stats, this points to an initially-zeroed
 	 * collection area, which could be either local storage or in shared
@@ -2742,12 +2787,10 @@ typedef struct ShortestpathState
 	int			sp_CurOuterIdx;
 	TupleTableSlot *sp_OuterTupleSlot;
 	TupleTableSlot *sp_HashTupleSlot;
-	long		sp_Hops;
 	int			sp_RowidSize;
 	MinimalTuple sp_GraphidTuple;
 	MinimalTuple sp_OuterTuple;
-	unsigned char *sp_Vertexids;
-	unsigned char *sp_Edgeids;
+	int64		sp_CurPred;		/* predecessor of the new path tuples */
 	int			sp_JoinState;
 	ExprState  *source;
 	ExprState  *target;
@@ -2771,6 +2814,8 @@ typedef struct DijkstraState
 	ExprState  *source;
 	ExprState  *target;
 	ExprState  *limit;
+	ExprState  *heuristic;
+	HTAB	   *estimates;		/* A* estimate of each vertex reached so far */
 	int			n;
 	int			max_n;
 	Graphid		target_id;
@@ -2778,6 +2823,11 @@ typedef struct DijkstraState
 	TupleTableSlot *selfTupleSlot;
 	HeapTuple	vertexRow;		/* pointer to hold reusable vertex row */
 	TupleDesc	tupleDesc;		/* pointer to vertex row's tuple descr */
+	/* for ALL LIMIT; everything is allocated in ksp_mcxt */
+	MemoryContext ksp_mcxt;
+	HTAB	   *ksp_adjacency;	/* edges out of the vertexes expanded so far */
+	List	   *ksp_paths;		/* paths returned so far */
+	pairingheap *ksp_candidates;	/* paths not returned yet */
 } DijkstraState;
 
 typedef struct GraphVLEState
@@ -2792,6 +2842,8 @@ typedef struct GraphVLEState
 
 	/* target edges. */
 	ResultRelInfo *target_rel_infos;
+	Relation   *start_index_rels;	/* (start, end) index per target, or NULL */
+	Relation   *end_index_rels; /* (end, start) index per target, or NULL */
 	TupleTableSlot *current_scan_tuple;
 	int			num_target_rel_info;
 
@@ -2799,6 +2851,7 @@ typedef struct GraphVLEState
 	Graphid		first_start_id;
 	Graphid		last_end_id;
 	ArrayBuildState *edge_ids;
+	struct vle_edgeset_hash *edge_id_set;	/* set of the ids in edge_ids */
 	ArrayBuildState *edges;
 	ArrayBuildState *vertices;
 
@@ -2809,8 +2862,28 @@ typedef struct GraphVLEState
 
 	/* Scanning depth infos */
 	List	   *table_scan_desc_list;	/* List for saving scan descriptions. */
+	List	   *free_depth_ctx_list;	/* popped depths, kept for reuse */
 	bool		use_vertex_output;
+	struct GraphVertexCache *vertex_cache;	/* for vertex output */
+	struct AdjCacheRef *adjcache_refs;	/* adjacency cache per target */
 	Jsonb	   *jsonb_filter;
+	Relation   *filter_index_rels;	/* GIN index on properties per target,
+									 * or NULL */
+	TIDBitmap **filter_tbms;	/* edges the GIN index finds for jsonb_filter,
+								 * per target, built at its first probe */
+
+	/* Breadth-first search */
+	bool		bfs;
+	MemoryContext bfs_mcxt;		/* paths expanded from the start vertex */
+	struct VLEDepthCtx *bfs_depth_ctx;	/* scans for frontier probes */
+	struct VLEPathNode **bfs_level; /* paths of the current level */
+	int			bfs_level_len;
+	int			bfs_level_pos;	/* next path of the level to return */
+	int			bfs_depth;
+	struct VLEPathNode **bfs_next_level;	/* paths of the level being
+											 * expanded */
+	int			bfs_next_level_len;
+	int			bfs_next_level_size;
 } GraphVLEState;
 
 #endif							/* EXECNODES_H */
@@ -199,7 +199,9 @@ typedef struct Query
 	bool		dijkstraWeightOut;
 	Node	   *dijkstraEndId;
 	Node	   *dijkstraEdgeId;
+	Node	   *dijkstraHeuristic;
 	Node	   *dijkstraLimit;
+	bool		dijkstraTopK;
 	Node	   *shortestpathEndIdLeft;
 	Node	   *shortestpathEndIdRight;
 	Node	   *shortestpathTableOidLeft;
@@ -3966,6 +3968,9 @@ typedef struct CypherPath
 	Node	   *qual;
 	Node	   *limit;
 	Node	   *weight_var;
+	Node	   *heuristic_var;	/* CypherName of the vertex to estimate */
+	Node	   *heuristic;		/* A* estimate of the remaining weight */
+	bool		topk;			/* k shortest paths, not only equally short */
 } CypherPath;
 
 typedef struct CypherNode
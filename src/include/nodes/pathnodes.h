@@ -131,6 +131,10 @@ typedef struct PlannerGlobal
 	char		maxParallelHazard;	/* worst PROPARALLEL hazard level */
 
 	PartitionDirectory partition_directory; /* partition descriptors */
+
+	Oid			graphmetaGraph; /* graph of graphmetaList, if read yet */
+
+	List	   *graphmetaList;	/* ag_graphmeta entries of graphmetaGraph */
 } PlannerGlobal;
 
 /* macro for fetching the Plan associated with a SubPlan node */
@@ -1950,9 +1954,11 @@ typedef struct DijkstraPath
 	bool		weight_out;
 	Node	   *end_id;
 	Node	   *edge_id;
+	Node	   *heuristic;		/* A* estimate, or NULL */
 	Node	   *source;
 	Node	   *target;
 	Node	   *limit;
+	bool		topk;			/* k shortest loopless paths */
 } DijkstraPath;
 
 typedef struct GraphVLEPath
@@ -1960,6 +1966,7 @@ typedef struct GraphVLEPath
 	Path		path;
 	Path	   *subpath;		/* Path producing source data */
 	CypherRel  *vle_rel;
+	bool		bfs;			/* expand breadth-first? */
 } GraphVLEPath;
 
 /*
@@ -2118,6 +2125,9 @@ typedef struct RestrictInfo
 
 	bool		leakproof;		/* true if known to contain no leaked Vars */
 
+	bool		join_redundant; /* true if implied by other join clauses, so
+								 * join size estimates must ignore it */
+
 	VolatileFunctionStatus has_volatile;	/* to indicate if clause contains
 											 * any volatile functions. */
 
@@ -263,6 +263,17 @@ typedef struct Append
 
 	/* Info for run-time subplan pruning; NULL if we're not doing that */
 	struct PartitionPruneInfo *part_prune_info;
+
+	/*
+	 * For run-time pruning of the children of a graph label: the graphid
+	 * whose label selects the subplans to scan, and the label id of each
+	 * subplan. NULL and NIL if we're not doing that. If the graphid does not
+	 * depend on PARAM_EXEC params, the subplans are chosen once at executor
+	 * startup.
+	 */
+	Expr	   *graph_id_expr;
+	List	   *graph_labids;
+	bool		graph_id_exec;	/* graph_id_expr uses PARAM_EXEC params */
 } Append;
 
 /* ----------------
@@ -1338,6 +1349,7 @@ typedef struct GraphVLE
 	Plan		plan;
 	Plan	   *subplan;		/* plan producing source data */
 	Node	   *vle_rel;
+	bool		bfs;			/* expand breadth-first? */
 } GraphVLE;
 
 typedef struct Shortestpath
@@ -1378,6 +1390,8 @@ typedef struct Dijkstra
 	Node	   *source;
 	Node	   *target;
 	Node	   *limit;
+	Node	   *heuristic;		/* A* estimate of the remaining weight */
+	bool		topk;			/* k shortest loopless paths */
 } Dijkstra;
 
 #endif							/* PLANNODES_H */
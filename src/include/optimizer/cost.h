@@ -213,5 +213,9 @@ extern double compute_bitmap_pages(PlannerInfo *root, RelOptInfo *baserel,
 extern void cost_dijkstra(Path *path,
 						  Cost input_startup_cost, Cost input_total_cost,
 						  double tuples, int width);
+extern double estimate_graph_vle_fanout(PlannerInfo *root,
+										 CypherRel *vle_rel);
+extern bool graph_vle_prefers_bfs(CypherRel *vle_rel, double fanout);
+extern void cost_graph_vle(GraphVLEPath *path, double fanout);
 
 #endif							/* COST_H */
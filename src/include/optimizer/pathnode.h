@@ -349,8 +349,9 @@ extern DijkstraPath *create_dijkstra_path(PlannerInfo *root, RelOptInfo *rel,
 										  PathTarget *path_target,
 										  int weight, bool weight_out,
 										  Node *end_id, Node *edge_id,
+										  Node *heuristic,
 										  Node *source, Node *target,
-										  Node *limit);
+										  Node *limit, bool topk);
 extern ModifyGraphPath *create_modifygraph_path(PlannerInfo *root,
 												RelOptInfo *rel,
 												GraphWriteOp operation,
@@ -362,6 +363,7 @@ extern ModifyGraphPath *create_modifygraph_path(PlannerInfo *root,
 												int epqParam);
 
 extern GraphVLEPath *create_graph_vle_path(PlannerInfo *root,
-										   RelOptInfo *rel, Path *subpath, CypherRel *vle_rel);
+										   RelOptInfo *rel, Path *subpath, CypherRel *vle_rel,
+										   double fanout);
 
 #endif							/* PATHNODE_H */
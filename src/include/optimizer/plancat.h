@@ -38,6 +38,11 @@ extern int32 get_relation_data_width(Oid relid, int32 *attr_widths);
 
 extern bool relation_excluded_by_constraints(PlannerInfo *root,
 											 RelOptInfo *rel, RangeTblEntry *rte);
+extern bool graph_label_excluded_by_id(PlannerInfo *root, RelOptInfo *rel,
+									   RangeTblEntry *rte);
+extern bool is_graph_label_appendrel(PlannerInfo *root, RelOptInfo *rel);
+extern Expr *find_graph_label_id_expr(PlannerInfo *root, RelOptInfo *rel,
+									  List *clauses);
 
 extern List *build_physical_tlist(PlannerInfo *root, RelOptInfo *rel);
 
@@ -74,4 +79,7 @@ extern bool has_row_triggers(PlannerInfo *root, Index rti, CmdType event);
 
 extern bool has_stored_generated_columns(PlannerInfo *root, Index rti);
 
+extern List *get_graphmeta_list(Oid graphoid);
+extern List *get_planner_graphmeta_list(PlannerInfo *root, Oid graphoid);
+
 #endif							/* PLANCAT_H */
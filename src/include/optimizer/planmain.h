@@ -54,11 +54,13 @@ extern ModifyGraph *make_modifygraph(PlannerInfo *root, GraphWriteOp operation,
 									 bool eagerness, List *pattern,
 									 List *exprs, List *sets,
 									 List *resultRelations, int epqParam);
-extern GraphVLE *make_graph_vle(PlannerInfo *root, Plan *subplan, CypherRel *vle_rel);
+extern GraphVLE *make_graph_vle(PlannerInfo *root, Plan *subplan, CypherRel *vle_rel,
+							   bool bfs);
 extern Dijkstra *make_dijkstra(PlannerInfo *root, List *tlist, Plan *subplan,
 							   AttrNumber weight, bool weight_out,
 							   AttrNumber end_id, AttrNumber edge_id,
-							   Node *source, Node *target, Node *limit);
+							   Node *source, Node *target, Node *limit,
+							   Node *heuristic, bool topk);
 
 /* External use of these functions is deprecated: */
 extern Sort *make_sort_from_sortclauses(List *sortcls, Plan *lefttree);
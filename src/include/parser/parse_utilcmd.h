@@ -18,6 +18,8 @@
 
 struct AttrMap;					/* avoid including attmap.h here */
 
+extern int	graph_element_id_cache;
+
 
 extern List *transformCreateStmt(CreateStmt *stmt, const char *queryString);
 extern AlterTableStmt *transformAlterTableStmt(Oid relid, AlterTableStmt *stmt,
@@ -29,6 +29,8 @@
 #define PGSTAT_STAT_PERMANENT_DIRECTORY		"pg_stat"
 #define PGSTAT_STAT_PERMANENT_FILENAME		"pg_stat/global.stat"
 #define PGSTAT_STAT_PERMANENT_TMPFILE		"pg_stat/global.tmp"
+#define AGSTAT_GRAPHMETA_FILENAME			"pg_stat/graphmeta.stat"
+#define AGSTAT_GRAPHMETA_TMPFILE			"pg_stat/graphmeta.tmp"
 
 /* Default directory to store temporary statistics data in */
 #define PG_STAT_TMP_DIR		"pg_stat_tmp"
@@ -927,6 +929,7 @@ extern char *pgstat_stat_directory;
 extern char *pgstat_stat_tmpname;
 extern char *pgstat_stat_filename;
 extern bool auto_gather_graphmeta;
+extern int	max_pending_graphmeta;
 
 /*
  * BgWriter statistics counters are updated directly by bgwriter and bufmgr
@@ -1072,6 +1075,7 @@ extern void pgstat_end_function_usage(PgStat_FunctionCallUsage *fcu,
 
 extern void AtEOXact_PgStat(bool isCommit, bool parallel);
 extern void AtEOSubXact_PgStat(bool isCommit, int nestDepth);
+extern void PreCommit_AgStat(void);
 extern void AtEOXact_AgStat(bool isCommit);
 extern void AtEOSubXact_AgStat(bool isCommit, int nestDepth);
 
@@ -1117,5 +1121,17 @@ extern void agstat_count_edge_delete(Labid edge, Labid start, Labid end);
 extern void agstat_drop_vlabel(const char *vlab);
 extern void agstat_drop_elabel(const char *elab);
 extern void agstat_drop_graph(const char *graph);
+extern Size AgStatShmemSize(void);
+extern void AgStatShmemInit(void);
+extern List *agstat_get_pending_graphmeta(Oid graph);
+extern void agstat_discard_pending_graphmeta(Oid graph, Labid vlabel,
+											 Labid elabel);
+extern void agstat_flush_graphmeta(void);
+extern void agstat_save_pending_graphmeta(void);
+extern void agstat_restore_pending_graphmeta(void);
+extern bool agstat_label_gathered(Oid relid, PgStat_Counter changes,
+								  Oid relfilenode);
+extern void agstat_remember_gathered_label(Oid relid, PgStat_Counter changes,
+										   Oid relfilenode);
 
 #endif							/* PGSTAT_H */
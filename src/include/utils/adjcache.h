@@ -0,0 +1,46 @@
+/*
+ * adjcache.h
+ *	  shared-memory adjacency cache of edge labels
+ *
+ * Copyright (c) 2022 by Bitnine Global, Inc.
+ *
+ * src/include/utils/adjcache.h
+ */
+
+#ifndef ADJCACHE_H
+#define ADJCACHE_H
+
+#include "storage/itemptr.h"
+#include "utils/graph.h"
+#include "utils/relcache.h"
+#include "utils/snapshot.h"
+
+/* an edge of a vertex, as seen from the vertex */
+typedef struct AdjCacheEdge
+{
+	Graphid		edge_id;
+	Graphid		neighbor_id;	/* vertex at the other side of the edge */
+	ItemPointerData tid;		/* of the edge tuple */
+} AdjCacheEdge;
+
+/* a reference to a cached edge label, valid while the label is not changed */
+typedef struct AdjCacheRef
+{
+	Oid			relid;			/* InvalidOid if the cache is not used */
+	int			slotno;
+	uint64		generation;
+} AdjCacheRef;
+
+/* GUC parameter, in kilobytes */
+extern int	graph_adjacency_cache_size;
+
+extern Size AdjCacheShmemSize(void);
+extern void AdjCacheShmemInit(void);
+extern void InitAdjCache(void);
+
+extern bool AdjCacheAcquire(Relation rel, Snapshot snapshot, AdjCacheRef *ref);
+extern int	AdjCacheLookup(AdjCacheRef *ref, Graphid vertex_id, bool outgoing,
+						   AdjCacheEdge **edges);
+extern void AdjCacheRelationModified(Relation rel);
+
+#endif							/* ADJCACHE_H */
@@ -66,6 +66,9 @@ extern Datum jsonb_string_ends_with(PG_FUNCTION_ARGS);
 extern Datum jsonb_string_contains(PG_FUNCTION_ARGS);
 extern Datum jsonb_string_regex(PG_FUNCTION_ARGS);
 
+/* property map */
+extern Datum jsonb_set_keys(PG_FUNCTION_ARGS);
+
 /* for array supports */
 extern Datum array_head(PG_FUNCTION_ARGS);
 extern Datum array_last(PG_FUNCTION_ARGS);
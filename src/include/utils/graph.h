@@ -14,6 +14,7 @@
 
 #include "fmgr.h"
 #include "storage/itemptr.h"
+#include "utils/snapshot.h"
 
 typedef uint64 Graphid;
 typedef uint16 Labid;
@@ -68,7 +69,16 @@ typedef struct
 										 (slot)->tts_values[Anum_table_vertex_prop_map - 1], \
 										 PointerGetDatum(&(slot)->tts_tid)))
 
+typedef struct GraphVertexCache GraphVertexCache;
+
 extern Datum get_vertex_from_graphid(Graphid vertex_id);
+extern GraphVertexCache *create_graph_vertex_cache(Snapshot snapshot);
+extern Datum get_vertex_from_graphid_cached(GraphVertexCache *cache,
+											Graphid vertex_id);
+extern void get_vertices_from_graphids(GraphVertexCache *cache,
+									   Graphid *vertex_ids, int nvertices,
+									   Datum *vertices);
+extern void free_graph_vertex_cache(GraphVertexCache *cache);
 
 /* graphid */
 extern Datum graphid(PG_FUNCTION_ARGS);
@@ -109,6 +119,8 @@ extern Datum btrowidcmp(PG_FUNCTION_ARGS);
 /* vertex */
 extern Datum vertex_out(PG_FUNCTION_ARGS);
 extern Datum _vertex_out(PG_FUNCTION_ARGS);
+extern Datum vertex_recv(PG_FUNCTION_ARGS);
+extern Datum vertex_send(PG_FUNCTION_ARGS);
 extern Datum vertex_label(PG_FUNCTION_ARGS);
 extern Datum _vertex_length(PG_FUNCTION_ARGS);
 extern Datum vtojb(PG_FUNCTION_ARGS);
@@ -124,6 +136,8 @@ extern Datum vertex_ge(PG_FUNCTION_ARGS);
 /* edge */
 extern Datum edge_out(PG_FUNCTION_ARGS);
 extern Datum _edge_out(PG_FUNCTION_ARGS);
+extern Datum edge_recv(PG_FUNCTION_ARGS);
+extern Datum edge_send(PG_FUNCTION_ARGS);
 extern Datum edge_label(PG_FUNCTION_ARGS);
 extern Datum _edge_length(PG_FUNCTION_ARGS);
 extern Datum etojb(PG_FUNCTION_ARGS);
@@ -138,6 +152,8 @@ extern Datum edge_ge(PG_FUNCTION_ARGS);
 
 /* graphpath */
 extern Datum graphpath_out(PG_FUNCTION_ARGS);
+extern Datum graphpath_recv(PG_FUNCTION_ARGS);
+extern Datum graphpath_send(PG_FUNCTION_ARGS);
 extern Datum _graphpath_length(PG_FUNCTION_ARGS);
 extern Datum graphpath_length(PG_FUNCTION_ARGS);
 extern Datum graphpath_vertices(PG_FUNCTION_ARGS);
@@ -178,5 +194,7 @@ extern Datum gin_compare_partial_graphid(PG_FUNCTION_ARGS);
 
 /* graph meta */
 extern Datum regather_graphmeta(PG_FUNCTION_ARGS);
+extern Datum regather_graphmeta_incremental(PG_FUNCTION_ARGS);
+extern Datum ag_graphmeta_current(PG_FUNCTION_ARGS);
 
 #endif							/* GRAPH_H */
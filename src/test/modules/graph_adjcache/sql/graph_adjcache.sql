@@ -0,0 +1,41 @@
+--
+-- adjacency cache of edge labels for variable-length edge traversal
+--
+SHOW graph_adjacency_cache_size;
+
+CREATE GRAPH adjcache;
+SET graph_path = adjcache;
+
+CREATE VLABEL n;
+CREATE ELABEL r;
+
+CREATE (:n {id: 1})-[:r]->(:n {id: 2})-[:r]->(:n {id: 3});
+
+-- the label is cached when it is requested for the third time
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+
+-- a write invalidates the label
+MATCH (a:n {id: 3}) CREATE (a)-[:r]->(:n {id: 4});
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 4})<-[:r*1..]-(b:n) RETURN b.id AS b ORDER BY b;
+
+-- a rolled back delete leaves the edge in the label
+BEGIN;
+MATCH (:n {id: 2})-[k:r]->(:n {id: 3}) DELETE k;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+ROLLBACK;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+
+MATCH (:n {id: 2})-[k:r]->(:n {id: 3}) DELETE k;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 4})<-[:r*1..]-(b:n) RETURN b.id AS b ORDER BY b;
+
+DROP GRAPH adjcache CASCADE;
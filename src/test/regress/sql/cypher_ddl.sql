@@ -361,6 +361,35 @@ CREATE CONSTRAINT ON regv8 ASSERT (SELECT * FROM graph.regv8).c IS NOT NULL;
 CREATE CONSTRAINT ON regv8 ASSERT (1).c IS NOT NULL;
 CREATE CONSTRAINT ON regv8 ASSERT ($1).c IS NOT NULL;
 
+-- id index of edge labels
+
+CREATE ELABEL eidx_btree;
+CREATE ELABEL eidx_hash WITH (id_index = hash);
+CREATE ELABEL eidx_brin WITH (id_index = brin, fillfactor = 90);
+SELECT indexdef FROM pg_indexes
+WHERE schemaname = 'ddl' AND indexname = tablename || '_id_idx'
+      AND tablename LIKE 'eidx%'
+ORDER BY 1;
+SELECT relname, reloptions FROM pg_class
+WHERE relnamespace = 'ddl'::regnamespace AND relname LIKE 'eidx%'
+      AND relkind = 'r'
+ORDER BY 1;
+
+-- wrong case
+
+CREATE ELABEL eidx_gin WITH (id_index = gin);
+CREATE VLABEL vidx WITH (id_index = hash);
+
+-- sequence cache of local ids
+
+CREATE VLABEL vcache32;
+SET graph_element_id_cache = 1;
+CREATE VLABEL vcache1;
+RESET graph_element_id_cache;
+SELECT sequencename, cache_size FROM pg_sequences
+WHERE schemaname = 'ddl' AND sequencename LIKE 'vcache%'
+ORDER BY 1;
+
 --
 -- DROP GRAPH
 --
@@ -100,6 +100,23 @@ CREATE p=()-[:e1]->() RETURN p;
 
 CREATE (a {name:'agens'}), (b {name:a.name});
 
+-- buffered CREATE into several labels in one statement
+CREATE VLABEL src;
+CREATE VLABEL mv1;
+CREATE VLABEL mv2;
+CREATE ELABEL me;
+INSERT INTO g_create.src (properties)
+SELECT jsonb_build_object('i', i) FROM generate_series(1, 1500) AS i;
+MATCH (s:src) CREATE (:mv1 {i: s.i})-[:me {i: s.i}]->(:mv2 {i: s.i});
+SELECT (SELECT count(*) FROM g_create.mv1) AS mv1,
+       (SELECT count(*) FROM g_create.mv2) AS mv2,
+       (SELECT count(*) FROM g_create.me) AS me;
+MATCH (a:mv1)-[r:me]->(b:mv2) WHERE a.i = r.i AND b.i = r.i RETURN count(*);
+DROP ELABEL me;
+DROP VLABEL mv2;
+DROP VLABEL mv1;
+DROP VLABEL src;
+
 DROP GRAPH g_create CASCADE;
 
 --
@@ -370,6 +387,18 @@ CREATE (:time {sec: 11})-[:goes {int: 1}]->
 MATCH (a:time)-[x:goes*1..2 {int: 1}]->(b:time)
 RETURN a.sec AS a, length(x) AS x, b.sec AS b;
 
+MATCH (a:time)-[x:goes*1..2]->(b:time)
+WHERE all(e IN x WHERE e.int = 1)
+RETURN a.sec AS a, length(x) AS x, b.sec AS b ORDER BY a, x;
+
+MATCH (a:time)-[x:goes*1..2 {int: 1}]->(b:time)
+WHERE all(e IN x WHERE e.int = 2)
+RETURN a.sec AS a, length(x) AS x, b.sec AS b;
+
+-- property maps without WHERE
+MATCH (a:time {sec: 11})-[x:goes*1..2 {int: 1}]->(b:time)
+RETURN a.sec AS a, length(x) AS x, b.sec AS b ORDER BY x;
+
 CREATE VLABEL person;
 CREATE ELABEL knows;
 
@@ -561,6 +590,35 @@ CREATE (n)-[:e3]->(:v3), (n)-[:e3]->(:v3);
 
 MATCH p=(:v1)-[*3]->() RETURN p;
 
+-- VLE sees edge changes made after the adjacency of the label is cached
+
+CREATE GRAPH vleadj;
+SET graph_path = vleadj;
+
+CREATE VLABEL n;
+CREATE ELABEL r;
+
+CREATE (:n {id: 1})-[:r]->(:n {id: 2})-[:r]->(:n {id: 3});
+
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+
+MATCH (a:n {id: 3}) CREATE (a)-[:r]->(:n {id: 4});
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+
+BEGIN;
+MATCH (:n {id: 2})-[k:r]->(:n {id: 3}) DELETE k;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+ROLLBACK;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+
+MATCH (:n {id: 2})-[k:r]->(:n {id: 3}) DELETE k;
+MATCH (a:n {id: 1})-[:r*1..]->(b:n) RETURN b.id AS b ORDER BY b;
+
+DROP GRAPH vleadj CASCADE;
+
 SET graph_path = agens;
 
 --
@@ -897,6 +955,19 @@ RETURN a.no;
 
 MATCH (a) DETACH DELETE (a);
 
+-- modified elements that do not fit in work_mem
+CREATE VLABEL spill;
+INSERT INTO p.spill (properties)
+SELECT jsonb_build_object('i', i, 's', repeat('x', 1000))
+FROM generate_series(1, 200) AS i;
+SET work_mem = 64;
+MATCH (a:spill) UNWIND [1, 2, 1] AS k
+SET a.t = CASE k WHEN 1 THEN a.s ELSE a.s + a.s END;
+RESET work_mem;
+MATCH (a:spill) WHERE a.t = a.s RETURN count(*);
+MATCH (a) DETACH DELETE (a);
+DROP VLABEL spill;
+
 -- += operator
 
 CREATE ({age: 10});
@@ -931,6 +1002,27 @@ MATCH (a) SET a = NULL;
 
 MATCH (a) DETACH DELETE (a);
 
+-- several properties of an element at once
+CREATE ({a: 1, b: 2, c: 3});
+MATCH (n) SET n.a = 10, n.b = NULL, n.d = 'd', n.a = n.c, n.e = 'e'
+RETURN properties(n);
+MATCH (n) RETURN properties(n);
+MATCH (n) DETACH DELETE (n);
+
+-- properties of an element with a property index
+CREATE VLABEL indexed;
+CREATE PROPERTY INDEX ON indexed (name);
+CREATE (:indexed {name: 'a', v: 1});
+SET enable_seqscan = off;
+MATCH (n:indexed) SET n.v = 2, n.w = 3;
+MATCH (n:indexed) WHERE n.name = 'a' RETURN properties(n);
+MATCH (n:indexed) SET n.name = 'b';
+MATCH (n:indexed) WHERE n.name = 'a' RETURN properties(n);
+MATCH (n:indexed) WHERE n.name = 'b' RETURN properties(n);
+SET enable_seqscan = on;
+MATCH (n) DETACH DELETE (n);
+DROP VLABEL indexed;
+
 -- referring to undefined attributes
 CREATE ({name: 'bitnine'});
 CREATE ({age: 10});
@@ -1112,6 +1204,25 @@ MATCH (a) RETURN a;
 
 MERGE p=(a:v4)-[:e4]->(b:v5) RETURN p;
 
+-- MERGE must see what it created for the previous rows with a hash join too
+SET enable_nestloop TO off;
+EXPLAIN (COSTS OFF) UNWIND [1, 2, 1, 3, 2] AS x MERGE (a:v3 {id: x});
+UNWIND [1, 2, 1, 3, 2] AS x MERGE (:v3 {id: x});
+MATCH (a:v3) RETURN count(*);
+
+-- a cached plan keeps the hash table in one batch with less work_mem
+CREATE VLABEL v6;
+INSERT INTO gm.v6 (properties)
+SELECT jsonb_build_object('id', i) FROM generate_series(1, 2000) AS i;
+PREPARE merge_v6 AS UNWIND [1, 2001, 2001] AS x MERGE (a:v6 {id: x});
+EXPLAIN (COSTS OFF) EXECUTE merge_v6;
+SET work_mem = 64;
+EXECUTE merge_v6;
+RESET work_mem;
+MATCH (a:v6) RETURN count(*);
+DEALLOCATE merge_v6;
+RESET enable_nestloop;
+
 DROP GRAPH gm CASCADE;
 
 --
@@ -237,8 +237,56 @@ RETURN *;
 MATCH (a)-[]-(a) RETURN *;
 MATCH p=(a)-[]-(a) RETURN *;
 
-EXPLAIN VERBOSE MATCH (a)-[]-(a) RETURN a;
-EXPLAIN VERBOSE MATCH (a)-[]-(a) RETURN *;
-EXPLAIN VERBOSE MATCH p=(a)-[]-(a) RETURN *;
+EXPLAIN (VERBOSE, COSTS OFF) MATCH (a)-[]-(a) RETURN a;
+EXPLAIN (VERBOSE, COSTS OFF) MATCH (a)-[]-(a) RETURN *;
+EXPLAIN (VERBOSE, COSTS OFF) MATCH p=(a)-[]-(a) RETURN *;
+
+DROP GRAPH cypher_dml2 CASCADE;
+
+-- the label of a graphid parameter chooses the only child label to scan
+CREATE GRAPH cypher_dml2;
+SET GRAPH_PATH to cypher_dml2;
+
+CREATE VLABEL v1;
+CREATE VLABEL v2;
+CREATE (:v1 {id: 1}), (:v2 {id: 2});
+
+SET plan_cache_mode TO force_generic_plan;
+SET enable_seqscan TO off;
+SET enable_bitmapscan TO off;
+PREPARE vertex_by_id(graphid) AS
+SELECT properties FROM ag_vertex WHERE id = $1;
+EXPLAIN (COSTS OFF) EXECUTE vertex_by_id('4.1');
+EXECUTE vertex_by_id('4.1');
+EXECUTE vertex_by_id('3.1');
+DEALLOCATE vertex_by_id;
+RESET enable_bitmapscan;
+RESET enable_seqscan;
+RESET plan_cache_mode;
+
+DROP GRAPH cypher_dml2 CASCADE;
+
+-- an undirected relationship looks up the edges of a vertex through the
+-- indexes on start and "end" of the edge label
+CREATE GRAPH cypher_dml2;
+SET GRAPH_PATH to cypher_dml2;
+
+CREATE VLABEL person;
+CREATE ELABEL knows;
+CREATE (:person {name: 'a'})-[:knows]->(:person {name: 'b'})
+       -[:knows]->(:person {name: 'c'});
+
+SET enable_seqscan TO off;
+SET enable_hashjoin TO off;
+SET enable_mergejoin TO off;
+SET enable_memoize TO off;
+EXPLAIN (COSTS OFF)
+MATCH (a:person {name: 'b'})-[:knows]-(b:person) RETURN b;
+MATCH (a:person {name: 'b'})-[:knows]-(b:person)
+RETURN b.name AS name ORDER BY name;
+RESET enable_memoize;
+RESET enable_mergejoin;
+RESET enable_hashjoin;
+RESET enable_seqscan;
 
 DROP GRAPH cypher_dml2 CASCADE;
@@ -328,6 +328,21 @@ MATCH (n:coll) RETURN n;
 CREATE (:ts {v: 'a fat cat sat on a mat and ate a fat rat'::tsvector});
 MATCH (n:ts) WHERE n.v::tsvector @@ 'cat & rat'::tsquery RETURN n;
 
+-- Property access on compressed property maps
+
+CREATE VLABEL toast;
+INSERT INTO test_cypher_expr.toast (properties)
+VALUES (jsonb_build_object('a', 1, 'b', 'x', 's', repeat('agens', 2000))),
+       (jsonb_build_object('a', 2, 'b', 'y', 's', repeat('graph', 2000)));
+MATCH (n:toast) RETURN n.a AS a, n.b AS b, n.a AS a2 ORDER BY a;
+
+-- and on property maps stored out of line
+ALTER VLABEL toast SET STORAGE external;
+INSERT INTO test_cypher_expr.toast (properties)
+VALUES (jsonb_build_object('a', 3, 'b', 'z', 's', repeat('agens', 2000))),
+       (jsonb_build_object('a', 4, 'b', 'w', 's', repeat('graph', 2000)));
+MATCH (n:toast) RETURN n.a AS a, n.b AS b, n.a AS a2 ORDER BY a;
+
 -- Tear down
 DROP TABLE t1;
 DROP GRAPH test_cypher_expr CASCADE;
@@ -188,6 +188,32 @@ RETURN nodes(path), x;
 MATCH (v1:v {id: 0}), (v2:v {id: 3})
 RETURN dijkstra((v1)-[e:e]->(v2), e.weight, LIMIT 2);
 
+MATCH (v1:v {id: 0}), (v2:v {id: 3}),
+	  (path, x)=dijkstra((v1)-[e:e]->(v2), e.weight, LIMIT 2, USING n => 0)
+RETURN nodes(path), x;
+
+MATCH (v1:v {id: 0}), (v2:v {id: 3}),
+	  (path, x)=dijkstra((v1)-[e:e]->(v2), e.weight, ALL LIMIT 4)
+RETURN nodes(path), x;
+
+-- A* with an admissible estimate finds the same paths
+MATCH (v1:v {id: 0}), (v2:v {id: 3}),
+	  (path, x)=dijkstra((v1)-[e:e]->(v2), e.weight, LIMIT 2,
+	                     USING n => CASE n.id WHEN 1 THEN 6 WHEN 2 THEN 2 WHEN 4 THEN 8
+	                                          WHEN 5 THEN 9 WHEN 6 THEN 4 ELSE 0 END)
+RETURN nodes(path), x;
+
+MATCH (v1:v {id: 0}), (v2:v {id: 3}),
+	  (path, x)=dijkstra((v1)-[e:e]->(v2), e.weight, ALL LIMIT 4,
+	                     USING n => CASE n.id WHEN 1 THEN 6 WHEN 2 THEN 2 WHEN 4 THEN 8
+	                                          WHEN 5 THEN 9 WHEN 6 THEN 4 ELSE 0 END)
+RETURN nodes(path), x;
+
+MATCH (v1:v {id: 0}), (v2:v {id: 3}),
+	  (path, x)=dijkstra((v1)-[e:e]->(v2), e.weight,
+	                     USING n => e.weight)
+RETURN nodes(path), x;
+
 MATCH (v1:v {id: 0}), (v2:v {id: 3}),
 	  (path, x)=dijkstra((v1)-[e:e]->(v2), e.weight, LIMIT 0)
 RETURN nodes(path), x;
@@ -168,6 +168,90 @@ SELECT regather_graphmeta();
 
 SELECT * FROM ag_graphmeta_view ORDER BY start, edge, "end";
 
+SELECT regather_graphmeta(true);
+
+SELECT * FROM ag_graphmeta_view ORDER BY start, edge, "end";
+
+-- join estimates from ag_graphmeta
+
+CREATE FUNCTION graphmeta_join_rows(query text) RETURNS int
+LANGUAGE plpgsql AS $$
+DECLARE
+	ln text;
+BEGIN
+	FOR ln IN EXECUTE 'EXPLAIN ' || query LOOP
+		RETURN (regexp_match(ln, 'rows=(\d+)'))[1]::int;
+	END LOOP;
+END;
+$$;
+
+SELECT graphmeta_join_rows($$SELECT 1 FROM graphmeta.human a, graphmeta.know r
+  WHERE a.id = r.start$$);
+SELECT graphmeta_join_rows($$SELECT 1 FROM graphmeta.human a, graphmeta.follow r
+  WHERE a.id = r.start$$);
+SELECT graphmeta_join_rows($$SELECT 1 FROM graphmeta.dog a, graphmeta.follow r
+  WHERE a.id = r.start$$);
+SELECT graphmeta_join_rows($$SELECT 1 FROM graphmeta.human a, graphmeta.know r, graphmeta.human b
+  WHERE a.id = r.start AND r."end" = b.id$$);
+
+DROP FUNCTION graphmeta_join_rows(text);
+
+-- regather_graphmeta(true) recounts only the labels with new or deleted edges
+
+CREATE (:dog)-[:chase]->(:cat), (:dog)-[:chase]->(:cat);
+CREATE (:cat)-[:scratch]->(:dog);
+
+CREATE FUNCTION wait_for_label_changes(label regclass, changes int)
+RETURNS void LANGUAGE plpgsql AS $$
+BEGIN
+	FOR i IN 1 .. 300 LOOP
+		IF pg_stat_get_tuples_inserted(label) +
+		   pg_stat_get_tuples_deleted(label) >= changes THEN
+			RETURN;
+		END IF;
+		PERFORM pg_sleep(0.1);
+		PERFORM pg_stat_clear_snapshot();
+	END LOOP;
+	RAISE EXCEPTION 'stats collector did not count % changes of %',
+		changes, label;
+END;
+$$;
+
+-- force the rate-limiting logic in pgstat_report_stat() to time out and
+-- send the counts of this backend
+SELECT pg_sleep(1.0);
+
+SELECT wait_for_label_changes('graphmeta.chase', 2);
+SELECT wait_for_label_changes('graphmeta.scratch', 1);
+
+SELECT regather_graphmeta(true);
+
+SELECT * FROM ag_graphmeta_view WHERE edge IN ('chase', 'scratch')
+  ORDER BY start, edge, "end";
+
+-- an updated edge does not make its label count again
+
+UPDATE graphmeta.scratch SET start = (SELECT id FROM graphmeta.dog LIMIT 1);
+CREATE (:dog)-[:chase]->(:cat);
+
+-- force the rate-limiting logic in pgstat_report_stat() to time out and
+-- send the counts of this backend
+SELECT pg_sleep(1.0);
+
+SELECT wait_for_label_changes('graphmeta.chase', 3);
+
+SELECT regather_graphmeta(true);
+
+SELECT * FROM ag_graphmeta_view WHERE edge IN ('chase', 'scratch')
+  ORDER BY start, edge, "end";
+
+SELECT regather_graphmeta();
+
+SELECT * FROM ag_graphmeta_view WHERE edge IN ('chase', 'scratch')
+  ORDER BY start, edge, "end";
+
+DROP FUNCTION wait_for_label_changes(regclass, int);
+
 -- cleanup
 
 DROP GRAPH graphmeta CASCADE;
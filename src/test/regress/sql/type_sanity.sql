@@ -239,7 +239,7 @@ WHERE p1.typreceive = p2.oid AND p2.provolatile NOT IN ('i', 's');
 SELECT DISTINCT typtype, typreceive
 FROM pg_type AS p1
 WHERE p1.typtype not in ('b', 'p')
-ORDER BY 1;
+ORDER BY 1, 2;
 
 -- Check for bogus typsend routines
 
@@ -268,7 +268,7 @@ WHERE p1.typsend = p2.oid AND p2.provolatile NOT IN ('i', 's');
 SELECT DISTINCT typtype, typsend
 FROM pg_type AS p1
 WHERE p1.typtype not in ('b', 'd', 'p')
-ORDER BY 1;
+ORDER BY 1, 2;
 
 -- Domains should have same typsend as their base types
 SELECT p1.oid, p1.typname, p2.oid, p2.typname